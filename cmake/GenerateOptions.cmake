@@ -0,0 +1,105 @@
+# Generates header with table of options and their default values from options.ini schema
+# Usage: cmake -DINPUT=options.ini -DOUTPUT=options.h -P GenerateOptions.cmake
+
+if (NOT INPUT OR NOT OUTPUT)
+	message(FATAL_ERROR "Both INPUT and OUTPUT need to be set")
+endif (NOT INPUT OR NOT OUTPUT)
+
+file(READ ${INPUT} _content)
+
+# semicolons are list separators in CMake, keep them out of the way until output is written
+string(REPLACE ";" "@SEMICOLON@" _content "${_content}")
+string(REPLACE "\r" "" _content "${_content}")
+string(REPLACE "\n" ";" _lines "${_content}")
+
+set(_key "")
+set(_type "")
+set(_value "")
+set(_choices "")
+set(_rows "")
+
+foreach(_line ${_lines} "[]")
+	if (_line MATCHES "^\\[(.*)\\]$")
+		set(_section "${CMAKE_MATCH_1}")
+
+		if (NOT _key STREQUAL "")
+			set(_number "0")
+			set(_text "NULL")
+
+			if (_type STREQUAL "bool")
+				set(_kind "BoolOptionValue")
+
+				if (_value STREQUAL "true")
+					set(_number "1")
+				endif (_value STREQUAL "true")
+			elseif (_type STREQUAL "integer")
+				set(_kind "IntegerOptionValue")
+
+				if (_value MATCHES "^-?[0-9]+$")
+					set(_number "${_value}")
+				endif (_value MATCHES "^-?[0-9]+$")
+			else (_type STREQUAL "bool")
+				set(_kind "StringOptionValue")
+
+				if (_value MATCHES "^\"(.*)\"$")
+					set(_value "${CMAKE_MATCH_1}")
+				elseif (_value MATCHES ",")
+					set(_kind "ListOptionValue")
+				endif (_value MATCHES "^\"(.*)\"$")
+
+				string(REPLACE "\\" "\\\\" _value "${_value}")
+				string(REPLACE "\"" "\\\"" _value "${_value}")
+
+				set(_text "\"${_value}\"")
+			endif (_type STREQUAL "bool")
+
+			if (_choices STREQUAL "")
+				set(_choices "NULL")
+			else (_choices STREQUAL "")
+				string(REPLACE "\"" "\\\"" _choices "${_choices}")
+
+				set(_choices "\"${_choices}\"")
+			endif (_choices STREQUAL "")
+
+			list(APPEND _rows "${_key}\t{\"${_key}\", \"${_type}\", ${_text}, ${_choices}, ${_number}, ${_kind}}")
+		endif (NOT _key STREQUAL "")
+
+		set(_key "${_section}")
+		set(_type "string")
+		set(_value "")
+		set(_choices "")
+	elseif (_line MATCHES "^type=(.*)$")
+		set(_type "${CMAKE_MATCH_1}")
+	elseif (_line MATCHES "^value=(.*)$")
+		set(_value "${CMAKE_MATCH_1}")
+	elseif (_line MATCHES "^choices=(.*)$")
+		set(_choices "${CMAKE_MATCH_1}")
+	endif (_line MATCHES "^\\[(.*)\\]$")
+endforeach(_line)
+
+# lookup relies on binary search, so table needs to be ordered by key
+list(SORT _rows)
+list(LENGTH _rows _amount)
+
+set(_output "// Generated from options.ini, do not edit.\n\n#ifndef OTTER_OPTIONS_H\n#define OTTER_OPTIONS_H\n\nnamespace Otter\n{\n\nenum OptionValueType\n{\n\tStringOptionValue = 0,\n\tBoolOptionValue,\n\tIntegerOptionValue,\n\tListOptionValue\n};\n\nstruct OptionDefinition\n{\n\tconst char *key;\n\tconst char *typeName;\n\tconst char *text;\n\tconst char *choices;\n\tint number;\n\tOptionValueType type;\n};\n\nstatic const OptionDefinition optionDefinitions[] =\n{\n")
+set(_index 0)
+
+foreach(_row ${_rows})
+	string(FIND "${_row}" "\t" _position)
+	math(EXPR _position "${_position} + 1")
+	string(SUBSTRING "${_row}" ${_position} -1 _row)
+
+	math(EXPR _index "${_index} + 1")
+
+	if (_index LESS _amount)
+		set(_output "${_output}\t${_row},\n")
+	else (_index LESS _amount)
+		set(_output "${_output}\t${_row}\n")
+	endif (_index LESS _amount)
+endforeach(_row)
+
+set(_output "${_output}};\n\nstatic const int optionDefinitionsAmount = ${_amount};\n\n}\n\n#endif\n")
+
+string(REPLACE "@SEMICOLON@" ";" _output "${_output}")
+
+file(WRITE ${OUTPUT} "${_output}")
@@ -15,7 +15,7 @@ QT += core dbus gui multimedia network printsupport script sql webkitwidgets wid
 greaterThan(QT_MINOR_VERSION, 2): QT += quick quickwidgets
 
 win32: QT += winextras
-win32: LIBS += -lOle32 -lshell32 -ladvapi32 -luser32
+win32: LIBS += -lOle32 -lshell32 -ladvapi32 -luser32 -lpsapi
 win32: INCLUDEPATH += .\
 unix: INCLUDEPATH += ./
 
@@ -33,6 +33,19 @@ configHeader.input = config.h.qmake
 configHeader.output = config.h
 QMAKE_SUBSTITUTES += configHeader
 
+# options.h is generated by CMake script, use "qmake CMAKE=/path/to/cmake" when it is not available in PATH
+isEmpty(CMAKE): CMAKE = cmake
+!system($$CMAKE --version > $$QMAKE_SYSTEM_NULL_DEVICE): error("CMake (2.8.10.2 or newer) is required to generate options.h, set its location using CMAKE variable")
+
+optionsSchema = resources/schemas/options.ini
+optionsHeader.input = optionsSchema
+optionsHeader.output = options.h
+optionsHeader.commands = $$CMAKE -DINPUT=${QMAKE_FILE_IN} -DOUTPUT=${QMAKE_FILE_OUT} -P $$PWD/cmake/GenerateOptions.cmake
+optionsHeader.depends = $$PWD/cmake/GenerateOptions.cmake
+optionsHeader.variable_out = HEADERS
+optionsHeader.CONFIG += no_link target_predeps
+QMAKE_EXTRA_COMPILERS += optionsHeader
+
 SOURCES += src/main.cpp \
     src/core/ActionsManager.cpp \
     src/core/Addon.cpp \
@@ -42,11 +55,15 @@ SOURCES += src/main.cpp \
     src/core/BookmarksImporter.cpp \
     src/core/BookmarksManager.cpp \
     src/core/BookmarksModel.cpp \
+    src/core/CacheModel.cpp \
+    src/core/ClosedItemsStore.cpp \
     src/core/ContentBlockingManager.cpp \
     src/core/ContentBlockingProfile.cpp \
     src/core/Console.cpp \
     src/core/CookieJar.cpp \
     src/core/CookieJarProxy.cpp \
+    src/core/CookiesModel.cpp \
+    src/core/DomainsModel.cpp \
     src/core/FileSystemCompleterModel.cpp \
     src/core/GesturesManager.cpp \
     src/core/HistoryManager.cpp \
@@ -55,9 +72,12 @@ SOURCES += src/main.cpp \
     src/core/LocalListingNetworkReply.cpp \
     src/core/NetworkManager.cpp \
     src/core/NetworkManagerFactory.cpp \
+    src/core/NetworkPredictor.cpp \
     src/core/NetworkAutomaticProxy.cpp \
     src/core/NetworkCache.cpp \
     src/core/NetworkProxyFactory.cpp \
+    src/core/NetworkTimeline.cpp \
+    src/core/NetworkTransport.cpp \
     src/core/NotesManager.cpp \
     src/core/NotificationsManager.cpp \
     src/core/PlatformIntegration.cpp \
@@ -66,6 +86,8 @@ SOURCES += src/main.cpp \
     src/core/SessionModel.cpp \
     src/core/SessionsManager.cpp \
     src/core/SettingsManager.cpp \
+    src/core/StartupProfiler.cpp \
+    src/core/ThumbnailsManager.cpp \
     src/core/ToolBarsManager.cpp \
     src/core/Transfer.cpp \
     src/core/TransfersManager.cpp \
@@ -158,6 +180,8 @@ SOURCES += src/main.cpp \
     src/modules/windows/configuration/ConfigurationContentsWidget.cpp \
     src/modules/windows/cookies/CookiesContentsWidget.cpp \
     src/modules/windows/history/HistoryContentsWidget.cpp \
+    src/modules/windows/network/NetworkContentsWidget.cpp \
+    src/modules/windows/network/NetworkWaterfallDelegate.cpp \
     src/modules/windows/notes/NotesContentsWidget.cpp \
     src/modules/windows/transfers/ProgressBarDelegate.cpp \
     src/modules/windows/transfers/TransfersContentsWidget.cpp \
@@ -179,11 +203,15 @@ HEADERS += src/core/ActionsManager.h \
     src/core/BookmarksImporter.h \
     src/core/BookmarksManager.h \
     src/core/BookmarksModel.h \
+    src/core/CacheModel.h \
+    src/core/ClosedItemsStore.h \
     src/core/ContentBlockingManager.h \
     src/core/ContentBlockingProfile.h \
     src/core/Console.h \
     src/core/CookieJar.h \
     src/core/CookieJarProxy.h \
+    src/core/CookiesModel.h \
+    src/core/DomainsModel.h \
     src/core/FileSystemCompleterModel.h \
     src/core/GesturesManager.h \
     src/core/HistoryManager.h \
@@ -194,7 +222,10 @@ HEADERS += src/core/ActionsManager.h \
     src/core/NetworkCache.h \
     src/core/NetworkManager.h \
     src/core/NetworkManagerFactory.h \
+    src/core/NetworkPredictor.h \
     src/core/NetworkProxyFactory.h \
+    src/core/NetworkTimeline.h \
+    src/core/NetworkTransport.h \
     src/core/NotesManager.h \
     src/core/NotificationsManager.h \
     src/core/PlatformIntegration.h \
@@ -203,6 +234,8 @@ HEADERS += src/core/ActionsManager.h \
     src/core/SessionModel.h \
     src/core/SessionsManager.h \
     src/core/SettingsManager.h \
+    src/core/StartupProfiler.h \
+    src/core/ThumbnailsManager.h \
     src/core/ToolBarsManager.h \
     src/core/Transfer.h \
     src/core/TransfersManager.h \
@@ -295,6 +328,8 @@ HEADERS += src/core/ActionsManager.h \
     src/modules/windows/configuration/ConfigurationContentsWidget.h \
     src/modules/windows/cookies/CookiesContentsWidget.h \
     src/modules/windows/history/HistoryContentsWidget.h \
+    src/modules/windows/network/NetworkContentsWidget.h \
+    src/modules/windows/network/NetworkWaterfallDelegate.h \
     src/modules/windows/notes/NotesContentsWidget.h \
     src/modules/windows/transfers/ProgressBarDelegate.h \
     src/modules/windows/transfers/TransfersContentsWidget.h \
@@ -345,6 +380,7 @@ FORMS += src/ui/AcceptCookieDialog.ui \
     src/modules/windows/configuration/ConfigurationContentsWidget.ui \
     src/modules/windows/cookies/CookiesContentsWidget.ui \
     src/modules/windows/history/HistoryContentsWidget.ui \
+    src/modules/windows/network/NetworkContentsWidget.ui \
     src/modules/windows/notes/NotesContentsWidget.ui \
     src/modules/windows/transfers/TransfersContentsWidget.ui \
     src/modules/windows/web/PermissionBarWidget.ui \
@@ -26,11 +26,14 @@
 #include "GesturesManager.h"
 #include "HistoryManager.h"
 #include "NetworkManagerFactory.h"
+#include "NetworkPredictor.h"
 #include "NotesManager.h"
 #include "NotificationsManager.h"
 #include "PlatformIntegration.h"
 #include "SearchesManager.h"
 #include "SettingsManager.h"
+#include "StartupProfiler.h"
+#include "ThumbnailsManager.h"
 #include "ToolBarsManager.h"
 #include "Transfer.h"
 #include "TransfersManager.h"
@@ -46,13 +49,15 @@
 
 #include <QtCore/QBuffer>
 #include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QLibraryInfo>
 #include <QtCore/QLocale>
-#include <QtCore/QSettings>
+#include <QtCore/QPointer>
 #include <QtCore/QStandardPaths>
+#include <QtCore/QTimer>
 #include <QtCore/QTranslator>
 #include <QtNetwork/QLocalSocket>
 #include <QtWidgets/QCheckBox>
@@ -63,6 +68,7 @@ namespace Otter
 {
 
 Application* Application::m_instance = NULL;
+const quint32 Application::m_messageLimit = 16777216;
 
 Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 	m_platformIntegration(NULL),
@@ -70,8 +76,12 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 	m_qtTranslator(NULL),
 	m_applicationTranslator(NULL),
 	m_localServer(NULL),
-	m_isHidden(false)
+	m_initializationTimer(0),
+	m_isHidden(false),
+	m_isInitialized(false)
 {
+	StartupProfiler::start();
+
 	setApplicationName(QLatin1String("Otter"));
 	setApplicationVersion(OTTER_VERSION_MAIN);
 	setWindowIcon(QIcon::fromTheme(QLatin1String("otter-browser"), QIcon(QLatin1String(":/icons/otter-browser.png"))));
@@ -121,6 +131,11 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 
 	cachePath = QFileInfo(cachePath).absoluteFilePath();
 
+	if (parser->isSet(QLatin1String("trace-startup")))
+	{
+		StartupProfiler::setPath(QFileInfo(parser->value(QLatin1String("trace-startup"))).absoluteFilePath());
+	}
+
 	delete parser;
 
 	QCryptographicHash hash(QCryptographicHash::Md5);
@@ -133,22 +148,18 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 
 	if (socket.waitForConnected(500))
 	{
-		const QStringList decodedArguments = arguments();
-		QStringList encodedArguments;
-
 #ifdef Q_OS_WIN
 		AllowSetForegroundWindow(ASFW_ANY);
 #endif
 
-		for (int i = 0; i < decodedArguments.count(); ++i)
-		{
-			encodedArguments.append(decodedArguments.at(i).toUtf8().toBase64());
-		}
-
-		QTextStream stream(&socket);
-		stream << encodedArguments.join(QLatin1Char(' ')).toUtf8().toBase64();
-		stream.flush();
+		QByteArray message;
+		QDataStream stream(&message, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_2);
+		stream << quint32(0) << arguments();
+		stream.device()->seek(0);
+		stream << quint32(message.size() - sizeof(quint32));
 
+		socket.write(message);
 		socket.waitForBytesWritten();
 
 		return;
@@ -170,51 +181,58 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 
 	Console::createInstance(this);
 
-	SettingsManager::createInstance(profilePath, this);
-
-	QSettings defaults(QLatin1String(":/schemas/options.ini"), QSettings::IniFormat, this);
-	const QStringList groups = defaults.childGroups();
-
-	for (int i = 0; i < groups.count(); ++i)
-	{
-		defaults.beginGroup(groups.at(i));
-
-		const QStringList keys = defaults.childGroups();
-
-		for (int j = 0; j < keys.count(); ++j)
-		{
-			SettingsManager::setDefaultValue(QStringLiteral("%1/%2").arg(groups.at(i)).arg(keys.at(j)), defaults.value(QStringLiteral("%1/value").arg(keys.at(j))));
-		}
-
-		defaults.endGroup();
-	}
+	StartupProfiler::beginPhase(QLatin1String("SettingsManager"));
 
+	SettingsManager::createInstance(profilePath, this);
 	SettingsManager::setDefaultValue(QLatin1String("Paths/Downloads"), QStandardPaths::writableLocation(QStandardPaths::DownloadLocation));
 	SettingsManager::setDefaultValue(QLatin1String("Paths/SaveFile"), QStandardPaths::writableLocation(QStandardPaths::DownloadLocation));
 
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("SessionsManager"));
+
 	SessionsManager::createInstance(profilePath, cachePath, isPrivate, this);
 
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("NetworkManagerFactory"));
+
 	NetworkManagerFactory::createInstance(this);
 
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("ActionsManager"));
+
 	ActionsManager::createInstance(this);
 
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("AddonsManager"));
+
 	AddonsManager::createInstance(this);
 
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("BookmarksManager"));
+
 	BookmarksManager::createInstance(this);
 
-	GesturesManager::createInstance(this);
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("GesturesManager"));
 
-	HistoryManager::createInstance(this);
+	GesturesManager::createInstance(this);
 
-	NotesManager::createInstance(this);
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("NotificationsManager"));
 
 	NotificationsManager::createInstance(this);
 
-	SearchesManager::createInstance(this);
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("ThumbnailsManager"));
+
+	ThumbnailsManager::createInstance(this);
+
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("ToolBarsManager"));
 
 	ToolBarsManager::createInstance(this);
 
-	TransfersManager::createInstance(this);
+	StartupProfiler::endPhase();
 
 	setLocale(SettingsManager::getValue(QLatin1String("Browser/Locale")).toString());
 	setQuitOnLastWindowClosed(true);
@@ -231,6 +249,8 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 #endif
 
 	connect(this, SIGNAL(aboutToQuit()), this, SLOT(clearHistory()));
+
+	m_initializationTimer = startTimer(5000);
 }
 
 Application::~Application()
@@ -251,6 +271,14 @@ void Application::close()
 	}
 }
 
+void Application::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_initializationTimer)
+	{
+		initializeDeferred();
+	}
+}
+
 void Application::removeWindow(MainWindow *window)
 {
 	m_windows.removeAll(window);
@@ -275,30 +303,63 @@ void Application::showNotification(Notification *notification)
 
 void Application::newConnection()
 {
-	QLocalSocket *socket = m_localServer->nextPendingConnection();
-
-	if (!socket)
+	while (m_localServer->hasPendingConnections())
 	{
-		return;
+		QLocalSocket *socket = m_localServer->nextPendingConnection();
+
+		if (socket)
+		{
+			connect(socket, SIGNAL(readyRead()), this, SLOT(readMessage()));
+			connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+		}
 	}
+}
 
-	socket->waitForReadyRead(1000);
+void Application::readMessage()
+{
+	QPointer<QLocalSocket> socket(qobject_cast<QLocalSocket*>(sender()));
 
-	MainWindow *window = (getWindows().isEmpty() ? NULL : getWindow());
-	QString data;
-	QTextStream stream(socket);
-	stream >> data;
+// each message is prefixed with its length, so partial messages simply wait for more data
+	while (socket && socket->bytesAvailable() >= qint64(sizeof(quint32)))
+	{
+		QDataStream header(socket->peek(sizeof(quint32)));
+		quint32 size = 0;
 
-	const QStringList encodedArguments = QString(QByteArray::fromBase64(data.toUtf8())).split(QLatin1Char(' '));
-	QStringList decodedArguments;
+		header >> size;
 
-	for (int i = 0; i < encodedArguments.count(); ++i)
-	{
-		decodedArguments.append(QString(QByteArray::fromBase64(encodedArguments.at(i).toUtf8())));
+		if (size > m_messageLimit)
+		{
+			socket->abort();
+
+			return;
+		}
+
+		if (socket->bytesAvailable() < qint64(sizeof(quint32) + size))
+		{
+			return;
+		}
+
+		socket->read(sizeof(quint32));
+
+		QDataStream stream(socket->read(size));
+		stream.setVersion(QDataStream::Qt_5_2);
+
+		QStringList arguments;
+
+		stream >> arguments;
+
+		if (stream.status() == QDataStream::Ok)
+		{
+			handleArguments(arguments);
+		}
 	}
+}
 
+void Application::handleArguments(const QStringList &arguments)
+{
+	MainWindow *window = (getWindows().isEmpty() ? NULL : getWindow());
 	QCommandLineParser *parser = createCommandLineParser();
-	parser->parse(decodedArguments);
+	parser->parse(arguments);
 
 	const QString session = parser->value(QLatin1String("session"));
 	const bool isPrivate = parser->isSet(QLatin1String("privatesession"));
@@ -340,8 +401,6 @@ void Application::newConnection()
 		}
 	}
 
-	delete socket;
-
 	if (window)
 	{
 		window->raise();
@@ -361,6 +420,52 @@ void Application::newConnection()
 	delete parser;
 }
 
+void Application::initializeDeferred()
+{
+	if (m_isInitialized)
+	{
+		return;
+	}
+
+	m_isInitialized = true;
+
+	killTimer(m_initializationTimer);
+
+	m_initializationTimer = 0;
+
+	StartupProfiler::beginPhase(QLatin1String("Deferred initialization"));
+	StartupProfiler::beginPhase(QLatin1String("HistoryManager"));
+
+	HistoryManager::getInstance();
+
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("NetworkPredictor"));
+
+	NetworkPredictor::createInstance(this);
+
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("NotesManager"));
+
+	NotesManager::getInstance();
+
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("SearchesManager"));
+
+	SearchesManager::getInstance();
+
+	StartupProfiler::endPhase();
+	StartupProfiler::beginPhase(QLatin1String("TransfersManager"));
+
+	TransfersManager::getInstance();
+
+	StartupProfiler::endPhase();
+
+	emit initialized();
+
+	StartupProfiler::endPhase();
+	StartupProfiler::finish();
+}
+
 void Application::clearHistory()
 {
 	QStringList clearSettings = SettingsManager::getValue(QLatin1String("History/ClearOnClose")).toStringList();
@@ -463,6 +568,7 @@ QCommandLineParser* Application::createCommandLineParser() const
 	parser->addOption(QCommandLineOption(QLatin1String("privatesession"), QCoreApplication::translate("main", "Starts private session")));
 	parser->addOption(QCommandLineOption(QLatin1String("sessionchooser"), QCoreApplication::translate("main", "Forces session chooser dialog")));
 	parser->addOption(QCommandLineOption(QLatin1String("portable"), QCoreApplication::translate("main", "Sets profile and cache paths to directories inside the same directory as that of application binary")));
+	parser->addOption(QCommandLineOption(QLatin1String("trace-startup"), QCoreApplication::translate("main", "Writes startup phase timings to <path> as JSON"), QLatin1String("path"), QString()));
 
 	return parser;
 }
@@ -471,6 +577,11 @@ MainWindow* Application::createWindow(bool isPrivate, bool inBackground, const S
 {
 	MainWindow *window = new MainWindow(isPrivate, windows);
 
+	if (!m_isInitialized && m_windows.isEmpty())
+	{
+		window->installEventFilter(this);
+	}
+
 	m_windows.prepend(window);
 
 	if (inBackground)
@@ -493,6 +604,20 @@ MainWindow* Application::createWindow(bool isPrivate, bool inBackground, const S
 	return window;
 }
 
+bool Application::eventFilter(QObject *object, QEvent *event)
+{
+	if (event->type() == QEvent::Paint && !m_isInitialized)
+	{
+		object->removeEventFilter(this);
+
+		StartupProfiler::markEvent(QLatin1String("First paint"));
+
+		QTimer::singleShot(0, this, SLOT(initializeDeferred()));
+	}
+
+	return QApplication::eventFilter(object, event);
+}
+
 Application* Application::getInstance()
 {
 	return m_instance;
@@ -637,6 +762,11 @@ bool Application::isHidden() const
 	return m_isHidden;
 }
 
+bool Application::isInitialized() const
+{
+	return m_isInitialized;
+}
+
 bool Application::isRunning() const
 {
 	return (m_localServer == NULL);
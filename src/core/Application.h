@@ -58,15 +58,23 @@ public:
 	QList<MainWindow*> getWindows() const;
 	bool canClose();
 	bool isHidden() const;
+	bool isInitialized() const;
 	bool isRunning() const;
+	bool eventFilter(QObject *object, QEvent *event);
 
 public slots:
 	void close();
 	void newWindow(bool isPrivate = false, bool inBackground = false, const QUrl &url = QUrl());
 	void setHidden(bool hidden);
 
+protected:
+	void timerEvent(QTimerEvent *event);
+	void handleArguments(const QStringList &arguments);
+
 protected slots:
 	void newConnection();
+	void readMessage();
+	void initializeDeferred();
 	void clearHistory();
 
 private:
@@ -77,11 +85,15 @@ private:
 	QLocalServer *m_localServer;
 	QString m_localePath;
 	QList<MainWindow*> m_windows;
+	int m_initializationTimer;
 	bool m_isHidden;
+	bool m_isInitialized;
 
 	static Application *m_instance;
+	static const quint32 m_messageLimit;
 
 signals:
+	void initialized();
 	void windowAdded(MainWindow *window);
 	void windowRemoved(MainWindow *window);
 };
@@ -0,0 +1,380 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "CacheModel.h"
+#include "Utils.h"
+
+#include <QtCore/QTimerEvent>
+
+namespace Otter
+{
+
+CacheModel::CacheModel(NetworkCache *cache, QObject *parent) : DomainsModel(parent),
+	m_cache(cache),
+	m_populateTimer(0),
+	m_isLoading(true)
+{
+	connect(m_cache, SIGNAL(entriesLoaded()), this, SLOT(populateEntries()));
+	connect(m_cache, SIGNAL(cleared()), this, SLOT(clearEntries()));
+	connect(m_cache, SIGNAL(entryAdded(CacheEntry)), this, SLOT(addEntry(CacheEntry)));
+	connect(m_cache, SIGNAL(entryRemoved(QUrl)), this, SLOT(removeEntry(QUrl)));
+
+	m_cache->loadEntries();
+}
+
+CacheModel::~CacheModel()
+{
+}
+
+void CacheModel::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != m_populateTimer)
+	{
+		return;
+	}
+
+	for (int i = 0; (i < 500 && !m_pendingEntries.isEmpty()); ++i)
+	{
+		addEntry(m_pendingEntries.takeFirst());
+	}
+
+	if (m_pendingEntries.isEmpty())
+	{
+		killTimer(m_populateTimer);
+
+		m_populateTimer = 0;
+		m_isLoading = false;
+
+		emit loadingChanged(false);
+	}
+}
+
+void CacheModel::populateEntries()
+{
+	if (!m_isLoading || m_populateTimer != 0)
+	{
+		return;
+	}
+
+	m_pendingEntries = m_cache->getEntries();
+	m_populateTimer = startTimer(0);
+}
+
+void CacheModel::clearEntries()
+{
+	beginResetModel();
+
+	clearDomains();
+
+	m_entries.clear();
+	m_pendingEntries.clear();
+
+	endResetModel();
+}
+
+void CacheModel::addEntry(const CacheEntry &entry)
+{
+	if (!entry.url.isValid() || m_entries.contains(entry.url))
+	{
+		return;
+	}
+
+	const QString domain = entry.url.host();
+	CacheEntries *domainEntry = static_cast<CacheEntries*>(findDomain(domain));
+	CacheEntry *cacheEntry = new CacheEntry(entry);
+
+	m_entries[entry.url] = cacheEntry;
+
+	if (!domainEntry)
+	{
+		const int row = getInsertionRow(domain);
+
+		beginInsertRows(QModelIndex(), row, row);
+
+		domainEntry = new CacheEntries();
+		domainEntry->domain = domain;
+		domainEntry->entries.append(cacheEntry);
+		domainEntry->size = entry.size;
+
+		insertDomain(row, domainEntry);
+
+		endInsertRows();
+
+		return;
+	}
+
+	const QModelIndex domainIndex = index(findDomainRow(domain), 0);
+
+	beginInsertRows(domainIndex, domainEntry->entries.count(), domainEntry->entries.count());
+
+	domainEntry->entries.append(cacheEntry);
+	domainEntry->size += entry.size;
+
+	endInsertRows();
+
+	emit dataChanged(domainIndex, domainIndex.sibling(domainIndex.row(), 2));
+}
+
+void CacheModel::removeEntry(const QUrl &url)
+{
+	CacheEntry *cacheEntry = m_entries.take(url);
+
+	if (!cacheEntry)
+	{
+		return;
+	}
+
+	const QString domain = url.host();
+	CacheEntries *domainEntry = static_cast<CacheEntries*>(findDomain(domain));
+
+	if (!domainEntry)
+	{
+		delete cacheEntry;
+
+		return;
+	}
+
+	const int domainRow = findDomainRow(domain);
+	const QModelIndex domainIndex = index(domainRow, 0);
+	const int row = domainEntry->entries.indexOf(cacheEntry);
+
+	if (row >= 0)
+	{
+		beginRemoveRows(domainIndex, row, row);
+
+		domainEntry->entries.removeAt(row);
+		domainEntry->size -= cacheEntry->size;
+
+		endRemoveRows();
+	}
+
+	delete cacheEntry;
+
+	if (!domainEntry->entries.isEmpty())
+	{
+		emit dataChanged(domainIndex, domainIndex.sibling(domainRow, 2));
+
+		return;
+	}
+
+	beginRemoveRows(QModelIndex(), domainRow, domainRow);
+
+	removeDomain(domainRow);
+
+	endRemoveRows();
+}
+
+QModelIndex CacheModel::index(int row, int column, const QModelIndex &parent) const
+{
+	if (row < 0 || column < 0 || column >= 5)
+	{
+		return QModelIndex();
+	}
+
+	if (!parent.isValid())
+	{
+		return ((row < getDomainsAmount()) ? createIndex(row, column) : QModelIndex());
+	}
+
+	CacheEntries *domainEntry = getCacheEntries(parent);
+
+	if (!domainEntry || parent.column() != 0 || row >= domainEntry->entries.count())
+	{
+		return QModelIndex();
+	}
+
+	return createEntryIndex(row, column, domainEntry);
+}
+
+CacheModel::CacheEntries* CacheModel::getCacheEntries(const QModelIndex &index) const
+{
+	return static_cast<CacheEntries*>(getDomainEntry(index));
+}
+
+QUrl CacheModel::getEntry(const QModelIndex &index) const
+{
+	const CacheEntries *domainEntry = static_cast<CacheEntries*>(getParentEntry(index));
+
+	return ((domainEntry && index.row() < domainEntry->entries.count()) ? domainEntry->entries.at(index.row())->url : QUrl());
+}
+
+QVariant CacheModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid())
+	{
+		return QVariant();
+	}
+
+	if (index.internalPointer())
+	{
+		const CacheEntries *domainEntry = static_cast<CacheEntries*>(getParentEntry(index));
+
+		if (index.row() >= domainEntry->entries.count())
+		{
+			return QVariant();
+		}
+
+		const CacheEntry &entry = *domainEntry->entries.at(index.row());
+
+		if (role == UrlRole)
+		{
+			return entry.url;
+		}
+
+		if (role == SizeRole)
+		{
+			return entry.size;
+		}
+
+		if (role != Qt::DisplayRole && role != Qt::ToolTipRole)
+		{
+			return QVariant();
+		}
+
+		switch (index.column())
+		{
+			case 0:
+				return entry.url.path();
+			case 1:
+				return entry.type;
+			case 2:
+				return Utils::formatUnit(entry.size);
+			case 3:
+				return entry.lastModified.toString();
+			case 4:
+				return entry.expirationDate.toString();
+			default:
+				return QVariant();
+		}
+	}
+
+	const CacheEntries *domainEntry = getCacheEntries(index);
+
+	if (!domainEntry)
+	{
+		return QVariant();
+	}
+
+	if (index.column() == 2)
+	{
+		if (role == SizeRole)
+		{
+			return domainEntry->size;
+		}
+
+		return ((role == Qt::DisplayRole) ? Utils::formatUnit(domainEntry->size) : QVariant());
+	}
+
+	if (index.column() != 0)
+	{
+		return QVariant();
+	}
+
+	switch (role)
+	{
+		case Qt::DisplayRole:
+			return QStringLiteral("%1 (%2)").arg(domainEntry->domain).arg(domainEntry->entries.count());
+		case Qt::ToolTipRole:
+			return domainEntry->domain;
+		case Qt::DecorationRole:
+			return getDomainIcon(domainEntry->domain);
+		default:
+			return QVariant();
+	}
+}
+
+QVariant CacheModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+	{
+		return QVariant();
+	}
+
+	switch (section)
+	{
+		case 0:
+			return tr("Address");
+		case 1:
+			return tr("Type");
+		case 2:
+			return tr("Size");
+		case 3:
+			return tr("Last Modified");
+		case 4:
+			return tr("Expires");
+		default:
+			return QVariant();
+	}
+}
+
+QList<QUrl> CacheModel::getEntries(const QModelIndex &index) const
+{
+	QList<QUrl> entries;
+	const CacheEntries *domainEntry = getCacheEntries(index.sibling(index.row(), 0));
+
+	if (domainEntry)
+	{
+		for (int i = 0; i < domainEntry->entries.count(); ++i)
+		{
+			entries.append(domainEntry->entries.at(i)->url);
+		}
+	}
+	else
+	{
+		const QUrl entry = getEntry(index);
+
+		if (entry.isValid())
+		{
+			entries.append(entry);
+		}
+	}
+
+	return entries;
+}
+
+int CacheModel::columnCount(const QModelIndex &parent) const
+{
+	Q_UNUSED(parent)
+
+	return 5;
+}
+
+int CacheModel::rowCount(const QModelIndex &parent) const
+{
+	if (!parent.isValid())
+	{
+		return getDomainsAmount();
+	}
+
+	const CacheEntries *domainEntry = getCacheEntries(parent);
+
+	return ((domainEntry && parent.column() == 0) ? domainEntry->entries.count() : 0);
+}
+
+bool CacheModel::hasChildren(const QModelIndex &parent) const
+{
+	return (rowCount(parent) > 0);
+}
+
+bool CacheModel::isLoading() const
+{
+	return m_isLoading;
+}
+
+}
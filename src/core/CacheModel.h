@@ -0,0 +1,85 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_CACHEMODEL_H
+#define OTTER_CACHEMODEL_H
+
+#include "DomainsModel.h"
+#include "NetworkCache.h"
+
+namespace Otter
+{
+
+class CacheModel : public DomainsModel
+{
+	Q_OBJECT
+
+public:
+	enum EntryRole
+	{
+		UrlRole = Qt::UserRole,
+		SizeRole = (Qt::UserRole + 1)
+	};
+
+	explicit CacheModel(NetworkCache *cache, QObject *parent = NULL);
+	~CacheModel();
+
+	QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+	QUrl getEntry(const QModelIndex &index) const;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+	QList<QUrl> getEntries(const QModelIndex &index) const;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+	bool isLoading() const;
+
+protected:
+	struct CacheEntries : public DomainEntry
+	{
+		QList<CacheEntry*> entries;
+		qint64 size;
+
+		CacheEntries() : size(0) {}
+		~CacheEntries() { qDeleteAll(entries); }
+	};
+
+	void timerEvent(QTimerEvent *event);
+	CacheEntries* getCacheEntries(const QModelIndex &index) const;
+
+protected slots:
+	void populateEntries();
+	void clearEntries();
+	void addEntry(const CacheEntry &entry);
+	void removeEntry(const QUrl &url);
+
+private:
+	NetworkCache *m_cache;
+	QHash<QUrl, CacheEntry*> m_entries;
+	QList<CacheEntry> m_pendingEntries;
+	int m_populateTimer;
+	bool m_isLoading;
+
+signals:
+	void loadingChanged(bool isLoading);
+};
+
+}
+
+#endif
@@ -0,0 +1,237 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "ClosedItemsStore.h"
+
+#include <QtCore/QDir>
+
+namespace Otter
+{
+
+ClosedItemsStore::ClosedItemsStore() :
+	m_file(NULL),
+	m_memoryUsage(0),
+	m_spilledSize(0),
+	m_unusedSize(0)
+{
+}
+
+ClosedItemsStore::~ClosedItemsStore()
+{
+	delete m_file;
+}
+
+void ClosedItemsStore::addItem(const SessionMainWindow &window, quint64 nextWindow, quint64 previousWindow)
+{
+	const SessionWindow activeWindow = window.windows.value(qMax(0, window.index), SessionWindow());
+	ClosedItem item;
+	item.title = activeWindow.getTitle();
+	item.url = activeWindow.getUrl();
+	item.data = qCompress(SessionsManager::serializeWindow(window));
+	item.nextWindow = nextWindow;
+	item.previousWindow = previousWindow;
+	item.size = item.data.size();
+
+	m_items.prepend(item);
+
+	m_memoryUsage += item.size;
+
+	applyLimits();
+}
+
+void ClosedItemsStore::removeItem(int index)
+{
+	if (index < 0 || index >= m_items.count())
+	{
+		return;
+	}
+
+	const ClosedItem item = m_items.takeAt(index);
+
+	if (item.offset < 0)
+	{
+		m_memoryUsage -= item.size;
+	}
+	else
+	{
+		m_spilledSize -= item.size;
+		m_unusedSize += item.size;
+
+		compact();
+	}
+}
+
+void ClosedItemsStore::clear()
+{
+	m_items.clear();
+
+	m_memoryUsage = 0;
+	m_spilledSize = 0;
+	m_unusedSize = 0;
+
+	if (m_file)
+	{
+		m_file->resize(0);
+	}
+}
+
+void ClosedItemsStore::removeStaleFiles()
+{
+	const QDir directory(SessionsManager::getWritableDataPath(QString()));
+	const QStringList entries = directory.entryList(QStringList(QLatin1String("closedItems-*")), QDir::Files);
+
+	for (int i = 0; i < entries.count(); ++i)
+	{
+		QFile::remove(directory.absoluteFilePath(entries.at(i)));
+	}
+}
+
+void ClosedItemsStore::applyLimits()
+{
+	const int limit = qMax(0, SettingsManager::getValue(QLatin1String("History/ClosedItemsLimit")).toInt());
+	const qint64 memoryLimit = (SettingsManager::getValue(QLatin1String("History/ClosedItemsMemoryLimit")).toLongLong() * 1024);
+
+	while (m_items.count() > limit)
+	{
+		removeItem(m_items.count() - 1);
+	}
+
+// the most recent item always stays in memory, so that reopening it does not touch the disk
+	for (int i = (m_items.count() - 1); (i > 0 && m_memoryUsage > memoryLimit); --i)
+	{
+		if (m_items.at(i).offset < 0)
+		{
+			spillItem(i);
+		}
+	}
+}
+
+void ClosedItemsStore::spillItem(int index)
+{
+	if (!m_file && !SessionsManager::isPrivate())
+	{
+		m_file = new QTemporaryFile(SessionsManager::getWritableDataPath(QLatin1String("closedItems-XXXXXX")));
+
+		if (!m_file->open())
+		{
+			delete m_file;
+
+			m_file = NULL;
+		}
+	}
+
+	ClosedItem &item = m_items[index];
+	const qint64 offset = (m_file ? m_file->size() : -1);
+
+	if (offset < 0 || !m_file->seek(offset) || m_file->write(item.data) != item.size)
+	{
+		removeItem(index);
+
+		return;
+	}
+
+	m_memoryUsage -= item.size;
+	m_spilledSize += item.size;
+
+	item.offset = offset;
+	item.data.clear();
+}
+
+void ClosedItemsStore::compact()
+{
+	if (!m_file || m_unusedSize < m_spilledSize)
+	{
+		return;
+	}
+
+	QList<int> indexes;
+	QList<QByteArray> spilledItems;
+
+	for (int i = 0; i < m_items.count(); ++i)
+	{
+		if (m_items.at(i).offset >= 0)
+		{
+			indexes.append(i);
+			spilledItems.append(readItem(m_items.at(i)));
+		}
+	}
+
+	m_file->resize(0);
+	m_file->seek(0);
+
+	m_spilledSize = 0;
+	m_unusedSize = 0;
+
+	for (int i = 0; i < indexes.count(); ++i)
+	{
+		ClosedItem &item = m_items[indexes.at(i)];
+		item.offset = m_file->pos();
+		item.size = spilledItems.at(i).size();
+
+		m_file->write(spilledItems.at(i));
+
+		m_spilledSize += item.size;
+	}
+}
+
+ClosedItem ClosedItemsStore::getItem(int index) const
+{
+	return m_items.value(index, ClosedItem());
+}
+
+QByteArray ClosedItemsStore::readItem(const ClosedItem &item)
+{
+	if (item.offset < 0)
+	{
+		return item.data;
+	}
+
+	if (!m_file || !m_file->seek(item.offset))
+	{
+		return QByteArray();
+	}
+
+	return m_file->read(item.size);
+}
+
+SessionMainWindow ClosedItemsStore::takeItem(int index)
+{
+	if (index < 0 || index >= m_items.count())
+	{
+		return SessionMainWindow();
+	}
+
+	const QByteArray data = readItem(m_items.at(index));
+
+	removeItem(index);
+
+	return (data.isEmpty() ? SessionMainWindow() : SessionsManager::deserializeWindow(qUncompress(data)));
+}
+
+int ClosedItemsStore::count() const
+{
+	return m_items.count();
+}
+
+bool ClosedItemsStore::isEmpty() const
+{
+	return m_items.isEmpty();
+}
+
+}
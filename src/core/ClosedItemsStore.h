@@ -0,0 +1,76 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_CLOSEDITEMSSTORE_H
+#define OTTER_CLOSEDITEMSSTORE_H
+
+#include "SessionsManager.h"
+
+#include <QtCore/QTemporaryFile>
+
+namespace Otter
+{
+
+struct ClosedItem
+{
+	QString title;
+	QString url;
+	QByteArray data;
+	qint64 offset;
+	quint64 nextWindow;
+	quint64 previousWindow;
+	int size;
+
+	ClosedItem() : offset(-1), nextWindow(0), previousWindow(0), size(0) {}
+};
+
+class ClosedItemsStore
+{
+public:
+	ClosedItemsStore();
+	~ClosedItemsStore();
+
+	void addItem(const SessionMainWindow &window, quint64 nextWindow = 0, quint64 previousWindow = 0);
+	void removeItem(int index);
+	void clear();
+	static void removeStaleFiles();
+	ClosedItem getItem(int index) const;
+	SessionMainWindow takeItem(int index);
+	int count() const;
+	bool isEmpty() const;
+
+protected:
+	void applyLimits();
+	void spillItem(int index);
+	void compact();
+	QByteArray readItem(const ClosedItem &item);
+
+private:
+	QTemporaryFile *m_file;
+	QList<ClosedItem> m_items;
+	qint64 m_memoryUsage;
+	qint64 m_spilledSize;
+	qint64 m_unusedSize;
+
+	Q_DISABLE_COPY(ClosedItemsStore)
+};
+
+}
+
+#endif
@@ -19,51 +19,149 @@
 
 #include "Console.h"
 
+#include <QtCore/QCoreApplication>
+#include <QtCore/QTimerEvent>
+
 namespace Otter
 {
 
 Console* Console::m_instance = NULL;
-QList<ConsoleMessage*> Console::m_messages;
+QVector<ConsoleMessage> Console::m_messages;
+QHash<QPair<const char*, QString>, QPair<quint64, qint64> > Console::m_aggregatedMessages;
+quint64 Console::m_identifier = 0;
+int Console::m_firstMessage = 0;
+int Console::m_messagesAmount = 0;
+const int Console::m_messagesLimit = 1000;
+const int Console::m_aggregationInterval = 1000;
 
-Console::Console(QObject *parent) : QObject(parent)
+Console::Console(QObject *parent) : QObject(parent),
+	m_aggregationTimer(0)
 {
+	m_messages.resize(m_messagesLimit);
 }
 
-Console::~Console()
+void Console::createInstance(QObject *parent)
 {
-	for (int i = 0; i < m_messages.count(); ++i)
+	if (!m_instance)
 	{
-		delete m_messages.at(i);
+		m_instance = new Console(parent);
 	}
 }
 
-void Console::createInstance(QObject *parent)
+void Console::timerEvent(QTimerEvent *event)
 {
-	if (!m_instance)
+	if (event->timerId() != m_aggregationTimer)
 	{
-		m_instance = new Console(parent);
+		return;
+	}
+
+	const qint64 time = QDateTime::currentMSecsSinceEpoch();
+	QHash<QPair<const char*, QString>, QPair<quint64, qint64> >::iterator iterator = m_aggregatedMessages.begin();
+
+	while (iterator != m_aggregatedMessages.end())
+	{
+		const ConsoleMessage *message = getMessage(iterator.value().first);
+
+		if (!message || (time - iterator.value().second) >= m_aggregationInterval)
+		{
+			if (message && message->count > 1)
+			{
+				emit messageChanged(message->identifier);
+			}
+
+			iterator = m_aggregatedMessages.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+
+	if (m_aggregatedMessages.isEmpty())
+	{
+		killTimer(m_aggregationTimer);
+
+		m_aggregationTimer = 0;
 	}
 }
 
 void Console::addMessage(const QString &note, MessageCategory category, MessageLevel level, const QString &source, int line, qint64 window)
 {
-	ConsoleMessage *message = new ConsoleMessage();
-	message->time = QDateTime::currentDateTime();
+	ConsoleMessage *message = createMessage(category, level, source, window);
 	message->note = note;
-	message->source = source;
-	message->category = category;
-	message->level = level;
 	message->line = line;
-	message->window = window;
 
-	m_messages.append(message);
+	emit m_instance->messageAdded(message->identifier);
+}
+
+void Console::addMessage(const char *format, const QString &argument, MessageCategory category, MessageLevel level, const QString &source, qint64 window)
+{
+	const QPair<const char*, QString> key(format, source);
+
+	if (m_aggregatedMessages.contains(key))
+	{
+		QPair<quint64, qint64> &aggregation = m_aggregatedMessages[key];
+		ConsoleMessage *message = getMessage(aggregation.first);
+
+		if (message)
+		{
+			message->note = argument;
+
+			++message->count;
+
+// window is extended with each repeated message, so bursts lasting longer than interval are still merged
+			aggregation.second = QDateTime::currentMSecsSinceEpoch();
+
+			return;
+		}
+	}
+
+	ConsoleMessage *message = createMessage(category, level, source, window);
+	message->note = argument;
+	message->format = format;
+
+	m_aggregatedMessages[key] = qMakePair(message->identifier, message->time);
+
+	if (m_instance->m_aggregationTimer == 0)
+	{
+		m_instance->m_aggregationTimer = m_instance->startTimer(m_aggregationInterval);
+	}
+
+	emit m_instance->messageAdded(message->identifier);
+}
+
+ConsoleMessage* Console::createMessage(MessageCategory category, MessageLevel level, const QString &source, qint64 window)
+{
+	int index = 0;
 
-	if (m_messages.count() > 1000)
+	if (m_messagesAmount < m_messagesLimit)
 	{
-		m_messages.removeFirst();
+		index = ((m_firstMessage + m_messagesAmount) % m_messagesLimit);
+
+		++m_messagesAmount;
+	}
+	else
+	{
+		index = m_firstMessage;
+
+		m_firstMessage = ((m_firstMessage + 1) % m_messagesLimit);
 	}
 
-	emit m_instance->messageAdded(message);
+	++m_identifier;
+
+	ConsoleMessage *message = &m_messages[index];
+	message->note = QString();
+	message->source = source;
+	message->format = NULL;
+	message->identifier = m_identifier;
+	message->time = QDateTime::currentMSecsSinceEpoch();
+	message->window = window;
+	message->category = category;
+	message->level = level;
+	message->line = -1;
+	message->count = 1;
+
+	return message;
 }
 
 Console *Console::getInstance()
@@ -71,9 +169,44 @@ Console *Console::getInstance()
 	return m_instance;
 }
 
+ConsoleMessage* Console::getMessage(quint64 identifier)
+{
+	if (identifier == 0 || identifier > m_identifier || (m_identifier - identifier) >= quint64(m_messagesAmount))
+	{
+		return NULL;
+	}
+
+	return &m_messages[(m_firstMessage + m_messagesAmount - 1 - int(m_identifier - identifier)) % m_messagesLimit];
+}
+
+QString Console::getNote(const ConsoleMessage *message)
+{
+	if (!message->format)
+	{
+		return message->note;
+	}
+
+	const QString note = QCoreApplication::translate("main", message->format).arg(message->note);
+
+	return ((message->count > 1) ? QCoreApplication::translate("main", "%1 (and %n more)", "", (message->count - 1)).arg(note) : note);
+}
+
 QList<ConsoleMessage*> Console::getMessages()
 {
-	return m_messages;
+	QList<ConsoleMessage*> messages;
+	messages.reserve(m_messagesAmount);
+
+	for (int i = 0; i < m_messagesAmount; ++i)
+	{
+		messages.append(&m_messages[(m_firstMessage + i) % m_messagesLimit]);
+	}
+
+	return messages;
+}
+
+int Console::getMessagesLimit()
+{
+	return m_messagesLimit;
 }
 
 }
@@ -21,7 +21,10 @@
 #define OTTER_CONSOLE_H
 
 #include <QtCore/QDateTime>
+#include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QPair>
+#include <QtCore/QVector>
 
 namespace Otter
 {
@@ -44,13 +47,18 @@ enum MessageLevel
 
 struct ConsoleMessage
 {
-	QDateTime time;
 	QString note;
 	QString source;
+	const char *format;
+	quint64 identifier;
+	qint64 time;
+	qint64 window;
 	MessageCategory category;
 	MessageLevel level;
-	qint64 window;
 	int line;
+	int count;
+
+	ConsoleMessage() : format(NULL), identifier(0), time(0), window(-1), category(OtherMessageCategory), level(UnknownMessageLevel), line(-1), count(0) {}
 };
 
 class Console : public QObject
@@ -58,22 +66,36 @@ class Console : public QObject
 	Q_OBJECT
 
 public:
-	~Console();
-
 	static void createInstance(QObject *parent = NULL);
 	static void addMessage(const QString &note, MessageCategory category, MessageLevel level, const QString &source = QString(), int line = -1, qint64 window = -1);
+	static void addMessage(const char *format, const QString &argument, MessageCategory category, MessageLevel level, const QString &source = QString(), qint64 window = -1);
 	static Console* getInstance();
+	static ConsoleMessage* getMessage(quint64 identifier);
+	static QString getNote(const ConsoleMessage *message);
 	static QList<ConsoleMessage*> getMessages();
+	static int getMessagesLimit();
 
 protected:
 	explicit Console(QObject *parent = NULL);
 
+	void timerEvent(QTimerEvent *event);
+	static ConsoleMessage* createMessage(MessageCategory category, MessageLevel level, const QString &source, qint64 window);
+
 private:
+	int m_aggregationTimer;
+
 	static Console *m_instance;
-	static QList<ConsoleMessage*> m_messages;
+	static QVector<ConsoleMessage> m_messages;
+	static QHash<QPair<const char*, QString>, QPair<quint64, qint64> > m_aggregatedMessages;
+	static quint64 m_identifier;
+	static int m_firstMessage;
+	static int m_messagesAmount;
+	static const int m_messagesLimit;
+	static const int m_aggregationInterval;
 
 signals:
-	void messageAdded(ConsoleMessage *message);
+	void messageAdded(quint64 identifier);
+	void messageChanged(quint64 identifier);
 };
 
 }
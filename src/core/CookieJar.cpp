@@ -24,6 +24,7 @@
 #include <QtCore/QDataStream>
 #include <QtCore/QFile>
 #include <QtCore/QSaveFile>
+#include <QtCore/QSet>
 #include <QtCore/QTimerEvent>
 
 namespace Otter
@@ -33,7 +34,11 @@ CookieJar::CookieJar(bool isPrivate, QObject *parent) : QNetworkCookieJar(parent
 	m_generalCookiesPolicy(AcceptAllCookies),
 	m_thirdPartyCookiesPolicy(AcceptAllCookies),
 	m_keepMode(KeepUntilExpiresMode),
+	m_accessCounter(0),
+	m_domainLimit(SettingsManager::getValue(QLatin1String("Network/CookiesLimitAmountDomain")).toInt()),
+	m_globalLimit(SettingsManager::getValue(QLatin1String("Network/CookiesLimitAmountGlobal")).toInt()),
 	m_saveTimer(0),
+	m_expirationTimer(0),
 	m_isPrivate(isPrivate)
 {
 	if (isPrivate)
@@ -49,6 +54,9 @@ CookieJar::CookieJar(bool isPrivate, QObject *parent) : QNetworkCookieJar(parent
 	}
 
 	QList<QNetworkCookie> allCookies;
+	QList<QDateTime> allCreationTimes;
+	QList<QByteArray> values;
+	QList<qint64> creationTimes;
 	QDataStream stream(&file);
 	quint32 amount;
 
@@ -60,37 +68,55 @@ CookieJar::CookieJar(bool isPrivate, QObject *parent) : QNetworkCookieJar(parent
 
 		stream >> value;
 
-		const QList<QNetworkCookie> cookies = QNetworkCookie::parseCookies(value);
+		values.append(value);
 
-		for (int j = 0; j < cookies.count(); ++j)
+		if (stream.atEnd())
 		{
-			allCookies.append(cookies.at(j));
+			break;
 		}
+	}
 
-		if (stream.atEnd())
+	if (!stream.atEnd())
+	{
+		stream >> creationTimes;
+	}
+
+	for (int i = 0; i < values.count(); ++i)
+	{
+		const QList<QNetworkCookie> cookies = QNetworkCookie::parseCookies(values.at(i));
+		const qint64 creationTime = creationTimes.value(i, 0);
+
+		for (int j = 0; j < cookies.count(); ++j)
 		{
-			break;
+			allCookies.append(cookies.at(j));
+			allCreationTimes.append((creationTime > 0) ? QDateTime::fromMSecsSinceEpoch(creationTime) : QDateTime());
 		}
 	}
 
 	optionChanged(QLatin1String("Network/CookiesPolicy"), SettingsManager::getValue(QLatin1String("Network/CookiesPolicy")));
-	setAllCookies(allCookies);
+	resetEntries(allCookies, allCreationTimes);
 
 	connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), this, SLOT(optionChanged(QString,QVariant)));
 }
 
 void CookieJar::timerEvent(QTimerEvent *event)
 {
-	if (event->timerId() != m_saveTimer)
+	if (event->timerId() == m_saveTimer)
 	{
-		return;
-	}
+		killTimer(m_saveTimer);
 
-	killTimer(m_saveTimer);
+		m_saveTimer = 0;
 
-	m_saveTimer = 0;
+		save();
+	}
+	else if (event->timerId() == m_expirationTimer)
+	{
+		killTimer(m_expirationTimer);
 
-	save();
+		m_expirationTimer = 0;
+
+		removeExpiredCookies();
+	}
 }
 
 void CookieJar::optionChanged(const QString &option, const QVariant &value)
@@ -99,6 +125,14 @@ void CookieJar::optionChanged(const QString &option, const QVariant &value)
 	{
 		m_generalCookiesPolicy = IgnoreCookies;
 	}
+	else if (option == QLatin1String("Network/CookiesLimitAmountDomain"))
+	{
+		m_domainLimit = value.toInt();
+	}
+	else if (option == QLatin1String("Network/CookiesLimitAmountGlobal"))
+	{
+		m_globalLimit = value.toInt();
+	}
 	else if (option == QLatin1String("Network/CookiesPolicy"))
 	{
 		if (SettingsManager::getValue(QLatin1String("Browser/PrivateMode")).toBool() || value.toString() == QLatin1String("ignore"))
@@ -122,17 +156,40 @@ void CookieJar::optionChanged(const QString &option, const QVariant &value)
 
 void CookieJar::clearCookies(int period)
 {
-	Q_UNUSED(period)
+	if (period <= 0)
+	{
+		const QList<QNetworkCookie> cookies = allCookies();
 
-	const QList<QNetworkCookie> cookies = allCookies();
+		setAllCookies(QList<QNetworkCookie>());
 
-	for (int i = 0; i < cookies.length(); ++i)
-	{
-		QNetworkCookieJar::deleteCookie(cookies.at(i));
+		m_entries.clear();
+		m_domains.clear();
+		m_expirations.clear();
+
+		scheduleExpiration();
+		save();
 
-		emit cookieRemoved(cookies.at(i));
+		if (!cookies.isEmpty())
+		{
+			emit cookiesRemoved(cookies);
+		}
+
+		return;
 	}
 
+	const QDateTime minimumCreationTime = QDateTime::currentDateTime().addSecs(-period * 3600);
+	QStringList keys;
+	QHash<QString, CookieEntry>::const_iterator iterator;
+
+	for (iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+	{
+		if (iterator.value().creationTime.isValid() && iterator.value().creationTime >= minimumCreationTime)
+		{
+			keys.append(iterator.key());
+		}
+	}
+
+	removeEntries(keys);
 	save();
 }
 
@@ -144,6 +201,21 @@ void CookieJar::scheduleSave()
 	}
 }
 
+void CookieJar::scheduleExpiration()
+{
+	if (m_expirationTimer != 0)
+	{
+		killTimer(m_expirationTimer);
+
+		m_expirationTimer = 0;
+	}
+
+	if (!m_expirations.isEmpty())
+	{
+		m_expirationTimer = startTimer(int(qBound(qint64(1000), QDateTime::currentDateTime().msecsTo(m_expirations.constBegin().key()), qint64(3600000))));
+	}
+}
+
 void CookieJar::save()
 {
 	QSaveFile file(SessionsManager::getWritableDataPath(QLatin1String("cookies.dat")));
@@ -154,28 +226,243 @@ void CookieJar::save()
 	}
 
 	const QList<QNetworkCookie> cookies = allCookies();
-	QDataStream stream(&file);
-	stream << quint32(cookies.length());
+	QList<QNetworkCookie> persistentCookies;
+	QList<qint64> creationTimes;
 
-	for (int i = 0; i < cookies.length(); ++i)
+	for (int i = 0; i < cookies.count(); ++i)
 	{
 		if (!cookies.at(i).isSessionCookie())
 		{
-			stream << cookies.at(i).toRawForm();
+			persistentCookies.append(cookies.at(i));
 		}
 	}
 
+	QDataStream stream(&file);
+	stream << quint32(persistentCookies.count());
+
+	for (int i = 0; i < persistentCookies.count(); ++i)
+	{
+		const QDateTime creationTime = m_entries.value(getCookieKey(persistentCookies.at(i))).creationTime;
+
+		stream << persistentCookies.at(i).toRawForm();
+
+		creationTimes.append(creationTime.isValid() ? creationTime.toMSecsSinceEpoch() : 0);
+	}
+
+	stream << creationTimes;
+
 	file.commit();
 }
 
+void CookieJar::addEntry(const QNetworkCookie &cookie, const QDateTime &creationTime)
+{
+	const QString key = getCookieKey(cookie);
+	CookieEntry entry;
+	entry.cookie = cookie;
+	entry.creationTime = creationTime;
+	entry.lastAccess = ++m_accessCounter;
+
+	m_entries[key] = entry;
+	m_domains[getCookieDomain(cookie)].append(key);
+
+	if (!cookie.isSessionCookie())
+	{
+		m_expirations.insert(cookie.expirationDate(), key);
+
+		if (m_expirationTimer == 0 || m_expirations.constBegin().value() == key)
+		{
+			scheduleExpiration();
+		}
+	}
+}
+
+void CookieJar::removeEntry(const QString &key)
+{
+	if (!m_entries.contains(key))
+	{
+		return;
+	}
+
+	const QNetworkCookie cookie = m_entries.take(key).cookie;
+	const QString domain = getCookieDomain(cookie);
+
+	if (m_domains.contains(domain))
+	{
+		m_domains[domain].removeOne(key);
+
+		if (m_domains[domain].isEmpty())
+		{
+			m_domains.remove(domain);
+		}
+	}
+
+	if (!cookie.isSessionCookie())
+	{
+		m_expirations.remove(cookie.expirationDate(), key);
+	}
+}
+
+void CookieJar::removeEntries(const QStringList &keys)
+{
+	if (keys.isEmpty())
+	{
+		return;
+	}
+
+	const QSet<QString> removedKeys = keys.toSet();
+	const QList<QNetworkCookie> cookies = allCookies();
+	QList<QNetworkCookie> remainingCookies;
+	QList<QNetworkCookie> removedCookies;
+	remainingCookies.reserve(cookies.count());
+
+	for (int i = 0; i < cookies.count(); ++i)
+	{
+		if (removedKeys.contains(getCookieKey(cookies.at(i))))
+		{
+			removedCookies.append(cookies.at(i));
+		}
+		else
+		{
+			remainingCookies.append(cookies.at(i));
+		}
+	}
+
+	setAllCookies(remainingCookies);
+
+	for (int i = 0; i < keys.count(); ++i)
+	{
+		removeEntry(keys.at(i));
+	}
+
+	scheduleSave();
+
+	if (!removedCookies.isEmpty())
+	{
+		emit cookiesRemoved(removedCookies);
+	}
+}
+
+void CookieJar::removeExpiredCookies()
+{
+	const QDateTime currentDateTime = QDateTime::currentDateTime();
+	QStringList keys;
+	QMultiMap<QDateTime, QString>::const_iterator iterator;
+
+	for (iterator = m_expirations.constBegin(); (iterator != m_expirations.constEnd() && iterator.key() <= currentDateTime); ++iterator)
+	{
+		keys.append(iterator.value());
+	}
+
+	removeEntries(keys);
+	scheduleExpiration();
+}
+
+void CookieJar::applyLimits(const QString &domain)
+{
+	if (m_domainLimit > 0 && m_domains.value(domain).count() > m_domainLimit)
+	{
+		const QStringList keys = m_domains.value(domain);
+
+		removeEntries(getLeastRecentlyUsed(keys, (keys.count() - m_domainLimit)));
+	}
+
+	if (m_globalLimit > 0 && m_entries.count() > m_globalLimit)
+	{
+		removeEntries(getLeastRecentlyUsed(m_entries.keys(), (m_entries.count() - ((m_globalLimit * 9) / 10))));
+	}
+}
+
+void CookieJar::resetEntries(const QList<QNetworkCookie> &cookies, const QList<QDateTime> &creationTimes)
+{
+	const QDateTime currentDateTime = QDateTime::currentDateTime();
+	QList<QNetworkCookie> validCookies;
+
+	m_entries.clear();
+	m_domains.clear();
+	m_expirations.clear();
+
+	for (int i = 0; i < cookies.count(); ++i)
+	{
+		if ((!cookies.at(i).isSessionCookie() && cookies.at(i).expirationDate() <= currentDateTime) || m_entries.contains(getCookieKey(cookies.at(i))))
+		{
+			continue;
+		}
+
+		validCookies.append(cookies.at(i));
+
+		addEntry(cookies.at(i), creationTimes.value(i));
+	}
+
+	setAllCookies(validCookies);
+	scheduleExpiration();
+
+	if (m_globalLimit > 0 && m_entries.count() > m_globalLimit)
+	{
+		removeEntries(getLeastRecentlyUsed(m_entries.keys(), (m_entries.count() - m_globalLimit)));
+	}
+}
+
+void CookieJar::touchCookies(const QList<QNetworkCookie> &cookies) const
+{
+	for (int i = 0; i < cookies.count(); ++i)
+	{
+		QHash<QString, CookieEntry>::iterator iterator = m_entries.find(getCookieKey(cookies.at(i)));
+
+		if (iterator != m_entries.end())
+		{
+			iterator.value().lastAccess = ++m_accessCounter;
+		}
+	}
+}
+
 CookieJar* CookieJar::clone(QObject *parent)
 {
+	const QList<QNetworkCookie> cookies = allCookies();
+	QList<QDateTime> creationTimes;
+
+	for (int i = 0; i < cookies.count(); ++i)
+	{
+		creationTimes.append(m_entries.value(getCookieKey(cookies.at(i))).creationTime);
+	}
+
 	CookieJar *cookieJar = new CookieJar(m_isPrivate, parent);
-	cookieJar->setAllCookies(allCookies());
+	cookieJar->resetEntries(cookies, creationTimes);
 
 	return cookieJar;
 }
 
+QString CookieJar::getCookieKey(const QNetworkCookie &cookie)
+{
+	return cookie.domain() + QLatin1Char('\n') + cookie.path() + QLatin1Char('\n') + QString::fromLatin1(cookie.name());
+}
+
+QString CookieJar::getCookieDomain(const QNetworkCookie &cookie)
+{
+	return (cookie.domain().startsWith(QLatin1Char('.')) ? cookie.domain().mid(1) : cookie.domain());
+}
+
+QStringList CookieJar::getLeastRecentlyUsed(const QStringList &keys, int amount) const
+{
+	QList<QPair<quint64, QString> > accesses;
+	accesses.reserve(keys.count());
+
+	for (int i = 0; i < keys.count(); ++i)
+	{
+		accesses.append(qMakePair(m_entries.value(keys.at(i)).lastAccess, keys.at(i)));
+	}
+
+	qSort(accesses);
+
+	QStringList leastRecentlyUsed;
+
+	for (int i = 0; i < qMin(amount, accesses.count()); ++i)
+	{
+		leastRecentlyUsed.append(accesses.at(i).second);
+	}
+
+	return leastRecentlyUsed;
+}
+
 QList<QNetworkCookie> CookieJar::cookiesForUrl(const QUrl &url) const
 {
 	if (m_generalCookiesPolicy == IgnoreCookies)
@@ -183,69 +470,97 @@ QList<QNetworkCookie> CookieJar::cookiesForUrl(const QUrl &url) const
 		return QList<QNetworkCookie>();
 	}
 
-	return QNetworkCookieJar::cookiesForUrl(url);
+	return getCookiesForUrl(url);
 }
 
 QList<QNetworkCookie> CookieJar::getCookiesForUrl(const QUrl &url) const
 {
-	return QNetworkCookieJar::cookiesForUrl(url);
+	const QList<QNetworkCookie> cookies = QNetworkCookieJar::cookiesForUrl(url);
+
+	touchCookies(cookies);
+
+	return cookies;
 }
 
 QList<QNetworkCookie> CookieJar::getCookies(const QString &domain) const
 {
-	if (!domain.isEmpty())
+	if (domain.isEmpty())
 	{
-		const QList<QNetworkCookie> cookies = allCookies();
-		QList<QNetworkCookie> domainCookies;
+		return allCookies();
+	}
+
+	QList<QNetworkCookie> domainCookies;
+	QString parentDomain = domain;
 
-		for (int i = 0; i < cookies.length(); ++i)
+	while (!parentDomain.isEmpty())
+	{
+		const QStringList keys = m_domains.value(parentDomain);
+
+		for (int i = 0; i < keys.count(); ++i)
 		{
-			if (cookies.at(i).domain() == domain || (cookies.at(i).domain().startsWith(QLatin1Char('.')) && domain.endsWith(cookies.at(i).domain())))
+			const QNetworkCookie cookie = m_entries.value(keys.at(i)).cookie;
+
+			if (cookie.domain() == domain || (cookie.domain().startsWith(QLatin1Char('.')) && domain.endsWith(cookie.domain())))
 			{
-				domainCookies.append(cookies.at(i));
+				domainCookies.append(cookie);
 			}
 		}
 
-		return domainCookies;
+		const int position = parentDomain.indexOf(QLatin1Char('.'));
+
+		if (position < 0)
+		{
+			break;
+		}
+
+		parentDomain = parentDomain.mid(position + 1);
 	}
 
-	return allCookies();
+	return domainCookies;
 }
 
-bool CookieJar::insertCookie(const QNetworkCookie &cookie)
+QList<QNetworkCookie> CookieJar::getDomainCookies(const QString &domain) const
 {
-	if (m_generalCookiesPolicy != AcceptAllCookies)
+	const QStringList keys = m_domains.value(domain);
+	QList<QNetworkCookie> cookies;
+	cookies.reserve(keys.count());
+
+	for (int i = 0; i < keys.count(); ++i)
 	{
-		return false;
+		cookies.append(m_entries.value(keys.at(i)).cookie);
 	}
 
-	const bool result = QNetworkCookieJar::insertCookie(cookie);
-
-	if (result)
-	{
-		scheduleSave();
+	return cookies;
+}
 
-		emit cookieAdded(cookie);
-	}
+QStringList CookieJar::getDomains() const
+{
+	return m_domains.keys();
+}
 
-	return result;
+int CookieJar::getCookiesAmount(const QString &domain) const
+{
+	return m_domains.value(domain).count();
 }
 
-bool CookieJar::updateCookie(const QNetworkCookie &cookie)
+bool CookieJar::insertCookie(const QNetworkCookie &cookie)
 {
-	if (m_generalCookiesPolicy == IgnoreCookies || m_generalCookiesPolicy == ReadOnlyCookies)
+	if (m_generalCookiesPolicy != AcceptAllCookies)
 	{
 		return false;
 	}
 
-	const bool result = QNetworkCookieJar::updateCookie(cookie);
+	return forceInsertCookie(cookie);
+}
 
-	if (result)
+bool CookieJar::updateCookie(const QNetworkCookie &cookie)
+{
+	if (m_generalCookiesPolicy == IgnoreCookies || m_generalCookiesPolicy == ReadOnlyCookies)
 	{
-		scheduleSave();
+		return false;
 	}
 
-	return result;
+	return forceUpdateCookie(cookie);
 }
 
 bool CookieJar::deleteCookie(const QNetworkCookie &cookie)
@@ -255,27 +570,42 @@ bool CookieJar::deleteCookie(const QNetworkCookie &cookie)
 		return false;
 	}
 
-	const bool result = QNetworkCookieJar::deleteCookie(cookie);
+	return forceDeleteCookie(cookie);
+}
 
-	if (result)
+bool CookieJar::forceInsertCookie(const QNetworkCookie &cookie)
+{
+	const QString key = getCookieKey(cookie);
+	QDateTime creationTime = QDateTime::currentDateTime();
+	bool isReplacing = false;
+
+	if (m_entries.contains(key))
 	{
-		scheduleSave();
+		creationTime = m_entries.value(key).creationTime;
+		isReplacing = QNetworkCookieJar::deleteCookie(cookie);
 
-		emit cookieRemoved(cookie);
-	}
+		removeEntry(key);
 
-	return result;
-}
+		if (isReplacing)
+		{
+			emit cookieRemoved(cookie);
+		}
+	}
 
-bool CookieJar::forceInsertCookie(const QNetworkCookie &cookie)
-{
 	const bool result = QNetworkCookieJar::insertCookie(cookie);
 
 	if (result)
 	{
+		addEntry(cookie, creationTime);
 		scheduleSave();
 
 		emit cookieAdded(cookie);
+
+		applyLimits(getCookieDomain(cookie));
+	}
+	else if (isReplacing)
+	{
+		scheduleSave();
 	}
 
 	return result;
@@ -283,14 +613,12 @@ bool CookieJar::forceInsertCookie(const QNetworkCookie &cookie)
 
 bool CookieJar::forceUpdateCookie(const QNetworkCookie &cookie)
 {
-	const bool result = QNetworkCookieJar::updateCookie(cookie);
-
-	if (result)
+	if (!m_entries.contains(getCookieKey(cookie)))
 	{
-		scheduleSave();
+		return false;
 	}
 
-	return result;
+	return forceInsertCookie(cookie);
 }
 
 bool CookieJar::forceDeleteCookie(const QNetworkCookie &cookie)
@@ -299,6 +627,7 @@ bool CookieJar::forceDeleteCookie(const QNetworkCookie &cookie)
 
 	if (result)
 	{
+		removeEntry(getCookieKey(cookie));
 		scheduleSave();
 
 		emit cookieRemoved(cookie);
@@ -309,16 +638,13 @@ bool CookieJar::forceDeleteCookie(const QNetworkCookie &cookie)
 
 bool CookieJar::hasCookie(const QNetworkCookie &cookie) const
 {
-	QUrl url;
-	url.setScheme(cookie.isSecure() ? QLatin1String("https") : QLatin1String("http"));
-	url.setHost(cookie.domain().startsWith(QLatin1Char('.')) ? cookie.domain().mid(1) : cookie.domain());
-	url.setPath(cookie.path());
+	const QStringList keys = m_domains.value(getCookieDomain(cookie));
 
-	const QList<QNetworkCookie> cookies = getCookiesForUrl(url);
-
-	for (int i = 0; i < cookies.count(); ++i)
+	for (int i = 0; i < keys.count(); ++i)
 	{
-		if (cookies.at(i).domain() == cookie.domain() && cookies.at(i).name() == cookie.name())
+		const QNetworkCookie existingCookie = m_entries.value(keys.at(i)).cookie;
+
+		if (existingCookie.domain() == cookie.domain() && existingCookie.name() == cookie.name())
 		{
 			return true;
 		}
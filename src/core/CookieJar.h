@@ -20,6 +20,8 @@
 #ifndef OTTER_COOKIEJAR_H
 #define OTTER_COOKIEJAR_H
 
+#include <QtCore/QDateTime>
+#include <QtCore/QMap>
 #include <QtNetwork/QNetworkCookie>
 #include <QtNetwork/QNetworkCookieJar>
 
@@ -60,6 +62,9 @@ public:
 	QList<QNetworkCookie> cookiesForUrl(const QUrl &url) const;
 	QList<QNetworkCookie> getCookiesForUrl(const QUrl &url) const;
 	QList<QNetworkCookie> getCookies(const QString &domain = QString()) const;
+	QList<QNetworkCookie> getDomainCookies(const QString &domain) const;
+	QStringList getDomains() const;
+	int getCookiesAmount(const QString &domain) const;
 	bool insertCookie(const QNetworkCookie &cookie);
 	bool updateCookie(const QNetworkCookie &cookie);
 	bool deleteCookie(const QNetworkCookie &cookie);
@@ -70,9 +75,29 @@ public:
 	static bool isDomainTheSame(const QUrl &first, const QUrl &second);
 
 protected:
+	struct CookieEntry
+	{
+		QNetworkCookie cookie;
+		QDateTime creationTime;
+		quint64 lastAccess;
+
+		CookieEntry() : lastAccess(0) {}
+	};
+
 	void timerEvent(QTimerEvent *event);
 	void scheduleSave();
+	void scheduleExpiration();
 	void save();
+	void addEntry(const QNetworkCookie &cookie, const QDateTime &creationTime);
+	void removeEntry(const QString &key);
+	void removeEntries(const QStringList &keys);
+	void removeExpiredCookies();
+	void applyLimits(const QString &domain);
+	void resetEntries(const QList<QNetworkCookie> &cookies, const QList<QDateTime> &creationTimes = QList<QDateTime>());
+	void touchCookies(const QList<QNetworkCookie> &cookies) const;
+	QStringList getLeastRecentlyUsed(const QStringList &keys, int amount) const;
+	static QString getCookieKey(const QNetworkCookie &cookie);
+	static QString getCookieDomain(const QNetworkCookie &cookie);
 
 protected slots:
 	void optionChanged(const QString &option, const QVariant &value);
@@ -81,12 +106,20 @@ private:
 	CookiesPolicy m_generalCookiesPolicy;
 	CookiesPolicy m_thirdPartyCookiesPolicy;
 	KeepMode m_keepMode;
+	mutable QHash<QString, CookieEntry> m_entries;
+	QHash<QString, QStringList> m_domains;
+	QMultiMap<QDateTime, QString> m_expirations;
+	mutable quint64 m_accessCounter;
+	int m_domainLimit;
+	int m_globalLimit;
 	int m_saveTimer;
+	int m_expirationTimer;
 	bool m_isPrivate;
 
 signals:
 	void cookieAdded(QNetworkCookie cookie);
 	void cookieRemoved(QNetworkCookie cookie);
+	void cookiesRemoved(QList<QNetworkCookie> cookies);
 };
 
 }
@@ -0,0 +1,384 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "CookiesModel.h"
+#include "CookieJar.h"
+
+namespace Otter
+{
+
+CookiesModel::CookiesModel(CookieJar *cookieJar, QObject *parent) : DomainsModel(parent),
+	m_cookieJar(cookieJar)
+{
+	populateDomains();
+
+	connect(m_cookieJar, SIGNAL(cookieAdded(QNetworkCookie)), this, SLOT(addCookie(QNetworkCookie)));
+	connect(m_cookieJar, SIGNAL(cookieRemoved(QNetworkCookie)), this, SLOT(removeCookie(QNetworkCookie)));
+	connect(m_cookieJar, SIGNAL(cookiesRemoved(QList<QNetworkCookie>)), this, SLOT(removeCookies(QList<QNetworkCookie>)));
+}
+
+CookiesModel::~CookiesModel()
+{
+}
+
+void CookiesModel::populateDomains()
+{
+	QStringList domains = m_cookieJar->getDomains();
+	domains.sort();
+
+	clearDomains();
+
+	for (int i = 0; i < domains.count(); ++i)
+	{
+		CookiesEntry *entry = new CookiesEntry();
+		entry->domain = domains.at(i);
+		entry->amount = m_cookieJar->getCookiesAmount(domains.at(i));
+
+		insertDomain(i, entry);
+	}
+}
+
+void CookiesModel::addCookie(const QNetworkCookie &cookie)
+{
+	const QString domain = getDomain(cookie);
+	CookiesEntry *entry = static_cast<CookiesEntry*>(findDomain(domain));
+
+	if (!entry)
+	{
+		const int row = getInsertionRow(domain);
+
+		beginInsertRows(QModelIndex(), row, row);
+
+		entry = new CookiesEntry();
+		entry->domain = domain;
+		entry->amount = 1;
+
+		insertDomain(row, entry);
+
+		endInsertRows();
+
+		return;
+	}
+
+	const QModelIndex domainIndex = index(findDomainRow(domain), 0);
+
+	if (entry->isPopulated)
+	{
+		const int existingRow = findCookieRow(entry, cookie);
+
+		if (existingRow >= 0)
+		{
+			entry->cookies[existingRow] = cookie;
+
+			const QModelIndex cookieIndex = index(existingRow, 0, domainIndex);
+
+			emit dataChanged(cookieIndex, cookieIndex);
+
+			return;
+		}
+
+		const int row = getCookieInsertionRow(entry, cookie);
+
+		beginInsertRows(domainIndex, row, row);
+
+		entry->cookies.insert(row, cookie);
+		entry->amount = entry->cookies.count();
+
+		endInsertRows();
+	}
+	else
+	{
+		++entry->amount;
+	}
+
+	emit dataChanged(domainIndex, domainIndex);
+}
+
+void CookiesModel::removeCookie(const QNetworkCookie &cookie)
+{
+	const QString domain = getDomain(cookie);
+	CookiesEntry *entry = static_cast<CookiesEntry*>(findDomain(domain));
+
+	if (!entry)
+	{
+		return;
+	}
+
+	const int domainRow = findDomainRow(domain);
+	const QModelIndex domainIndex = index(domainRow, 0);
+
+	if (entry->isPopulated)
+	{
+		const int row = findCookieRow(entry, cookie);
+
+		if (row < 0)
+		{
+			return;
+		}
+
+		beginRemoveRows(domainIndex, row, row);
+
+		entry->cookies.removeAt(row);
+		entry->amount = entry->cookies.count();
+
+		endRemoveRows();
+	}
+	else
+	{
+		--entry->amount;
+	}
+
+	if (entry->amount > 0)
+	{
+		emit dataChanged(domainIndex, domainIndex);
+
+		return;
+	}
+
+	beginRemoveRows(QModelIndex(), domainRow, domainRow);
+
+	removeDomain(domainRow);
+
+	endRemoveRows();
+}
+
+void CookiesModel::removeCookies(const QList<QNetworkCookie> &cookies)
+{
+	if (cookies.count() < 100)
+	{
+		for (int i = 0; i < cookies.count(); ++i)
+		{
+			removeCookie(cookies.at(i));
+		}
+
+		return;
+	}
+
+	beginResetModel();
+
+	populateDomains();
+
+	endResetModel();
+}
+
+void CookiesModel::fetchMore(const QModelIndex &parent)
+{
+	CookiesEntry *entry = getCookiesEntry(parent);
+
+	if (!entry || entry->isPopulated)
+	{
+		return;
+	}
+
+	QList<QNetworkCookie> cookies = m_cookieJar->getDomainCookies(entry->domain);
+
+	qSort(cookies.begin(), cookies.end(), compareCookies);
+
+	if (!cookies.isEmpty())
+	{
+		beginInsertRows(parent, 0, (cookies.count() - 1));
+	}
+
+	entry->cookies = cookies;
+	entry->isPopulated = true;
+
+	if (!cookies.isEmpty())
+	{
+		endInsertRows();
+	}
+
+	if (entry->amount != cookies.count())
+	{
+		entry->amount = cookies.count();
+
+		emit dataChanged(parent, parent);
+	}
+}
+
+QModelIndex CookiesModel::index(int row, int column, const QModelIndex &parent) const
+{
+	if (column != 0 || row < 0)
+	{
+		return QModelIndex();
+	}
+
+	if (!parent.isValid())
+	{
+		return ((row < getDomainsAmount()) ? createIndex(row, column) : QModelIndex());
+	}
+
+	CookiesEntry *entry = getCookiesEntry(parent);
+
+	if (!entry || row >= entry->cookies.count())
+	{
+		return QModelIndex();
+	}
+
+	return createEntryIndex(row, column, entry);
+}
+
+CookiesModel::CookiesEntry* CookiesModel::getCookiesEntry(const QModelIndex &index) const
+{
+	return static_cast<CookiesEntry*>(getDomainEntry(index));
+}
+
+QNetworkCookie CookiesModel::getCookie(const QModelIndex &index) const
+{
+	const CookiesEntry *entry = static_cast<CookiesEntry*>(getParentEntry(index));
+
+	return (entry ? entry->cookies.value(index.row()) : QNetworkCookie());
+}
+
+QVariant CookiesModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid())
+	{
+		return QVariant();
+	}
+
+	if (index.internalPointer())
+	{
+		const QNetworkCookie cookie = getCookie(index);
+
+		switch (role)
+		{
+			case Qt::DisplayRole:
+			case Qt::ToolTipRole:
+				return QString(cookie.name());
+			case PathRole:
+				return cookie.path();
+			case DomainRole:
+				return cookie.domain();
+			default:
+				return QVariant();
+		}
+	}
+
+	const CookiesEntry *entry = getCookiesEntry(index);
+
+	if (!entry)
+	{
+		return QVariant();
+	}
+
+	switch (role)
+	{
+		case Qt::DisplayRole:
+			return QStringLiteral("%1 (%2)").arg(entry->domain).arg(entry->amount);
+		case Qt::ToolTipRole:
+			return entry->domain;
+		case Qt::DecorationRole:
+			return getDomainIcon(entry->domain);
+		default:
+			return QVariant();
+	}
+}
+
+QList<QNetworkCookie> CookiesModel::getCookies(const QModelIndex &index) const
+{
+	if (index.internalPointer())
+	{
+		return (QList<QNetworkCookie>() << getCookie(index));
+	}
+
+	const CookiesEntry *entry = getCookiesEntry(index);
+
+	if (!entry)
+	{
+		return QList<QNetworkCookie>();
+	}
+
+	return (entry->isPopulated ? entry->cookies : m_cookieJar->getDomainCookies(entry->domain));
+}
+
+QString CookiesModel::getDomain(const QNetworkCookie &cookie)
+{
+	return (cookie.domain().startsWith(QLatin1Char('.')) ? cookie.domain().mid(1) : cookie.domain());
+}
+
+bool CookiesModel::compareCookies(const QNetworkCookie &first, const QNetworkCookie &second)
+{
+	return (first.name() < second.name());
+}
+
+int CookiesModel::findCookieRow(const CookiesEntry *entry, const QNetworkCookie &cookie) const
+{
+	for (int i = 0; i < entry->cookies.count(); ++i)
+	{
+		if (entry->cookies.at(i).hasSameIdentifier(cookie))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+int CookiesModel::getCookieInsertionRow(const CookiesEntry *entry, const QNetworkCookie &cookie) const
+{
+	for (int i = 0; i < entry->cookies.count(); ++i)
+	{
+		if (compareCookies(cookie, entry->cookies.at(i)))
+		{
+			return i;
+		}
+	}
+
+	return entry->cookies.count();
+}
+
+int CookiesModel::columnCount(const QModelIndex &parent) const
+{
+	Q_UNUSED(parent)
+
+	return 1;
+}
+
+int CookiesModel::rowCount(const QModelIndex &parent) const
+{
+	if (!parent.isValid())
+	{
+		return getDomainsAmount();
+	}
+
+	const CookiesEntry *entry = getCookiesEntry(parent);
+
+	return (entry ? entry->cookies.count() : 0);
+}
+
+bool CookiesModel::canFetchMore(const QModelIndex &parent) const
+{
+	const CookiesEntry *entry = getCookiesEntry(parent);
+
+	return (entry && !entry->isPopulated);
+}
+
+bool CookiesModel::hasChildren(const QModelIndex &parent) const
+{
+	if (!parent.isValid())
+	{
+		return (getDomainsAmount() > 0);
+	}
+
+	const CookiesEntry *entry = getCookiesEntry(parent);
+
+	return (entry && entry->amount > 0);
+}
+
+}
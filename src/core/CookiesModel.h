@@ -0,0 +1,84 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_COOKIESMODEL_H
+#define OTTER_COOKIESMODEL_H
+
+#include "DomainsModel.h"
+
+#include <QtNetwork/QNetworkCookie>
+
+namespace Otter
+{
+
+class CookieJar;
+
+class CookiesModel : public DomainsModel
+{
+	Q_OBJECT
+
+public:
+	enum CookieRole
+	{
+		PathRole = Qt::UserRole,
+		DomainRole = (Qt::UserRole + 1)
+	};
+
+	explicit CookiesModel(CookieJar *cookieJar, QObject *parent = NULL);
+	~CookiesModel();
+
+	void fetchMore(const QModelIndex &parent);
+	QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+	QNetworkCookie getCookie(const QModelIndex &index) const;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+	QList<QNetworkCookie> getCookies(const QModelIndex &index) const;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	bool canFetchMore(const QModelIndex &parent) const;
+	bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+
+protected:
+	struct CookiesEntry : public DomainEntry
+	{
+		QList<QNetworkCookie> cookies;
+		int amount;
+		bool isPopulated;
+
+		CookiesEntry() : amount(0), isPopulated(false) {}
+	};
+
+	void populateDomains();
+	CookiesEntry* getCookiesEntry(const QModelIndex &index) const;
+	int findCookieRow(const CookiesEntry *entry, const QNetworkCookie &cookie) const;
+	int getCookieInsertionRow(const CookiesEntry *entry, const QNetworkCookie &cookie) const;
+	static QString getDomain(const QNetworkCookie &cookie);
+	static bool compareCookies(const QNetworkCookie &first, const QNetworkCookie &second);
+
+protected slots:
+	void addCookie(const QNetworkCookie &cookie);
+	void removeCookie(const QNetworkCookie &cookie);
+	void removeCookies(const QList<QNetworkCookie> &cookies);
+
+private:
+	CookieJar *m_cookieJar;
+};
+
+}
+
+#endif
@@ -0,0 +1,186 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "DomainsModel.h"
+#include "AddonsManager.h"
+#include "WebBackend.h"
+
+#include <QtCore/QTimer>
+
+namespace Otter
+{
+
+DomainsModel::DomainsModel(QObject *parent) : QAbstractItemModel(parent),
+	m_isLoadingIcons(false)
+{
+}
+
+DomainsModel::~DomainsModel()
+{
+	qDeleteAll(m_domains);
+}
+
+void DomainsModel::insertDomain(int row, DomainEntry *entry)
+{
+	m_domains.insert(row, entry);
+	m_domainEntries[entry->domain] = entry;
+}
+
+void DomainsModel::removeDomain(int row)
+{
+	DomainEntry *entry = m_domains.takeAt(row);
+
+	m_domainEntries.remove(entry->domain);
+
+	delete entry;
+}
+
+void DomainsModel::clearDomains()
+{
+	qDeleteAll(m_domains);
+
+	m_domains.clear();
+	m_domainEntries.clear();
+}
+
+void DomainsModel::loadIcons()
+{
+	WebBackend *backend = AddonsManager::getWebBackend();
+
+	for (int i = 0; (i < 10 && !m_pendingIcons.isEmpty()); ++i)
+	{
+		const QString domain = m_pendingIcons.takeFirst();
+		const int row = findDomainRow(domain);
+
+		m_icons[domain] = backend->getIconForUrl(QUrl(QStringLiteral("http://%1/").arg(domain)));
+
+		if (row >= 0)
+		{
+			const QModelIndex domainIndex = index(row, 0);
+
+			emit dataChanged(domainIndex, domainIndex);
+		}
+	}
+
+	m_isLoadingIcons = !m_pendingIcons.isEmpty();
+
+	if (m_isLoadingIcons)
+	{
+		QTimer::singleShot(0, this, SLOT(loadIcons()));
+	}
+}
+
+QModelIndex DomainsModel::parent(const QModelIndex &index) const
+{
+	const DomainEntry *entry = getParentEntry(index);
+
+	if (!entry)
+	{
+		return QModelIndex();
+	}
+
+	const int row = findDomainRow(entry->domain);
+
+	return ((row >= 0) ? createIndex(row, 0) : QModelIndex());
+}
+
+QModelIndex DomainsModel::createEntryIndex(int row, int column, DomainEntry *entry) const
+{
+	return createIndex(row, column, entry);
+}
+
+DomainsModel::DomainEntry* DomainsModel::getDomainEntry(const QModelIndex &index) const
+{
+	if (!index.isValid() || index.internalPointer() || index.row() >= m_domains.count())
+	{
+		return NULL;
+	}
+
+	return m_domains.at(index.row());
+}
+
+DomainsModel::DomainEntry* DomainsModel::getParentEntry(const QModelIndex &index) const
+{
+	if (!index.isValid() || !index.internalPointer())
+	{
+		return NULL;
+	}
+
+	return static_cast<DomainEntry*>(index.internalPointer());
+}
+
+DomainsModel::DomainEntry* DomainsModel::findDomain(const QString &domain) const
+{
+	return m_domainEntries.value(domain);
+}
+
+QIcon DomainsModel::getDomainIcon(const QString &domain) const
+{
+// icons are requested from backend in small batches, so that expanding big model does not block
+	if (!m_icons.contains(domain))
+	{
+		m_icons[domain] = QIcon();
+		m_pendingIcons.append(domain);
+
+		if (!m_isLoadingIcons)
+		{
+			m_isLoadingIcons = true;
+
+			QTimer::singleShot(0, this, SLOT(loadIcons()));
+		}
+	}
+
+	return m_icons.value(domain);
+}
+
+int DomainsModel::findDomainRow(const QString &domain) const
+{
+	const int row = getInsertionRow(domain);
+
+	return ((row < m_domains.count() && m_domains.at(row)->domain == domain) ? row : -1);
+}
+
+int DomainsModel::getInsertionRow(const QString &domain) const
+{
+	int first = 0;
+	int last = m_domains.count();
+
+	while (first < last)
+	{
+		const int middle = ((first + last) / 2);
+
+		if (m_domains.at(middle)->domain < domain)
+		{
+			first = (middle + 1);
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+
+	return first;
+}
+
+int DomainsModel::getDomainsAmount() const
+{
+	return m_domains.count();
+}
+
+}
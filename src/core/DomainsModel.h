@@ -0,0 +1,72 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_DOMAINSMODEL_H
+#define OTTER_DOMAINSMODEL_H
+
+#include <QtCore/QAbstractItemModel>
+#include <QtGui/QIcon>
+
+namespace Otter
+{
+
+class DomainsModel : public QAbstractItemModel
+{
+	Q_OBJECT
+
+public:
+	explicit DomainsModel(QObject *parent = NULL);
+	~DomainsModel();
+
+	QModelIndex parent(const QModelIndex &index) const;
+
+protected:
+	struct DomainEntry
+	{
+		QString domain;
+
+		virtual ~DomainEntry() {}
+	};
+
+	void insertDomain(int row, DomainEntry *entry);
+	void removeDomain(int row);
+	void clearDomains();
+	QModelIndex createEntryIndex(int row, int column, DomainEntry *entry) const;
+	DomainEntry* getDomainEntry(const QModelIndex &index) const;
+	DomainEntry* getParentEntry(const QModelIndex &index) const;
+	DomainEntry* findDomain(const QString &domain) const;
+	QIcon getDomainIcon(const QString &domain) const;
+	int findDomainRow(const QString &domain) const;
+	int getInsertionRow(const QString &domain) const;
+	int getDomainsAmount() const;
+
+protected slots:
+	void loadIcons();
+
+private:
+	QList<DomainEntry*> m_domains;
+	QHash<QString, DomainEntry*> m_domainEntries;
+	mutable QHash<QString, QIcon> m_icons;
+	mutable QStringList m_pendingIcons;
+	mutable bool m_isLoadingIcons;
+};
+
+}
+
+#endif
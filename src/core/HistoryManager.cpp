@@ -22,9 +22,11 @@
 #include "SettingsManager.h"
 
 #include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QFile>
 #include <QtCore/QTextStream>
 #include <QtCore/QTimerEvent>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlField>
 #include <QtSql/QSqlQuery>
@@ -165,7 +167,7 @@ void HistoryManager::clearHistory(int period)
 		{
 			database.exec(QStringLiteral("DELETE FROM \"visits\" WHERE \"time\" >= %1;").arg(QDateTime::currentDateTime().toTime_t() - (period * 3600)));
 
-			m_instance->scheduleCleanup();
+			getInstance()->scheduleCleanup();
 		}
 		else
 		{
@@ -181,7 +183,7 @@ void HistoryManager::clearHistory(int period)
 		QFile::remove(path);
 	}
 
-	emit m_instance->cleared();
+	emit getInstance()->cleared();
 }
 
 void HistoryManager::optionChanged(const QString &option)
@@ -225,9 +227,19 @@ void HistoryManager::optionChanged(const QString &option)
 
 HistoryManager* HistoryManager::getInstance()
 {
+	if (!m_instance)
+	{
+		createInstance(QCoreApplication::instance());
+	}
+
 	return m_instance;
 }
 
+bool HistoryManager::isEnabled()
+{
+	return (getInstance() && m_isEnabled);
+}
+
 HistoryEntry HistoryManager::getEntry(const QSqlRecord &record)
 {
 	if (record.isEmpty())
@@ -254,7 +266,7 @@ HistoryEntry HistoryManager::getEntry(const QSqlRecord &record)
 
 HistoryEntry HistoryManager::getEntry(qint64 entry)
 {
-	if (!m_isEnabled)
+	if (!isEnabled())
 	{
 		return HistoryEntry();
 	}
@@ -276,7 +288,7 @@ QList<HistoryEntry> HistoryManager::getEntries(bool typed)
 {
 	QList<HistoryEntry> entries;
 
-	if (!m_isEnabled)
+	if (!isEnabled())
 	{
 		return entries;
 	}
@@ -293,6 +305,58 @@ QList<HistoryEntry> HistoryManager::getEntries(bool typed)
 	return entries;
 }
 
+QFuture<QStringList> HistoryManager::getTopHosts(int amount)
+{
+// query scans visits from whole month, so it is run in separate thread using its own connection
+	return QtConcurrent::run(readTopHosts, (isEnabled() ? SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.sqlite")) : QString()), amount);
+}
+
+QStringList HistoryManager::readTopHosts(const QString &path, int amount)
+{
+	QStringList hosts;
+
+	if (path.isEmpty())
+	{
+		return hosts;
+	}
+
+	const QString connection = QLatin1String("browsingHistoryTopHosts");
+
+	{
+		QSqlDatabase database = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connection);
+		database.setDatabaseName(path);
+
+		if (database.open())
+		{
+			const uint currentTime = QDateTime::currentDateTime().toTime_t();
+
+// frecency: visits from last month, typed ones count twice and those from last week are doubled again
+			QSqlQuery query(database);
+			query.prepare(QLatin1String("SELECT \"hosts\".\"host\", SUM((1 + \"visits\".\"typed\") * (CASE WHEN \"visits\".\"time\" >= ? THEN 2 ELSE 1 END)) AS \"score\" FROM \"visits\" LEFT JOIN \"locations\" ON \"visits\".\"location\" = \"locations\".\"id\" LEFT JOIN \"hosts\" ON \"locations\".\"host\" = \"hosts\".\"id\" WHERE \"visits\".\"time\" >= ? AND \"locations\".\"scheme\" IN('http', 'https') GROUP BY \"hosts\".\"host\" ORDER BY \"score\" DESC LIMIT ?;"));
+			query.bindValue(0, (currentTime - (7 * 86400)));
+			query.bindValue(1, (currentTime - (30 * 86400)));
+			query.bindValue(2, amount);
+			query.exec();
+
+			while (query.next())
+			{
+				const QString host = query.record().field(QLatin1String("host")).value().toString();
+
+				if (!host.isEmpty())
+				{
+					hosts.append(host);
+				}
+			}
+		}
+
+		database.close();
+	}
+
+	QSqlDatabase::removeDatabase(connection);
+
+	return hosts;
+}
+
 qint64 HistoryManager::getRecord(const QLatin1String &table, const QVariantHash &values, bool canCreate)
 {
 	const QStringList keys = values.keys();
@@ -374,7 +438,7 @@ qint64 HistoryManager::getIcon(const QIcon &icon, bool canCreate)
 
 qint64 HistoryManager::addEntry(const QUrl &url, const QString &title, const QIcon &icon, bool typed)
 {
-	if (!m_isEnabled || !url.isValid() || !SettingsManager::getValue(QLatin1String("History/RememberBrowsing"), url).toBool())
+	if (!isEnabled() || !url.isValid() || !SettingsManager::getValue(QLatin1String("History/RememberBrowsing"), url).toBool())
 	{
 		return -1;
 	}
@@ -402,12 +466,12 @@ qint64 HistoryManager::addEntry(const QUrl &url, const QString &title, const QIc
 
 bool HistoryManager::hasUrl(const QUrl &url)
 {
-	return (m_isEnabled && getLocation(url, false) >= 0);
+	return (isEnabled() && getLocation(url, false) >= 0);
 }
 
 bool HistoryManager::updateEntry(qint64 entry, const QUrl &url, const QString &title, const QIcon &icon)
 {
-	if (!m_isEnabled || !url.isValid())
+	if (!isEnabled() || !url.isValid())
 	{
 		return false;
 	}
@@ -441,7 +505,7 @@ bool HistoryManager::updateEntry(qint64 entry, const QUrl &url, const QString &t
 
 bool HistoryManager::removeEntry(qint64 entry)
 {
-	if (!m_isEnabled)
+	if (!isEnabled())
 	{
 		return false;
 	}
@@ -465,7 +529,7 @@ bool HistoryManager::removeEntry(qint64 entry)
 
 bool HistoryManager::removeEntries(const QList<qint64> &entries)
 {
-	if (!m_isEnabled)
+	if (!isEnabled())
 	{
 		return false;
 	}
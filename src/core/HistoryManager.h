@@ -22,6 +22,7 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QDateTime>
+#include <QtCore/QFuture>
 #include <QtCore/QUrl>
 #include <QtGui/QIcon>
 #include <QtSql/QSqlRecord>
@@ -52,6 +53,7 @@ public:
 	static HistoryManager* getInstance();
 	static HistoryEntry getEntry(qint64 entry);
 	static QList<HistoryEntry> getEntries(bool typed = false);
+	static QFuture<QStringList> getTopHosts(int amount);
 	static qint64 addEntry(const QUrl &url, const QString &title, const QIcon &icon, bool typed = false);
 	static bool hasUrl(const QUrl &url);
 	static bool updateEntry(qint64 entry, const QUrl &url, const QString &title, const QIcon &icon);
@@ -65,9 +67,11 @@ protected:
 	void scheduleCleanup();
 	void removeOldEntries(const QDateTime &date = QDateTime());
 	static HistoryEntry getEntry(const QSqlRecord &record);
+	static QStringList readTopHosts(const QString &path, int amount);
 	static qint64 getRecord(const QLatin1String &table, const QVariantHash &values, bool canCreate = true);
 	static qint64 getLocation(const QUrl &url, bool canCreate = true);
 	static qint64 getIcon(const QIcon &icon, bool canCreate = true);
+	static bool isEnabled();
 
 protected slots:
 	void optionChanged(const QString &option);
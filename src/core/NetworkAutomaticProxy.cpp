@@ -23,7 +23,7 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDate>
-#include <QtNetwork/QHostInfo>
+#include <QtCore/QMutexLocker>
 #include <QtNetwork/QNetworkInterface>
 
 namespace Otter
@@ -31,44 +31,147 @@ namespace Otter
 
 QStringList NetworkAutomaticProxy::m_months = QStringList() << QLatin1String("jan") << QLatin1String("feb") << QLatin1String("mar") << QLatin1String("apr") << QLatin1String("may") << QLatin1String("jun") << QLatin1String("jul") << QLatin1String("aug") << QLatin1String("sep") << QLatin1String("oct") << QLatin1String("nov") << QLatin1String("dec");
 QStringList NetworkAutomaticProxy::m_days = QStringList() << QLatin1String("mon") << QLatin1String("tue") << QLatin1String("wed") << QLatin1String("thu") << QLatin1String("fri") << QLatin1String("sat") << QLatin1String("sun");
-
-NetworkAutomaticProxy::NetworkAutomaticProxy()
+const qint64 NetworkAutomaticProxy::m_decisionTime = 300000;
+const qint64 NetworkAutomaticProxy::m_errorDecisionTime = 5000;
+const qint64 NetworkAutomaticProxy::m_hostTime = 60000;
+const qint64 NetworkAutomaticProxy::m_evaluationTimeout = 1000;
+const int NetworkAutomaticProxy::m_decisionsLimit = 1000;
+const int NetworkAutomaticProxy::m_hostsLimit = 500;
+
+NetworkAutomaticProxy::NetworkAutomaticProxy() : QObject(),
+	m_thread(new QThread()),
+	m_engine(new QScriptEngine(this))
 {
+	m_timer.start();
+
 	m_proxies.insert(QLatin1String("ERROR"), QList<QNetworkProxy>() << QNetworkProxy(QNetworkProxy::DefaultProxy));
 	m_proxies.insert(QLatin1String("DIRECT"), QList<QNetworkProxy>() << QNetworkProxy(QNetworkProxy::NoProxy));
 
-	m_engine.globalObject().setProperty(QLatin1String("alert"), m_engine.newFunction(alert));
-	m_engine.globalObject().setProperty(QLatin1String("shExpMatch"), m_engine.newFunction(shExpMatch));
-	m_engine.globalObject().setProperty(QLatin1String("dnsDomainIs"), m_engine.newFunction(dnsDomainIs));
-	m_engine.globalObject().setProperty(QLatin1String("isInNet"), m_engine.newFunction(isInNet));
-	m_engine.globalObject().setProperty(QLatin1String("myIpAddress"), m_engine.newFunction(myIpAddress));
-	m_engine.globalObject().setProperty(QLatin1String("dnsResolve"), m_engine.newFunction(dnsResolve));
-	m_engine.globalObject().setProperty(QLatin1String("isPlainHostName"), m_engine.newFunction(isPlainHostName));
-	m_engine.globalObject().setProperty(QLatin1String("isResolvable"), m_engine.newFunction(isResolvable));
-	m_engine.globalObject().setProperty(QLatin1String("localHostOrDomainIs"), m_engine.newFunction(localHostOrDomainIs));
-	m_engine.globalObject().setProperty(QLatin1String("dnsDomainLevels"), m_engine.newFunction(dnsDomainLevels));
-	m_engine.globalObject().setProperty(QLatin1String("weekdayRange"), m_engine.newFunction(weekdayRange));
-	m_engine.globalObject().setProperty(QLatin1String("dateRange"), m_engine.newFunction(dateRange));
-	m_engine.globalObject().setProperty(QLatin1String("timeRange"), m_engine.newFunction(timeRange));
+	m_engine->globalObject().setProperty(QLatin1String("alert"), m_engine->newFunction(alert));
+	m_engine->globalObject().setProperty(QLatin1String("shExpMatch"), m_engine->newFunction(shExpMatch));
+	m_engine->globalObject().setProperty(QLatin1String("dnsDomainIs"), m_engine->newFunction(dnsDomainIs));
+	m_engine->globalObject().setProperty(QLatin1String("isInNet"), m_engine->newFunction(isInNet));
+	m_engine->globalObject().setProperty(QLatin1String("myIpAddress"), m_engine->newFunction(myIpAddress));
+	m_engine->globalObject().setProperty(QLatin1String("dnsResolve"), m_engine->newFunction(dnsResolve));
+	m_engine->globalObject().setProperty(QLatin1String("isPlainHostName"), m_engine->newFunction(isPlainHostName));
+	m_engine->globalObject().setProperty(QLatin1String("isResolvable"), m_engine->newFunction(isResolvable));
+	m_engine->globalObject().setProperty(QLatin1String("localHostOrDomainIs"), m_engine->newFunction(localHostOrDomainIs));
+	m_engine->globalObject().setProperty(QLatin1String("dnsDomainLevels"), m_engine->newFunction(dnsDomainLevels));
+	m_engine->globalObject().setProperty(QLatin1String("weekdayRange"), m_engine->newFunction(weekdayRange));
+	m_engine->globalObject().setProperty(QLatin1String("dateRange"), m_engine->newFunction(dateRange));
+	m_engine->globalObject().setProperty(QLatin1String("timeRange"), m_engine->newFunction(timeRange));
+
+// script engine and helpers (including their DNS lookups) only run in the worker thread
+	moveToThread(m_thread);
+
+	m_thread->start();
+}
+
+NetworkAutomaticProxy::~NetworkAutomaticProxy()
+{
+	m_thread->quit();
+	m_thread->wait();
+
+	delete m_thread;
 }
 
 QList<QNetworkProxy> NetworkAutomaticProxy::getProxy(const QString &url, const QString &host)
 {
-	QScriptValueList arguments;
-	arguments << m_engine.toScriptValue(url) << m_engine.toScriptValue(host);
+	const QString key = QUrl(url).scheme() + QLatin1String("://") + host.toLower();
 
-	const QScriptValue result = m_findProxy.call(m_engine.globalObject(), arguments);
+	QMutexLocker locker(&m_mutex);
 
-	if (result.isError())
+	if (!m_decisions.contains(key) || m_decisions[key].expirationTime <= m_timer.elapsed())
+	{
+		if (QThread::currentThread() == thread())
+		{
+			locker.unlock();
+
+			evaluateDecision(url, host, key);
+
+			locker.relock();
+		}
+		else
+		{
+			if (!m_pendingDecisions.contains(key))
+			{
+				m_pendingDecisions.insert(key);
+
+				QMetaObject::invokeMethod(this, "evaluateDecision", Qt::QueuedConnection, Q_ARG(QString, url), Q_ARG(QString, host), Q_ARG(QString, key));
+			}
+
+// slow scripts or DNS lookups should not freeze requests, decision will be used by next request once it is ready
+			QElapsedTimer waitTimer;
+			waitTimer.start();
+
+			while (m_pendingDecisions.contains(key) && waitTimer.elapsed() < m_evaluationTimeout)
+			{
+				m_condition.wait(&m_mutex, (m_evaluationTimeout - waitTimer.elapsed()));
+			}
+		}
+	}
+
+	if (!m_decisions.contains(key))
+	{
+		emit messageReported(QCoreApplication::translate("main", "Proxy auto-config (PAC) did not return decision for %1 in time").arg(host), WarningMessageLevel);
+
+// going around configured proxy could leak request, so it has to fail instead, proxy without any capabilities is rejected by network access manager
+		QNetworkProxy proxy(QNetworkProxy::DefaultProxy);
+		proxy.setCapabilities(0);
+
+		return QList<QNetworkProxy>() << proxy;
+	}
+
+// decision being refreshed is still the one from script, so it is used until new one is ready
+	return m_proxies.value(m_decisions[key].configuration, m_proxies[QLatin1String("ERROR")]);
+}
+
+void NetworkAutomaticProxy::evaluateDecision(const QString &url, const QString &host, const QString &key)
+{
+	const QString configuration = evaluateScript(url, host);
+
+	QMutexLocker locker(&m_mutex);
+
+	if (m_decisions.count() >= m_decisionsLimit)
 	{
-		return m_proxies[QLatin1String("ERROR")];
+		const qint64 currentTime = m_timer.elapsed();
+		QHash<QString, ProxyDecision>::iterator iterator = m_decisions.begin();
+
+		while (iterator != m_decisions.end())
+		{
+			if (iterator.value().expirationTime <= currentTime)
+			{
+				iterator = m_decisions.erase(iterator);
+			}
+			else
+			{
+				++iterator;
+			}
+		}
+
+		if (m_decisions.count() >= m_decisionsLimit)
+		{
+			m_decisions.clear();
+		}
 	}
 
-	const QString configuration = result.toString().remove(QLatin1Char(' '));
+// failures are remembered only briefly, long enough to not evaluate and report broken script again for each request of the same page
+	ProxyDecision decision;
+	decision.configuration = ((configuration.isEmpty() || !parseConfiguration(configuration)) ? QLatin1String("ERROR") : configuration);
+	decision.expirationTime = (m_timer.elapsed() + ((decision.configuration == QLatin1String("ERROR")) ? m_errorDecisionTime : m_decisionTime));
+
+	m_decisions[key] = decision;
+
+	m_pendingDecisions.remove(key);
 
+	m_condition.wakeAll();
+}
+
+bool NetworkAutomaticProxy::parseConfiguration(const QString &configuration)
+{
 	if (!m_proxies.value(configuration).isEmpty())
 	{
-		return m_proxies[configuration];
+		return true;
 	}
 
 // proxy format: "PROXY host:port; PROXY host:port", "PROXY host:port; SOCKS host:port" etc.
@@ -102,21 +205,78 @@ QList<QNetworkProxy> NetworkAutomaticProxy::getProxy(const QString &url, const Q
 			continue;
 		}
 
-		Console::addMessage(QCoreApplication::translate("main", "Failed to parse entry of proxy auto-config (PAC):\n%1").arg(proxies.at(i)), NetworkMessageCategory, ErrorMessageLevel);
+		emit messageReported(QCoreApplication::translate("main", "Failed to parse entry of proxy auto-config (PAC):\n%1").arg(proxies.at(i)), ErrorMessageLevel);
 
-		return m_proxies[QLatin1String("ERROR")];
+		return false;
 	}
 
 	m_proxies.insert(configuration, proxiesForQuery);
 
-	return m_proxies[configuration];
+	return true;
+}
+
+QString NetworkAutomaticProxy::evaluateScript(const QString &url, const QString &host)
+{
+	if (!m_findProxy.isFunction())
+	{
+		return QString();
+	}
+
+	QScriptValueList arguments;
+	arguments << m_engine->toScriptValue(url) << m_engine->toScriptValue(host);
+
+	const QScriptValue result = m_findProxy.call(m_engine->globalObject(), arguments);
+
+	if (result.isError())
+	{
+		return QString();
+	}
+
+	return result.toString().remove(QLatin1Char(' '));
+}
+
+bool NetworkAutomaticProxy::evaluateSetup(const QString &script)
+{
+	m_findProxy = QScriptValue();
+
+	if (!m_engine->canEvaluate(script) || m_engine->evaluate(script).isError())
+	{
+		return false;
+	}
+
+	m_findProxy = m_engine->globalObject().property(QLatin1String("FindProxyForURL"));
+
+	return m_findProxy.isFunction();
+}
+
+void NetworkAutomaticProxy::hostLookedUp(const QHostInfo &information)
+{
+	const QString key = m_lookups.take(information.lookupId());
+
+	if (key.isEmpty())
+	{
+		return;
+	}
+
+	HostRecord record;
+	record.expirationTime = (m_timer.elapsed() + m_hostTime);
+
+	if (information.error() == QHostInfo::NoError)
+	{
+		record.addresses = information.addresses();
+	}
+
+	m_hosts[key] = record;
 }
 
 QScriptValue NetworkAutomaticProxy::alert(QScriptContext *context, QScriptEngine *engine)
 {
-	Q_UNUSED(engine);
+	NetworkAutomaticProxy *proxy = qobject_cast<NetworkAutomaticProxy*>(engine->parent());
 
-	Console::addMessage(context->argument(0).toString(), NetworkMessageCategory, WarningMessageLevel);
+	if (proxy)
+	{
+		emit proxy->messageReported(context->argument(0).toString(), WarningMessageLevel);
+	}
 
 	return engine->undefinedValue();
 }
@@ -148,14 +308,24 @@ QScriptValue NetworkAutomaticProxy::shExpMatch(QScriptContext *context, QScriptE
 
 QScriptValue NetworkAutomaticProxy::isInNet(QScriptContext *context, QScriptEngine *engine)
 {
-	Q_UNUSED(engine);
-
 	if (context->argumentCount() != 3)
 	{
 		return context->throwError(QLatin1String("Function isInNet takes three arguments!"));
 	}
 
-	const QHostAddress address(context->argument(0).toString());
+	const QList<QHostAddress> addresses = resolveHost(engine, context->argument(0).toString());
+	QHostAddress address;
+
+	for (int i = 0; i < addresses.count(); ++i)
+	{
+		if (addresses.at(i).protocol() == QAbstractSocket::IPv4Protocol)
+		{
+			address = addresses.at(i);
+
+			break;
+		}
+	}
+
 	const QHostAddress netaddress(context->argument(1).toString());
 	const QHostAddress netmask(context->argument(2).toString());
 
@@ -191,11 +361,11 @@ QScriptValue NetworkAutomaticProxy::dnsResolve(QScriptContext *context, QScriptE
 		return context->throwError(QLatin1String("Function dnsResolve takes only one argument!"));
 	}
 
-	const QHostInfo host = QHostInfo::fromName(context->argument(0).toString());
+	const QList<QHostAddress> addresses = resolveHost(engine, context->argument(0).toString());
 
-	if (host.error() == QHostInfo::NoError)
+	if (!addresses.isEmpty())
 	{
-		return host.addresses().first().toString();
+		return addresses.first().toString();
 	}
 
 	return engine->undefinedValue();
@@ -215,14 +385,12 @@ QScriptValue NetworkAutomaticProxy::isPlainHostName(QScriptContext *context, QSc
 
 QScriptValue NetworkAutomaticProxy::isResolvable(QScriptContext *context, QScriptEngine *engine)
 {
-	Q_UNUSED(engine);
-
 	if (context->argumentCount() != 1)
 	{
 		return context->throwError(QLatin1String("Function isResolvable takes only one argument!"));
 	}
 
-	return (QHostInfo::fromName(context->argument(0).toString()).error() == QHostInfo::NoError);
+	return !resolveHost(engine, context->argument(0).toString()).isEmpty();
 }
 
 QScriptValue NetworkAutomaticProxy::localHostOrDomainIs(QScriptContext *context, QScriptEngine *engine)
@@ -447,16 +615,77 @@ QDateTime NetworkAutomaticProxy::getDateTime(QScriptContext *context, int *numbe
 	return QDateTime::currentDateTime();
 }
 
+QList<QHostAddress> NetworkAutomaticProxy::resolveHost(QScriptEngine *engine, const QString &host)
+{
+	const QHostAddress hostAddress(host);
+
+	if (!hostAddress.isNull())
+	{
+		return QList<QHostAddress>() << hostAddress;
+	}
+
+	NetworkAutomaticProxy *proxy = qobject_cast<NetworkAutomaticProxy*>(engine->parent());
+
+	if (!proxy)
+	{
+		return QHostInfo::fromName(host).addresses();
+	}
+
+	const QString key = host.toLower();
+	const qint64 currentTime = proxy->m_timer.elapsed();
+
+	if (proxy->m_hosts.contains(key))
+	{
+		HostRecord &record = proxy->m_hosts[key];
+
+// serve stale addresses while refreshing them in background instead of blocking the script again
+		if (record.expirationTime <= currentTime && !record.isPending)
+		{
+			record.isPending = true;
+
+			proxy->m_lookups[QHostInfo::lookupHost(host, proxy, SLOT(hostLookedUp(QHostInfo)))] = key;
+		}
+
+		return record.addresses;
+	}
+
+	if (proxy->m_hosts.count() >= m_hostsLimit)
+	{
+		proxy->m_hosts.clear();
+	}
+
+	const QHostInfo information = QHostInfo::fromName(host);
+	HostRecord record;
+	record.expirationTime = (currentTime + m_hostTime);
+
+	if (information.error() == QHostInfo::NoError)
+	{
+		record.addresses = information.addresses();
+	}
+
+	proxy->m_hosts[key] = record;
+
+	return record.addresses;
+}
+
 bool NetworkAutomaticProxy::setup(const QString &script)
 {
-	if (!m_engine.canEvaluate(script) || m_engine.evaluate(script).isError())
+	bool result = false;
+
+	if (QThread::currentThread() == thread())
 	{
-		return false;
+		result = evaluateSetup(script);
+	}
+	else
+	{
+		QMetaObject::invokeMethod(this, "evaluateSetup", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, result), Q_ARG(QString, script));
 	}
 
-	m_findProxy = m_engine.globalObject().property(QLatin1String("FindProxyForURL"));
+	QMutexLocker locker(&m_mutex);
 
-	return m_findProxy.isFunction();
+	m_decisions.clear();
+
+	return result;
 }
 
 bool NetworkAutomaticProxy::compareRange(const QVariant &valueOne, const QVariant &valueTwo, const QVariant &actualValue)
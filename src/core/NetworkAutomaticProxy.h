@@ -21,6 +21,12 @@
 #ifndef OTTER_NETWORKAUTOMATICPROXY_H
 #define OTTER_NETWORKAUTOMATICPROXY_H
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <QtNetwork/QHostInfo>
 #include <QtNetwork/QNetworkProxy>
 #include <QtScript/QScriptEngine>
 #include <QtScript/QScriptValue>
@@ -28,10 +34,30 @@
 namespace Otter
 {
 
-class NetworkAutomaticProxy
+struct ProxyDecision
 {
+	QString configuration;
+	qint64 expirationTime;
+
+	ProxyDecision() : expirationTime(0) {}
+};
+
+struct HostRecord
+{
+	QList<QHostAddress> addresses;
+	qint64 expirationTime;
+	bool isPending;
+
+	HostRecord() : expirationTime(0), isPending(false) {}
+};
+
+class NetworkAutomaticProxy : public QObject
+{
+	Q_OBJECT
+
 public:
 	explicit NetworkAutomaticProxy();
+	~NetworkAutomaticProxy();
 
 	QList<QNetworkProxy> getProxy(const QString &url, const QString &host);
 	bool setup(const QString &script);
@@ -51,15 +77,40 @@ protected:
 	static QScriptValue dateRange(QScriptContext *context, QScriptEngine *engine);
 	static QScriptValue timeRange(QScriptContext *context, QScriptEngine *engine);
 	static QDateTime getDateTime(QScriptContext *context, int *numberOfArguments = NULL);
+	static QList<QHostAddress> resolveHost(QScriptEngine *engine, const QString &host);
 	static bool compareRange(const QVariant &valueOne, const QVariant &valueTwo, const QVariant &actualValue);
+	QString evaluateScript(const QString &url, const QString &host);
+	bool parseConfiguration(const QString &configuration);
+
+protected slots:
+	void evaluateDecision(const QString &url, const QString &host, const QString &key);
+	bool evaluateSetup(const QString &script);
+	void hostLookedUp(const QHostInfo &information);
 
 private:
-	QScriptEngine m_engine;
+	QThread *m_thread;
+	QScriptEngine *m_engine;
 	QScriptValue m_findProxy;
+	QElapsedTimer m_timer;
+	QMutex m_mutex;
+	QWaitCondition m_condition;
 	QHash<QString, QList<QNetworkProxy> > m_proxies;
+	QHash<QString, ProxyDecision> m_decisions;
+	QSet<QString> m_pendingDecisions;
+	QHash<QString, HostRecord> m_hosts;
+	QHash<int, QString> m_lookups;
 
 	static QStringList m_months;
 	static QStringList m_days;
+	static const qint64 m_decisionTime;
+	static const qint64 m_errorDecisionTime;
+	static const qint64 m_hostTime;
+	static const qint64 m_evaluationTimeout;
+	static const int m_decisionsLimit;
+	static const int m_hostsLimit;
+
+signals:
+	void messageReported(const QString &message, int level);
 };
 
 }
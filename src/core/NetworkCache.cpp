@@ -21,27 +21,66 @@
 #include "SessionsManager.h"
 #include "SettingsManager.h"
 
-#include <QtCore/QDateTime>
+#include <QtCore/QBuffer>
+#include <QtCore/QDataStream>
 #include <QtCore/QDir>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTimerEvent>
+#include <QtConcurrent/QtConcurrentRun>
 
 namespace Otter
 {
 
-NetworkCache::NetworkCache(QObject *parent) : QNetworkDiskCache(parent)
+NetworkCache::NetworkCache(QObject *parent) : QNetworkDiskCache(parent),
+	m_indexWatcher(NULL),
+	m_memoryHits(0),
+	m_memoryMisses(0),
+	m_entriesSize(0),
+	m_saveTimer(0),
+	m_clearPeriod(0),
+	m_isIndexValid(false)
 {
 	const QString cachePath = SessionsManager::getCachePath();
 
+	m_memoryEntries.setMaxCost(SettingsManager::getValue(QLatin1String("Cache/MemoryCacheLimit")).toInt() * 1024);
+
 	if (!cachePath.isEmpty())
 	{
 		QDir().mkpath(cachePath);
 
 		setCacheDirectory(cachePath);
 		setMaximumCacheSize(SettingsManager::getValue(QLatin1String("Cache/DiskCacheLimit")).toInt() * 1024);
+
+		loadIndex();
 	}
 
 	connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), this, SLOT(optionChanged(QString,QVariant)));
 }
 
+NetworkCache::~NetworkCache()
+{
+	if (m_saveTimer != 0)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		saveIndex();
+	}
+}
+
+void NetworkCache::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_saveTimer)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		saveIndex();
+	}
+}
+
 void NetworkCache::clearCache(int period)
 {
 	if (period <= 0)
@@ -53,64 +92,365 @@ void NetworkCache::clearCache(int period)
 		return;
 	}
 
-	const QDir cacheMainDirectory(cacheDirectory());
-	const QStringList directories = cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+// age of entries is known only from index, so removal waits until it is built in background
+	if (!m_isIndexValid)
+	{
+		m_clearPeriod = ((m_clearPeriod > 0) ? qMin(m_clearPeriod, period) : period);
 
-	for (int i = 0; i < directories.count(); ++i)
+		loadEntries();
+
+		return;
+	}
+
+	const QDateTime currentDateTime = QDateTime::currentDateTime();
+	QList<QUrl> entries;
+	QHash<QUrl, CacheEntry>::const_iterator iterator;
+
+	for (iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
 	{
-		const QDir cacheSubDirectory(cacheMainDirectory.absoluteFilePath(directories.at(i)));
-		const QStringList subDirectories = cacheSubDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+		if (iterator.value().lastModified.isValid() && iterator.value().lastModified.secsTo(currentDateTime) > (period * 3600))
+		{
+			entries.append(iterator.key());
+		}
+	}
 
-		for (int j = 0; j < subDirectories.count(); ++j)
+	for (int i = 0; i < entries.count(); ++i)
+	{
+		remove(entries.at(i));
+	}
+}
+
+void NetworkCache::clear()
+{
+	m_entries.clear();
+	m_memoryEntries.clear();
+	m_insertedEntries.clear();
+	m_removedEntries.clear();
+
+	m_entriesSize = 0;
+	m_clearPeriod = 0;
+
+	QNetworkDiskCache::clear();
+
+	scheduleSave();
+
+	if (m_indexWatcher)
+	{
+		m_indexWatcher->disconnect(this);
+		m_indexWatcher->deleteLater();
+		m_indexWatcher = NULL;
+	}
+
+	if (!m_isIndexValid)
+	{
+		m_isIndexValid = true;
+
+		emit entriesLoaded();
+	}
+}
+
+void NetworkCache::scheduleSave()
+{
+	if (m_saveTimer == 0)
+	{
+		m_saveTimer = startTimer(1000);
+	}
+}
+
+void NetworkCache::loadIndex()
+{
+	QFile file(getIndexPath());
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return;
+	}
+
+	QDataStream stream(&file);
+	quint32 version;
+	quint32 amount;
+
+	stream >> version >> amount;
+
+	if (version != 1)
+	{
+		return;
+	}
+
+	for (quint32 i = 0; i < amount; ++i)
+	{
+		CacheEntry entry;
+
+		stream >> entry.url >> entry.path >> entry.type >> entry.lastModified >> entry.expirationDate >> entry.size;
+
+		if (stream.status() != QDataStream::Ok)
 		{
-			const QDir cacheFilesDirectory(cacheSubDirectory.absoluteFilePath(subDirectories.at(j)));
-			const QStringList files = cacheFilesDirectory.entryList(QDir::Files);
+			m_entries.clear();
 
-			for (int k = 0; k < files.count(); ++k)
-			{
-				const QNetworkCacheMetaData metaData = fileMetaData(cacheFilesDirectory.absoluteFilePath(files.at(k)));
+			m_entriesSize = 0;
 
-				if (metaData.isValid() && metaData.lastModified().isValid() && metaData.lastModified().secsTo(QDateTime::currentDateTime()) > (period * 3600))
-				{
-					remove(metaData.url());
-				}
+			return;
+		}
+
+		m_entries[entry.url] = entry;
+
+		m_entriesSize += entry.size;
+	}
+
+	m_isIndexValid = true;
+}
+
+void NetworkCache::loadEntries()
+{
+	if (m_isIndexValid)
+	{
+		emit entriesLoaded();
+
+		return;
+	}
+
+	scanEntries();
+}
+
+void NetworkCache::scanEntries()
+{
+	if (m_indexWatcher || cacheDirectory().isEmpty())
+	{
+		return;
+	}
+
+	m_indexWatcher = new QFutureWatcher<QList<CacheEntry> >(this);
+	m_indexWatcher->setFuture(QtConcurrent::run(&NetworkCache::readEntries, cacheDirectory()));
+
+	connect(m_indexWatcher, SIGNAL(finished()), this, SLOT(indexRebuilt()));
+}
+
+void NetworkCache::indexRebuilt()
+{
+	QList<CacheEntry> entries = m_indexWatcher->result();
+
+	m_indexWatcher->deleteLater();
+	m_indexWatcher = NULL;
+
+	for (int i = (entries.count() - 1); i >= 0; --i)
+	{
+		if (m_removedEntries.contains(entries.at(i).url))
+		{
+			entries.removeAt(i);
+		}
+	}
+
+	const bool wasIndexValid = m_isIndexValid;
+
+	mergeEntries(entries);
+
+	m_insertedEntries.clear();
+	m_removedEntries.clear();
+
+	if (m_clearPeriod > 0)
+	{
+		const int period = m_clearPeriod;
+
+		m_clearPeriod = 0;
+
+		clearCache(period);
+	}
+
+	if (!wasIndexValid)
+	{
+		emit entriesLoaded();
+	}
+}
+
+void NetworkCache::mergeEntries(const QList<CacheEntry> &entries)
+{
+	QHash<QUrl, CacheEntry> scannedEntries;
+
+	for (int i = 0; i < entries.count(); ++i)
+	{
+		scannedEntries[entries.at(i).url] = entries.at(i);
+	}
+
+// scan reflects state of disk, so entries missing there are stale unless they were inserted while it was running
+	if (m_isIndexValid)
+	{
+		QList<QUrl> staleEntries;
+		QHash<QUrl, CacheEntry>::const_iterator iterator;
+
+		for (iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+		{
+			if (!scannedEntries.contains(iterator.key()) && !m_insertedEntries.contains(iterator.key()))
+			{
+				staleEntries.append(iterator.key());
 			}
 		}
+
+		for (int i = 0; i < staleEntries.count(); ++i)
+		{
+			dropEntry(staleEntries.at(i));
+		}
 	}
+
+	QHash<QUrl, CacheEntry>::const_iterator iterator;
+
+	for (iterator = scannedEntries.constBegin(); iterator != scannedEntries.constEnd(); ++iterator)
+	{
+		if (m_insertedEntries.contains(iterator.key()))
+		{
+			continue;
+		}
+
+		const bool isNew = !m_entries.contains(iterator.key());
+
+		m_entriesSize += (iterator.value().size - m_entries.value(iterator.key()).size);
+		m_entries[iterator.key()] = iterator.value();
+
+		if (isNew && m_isIndexValid)
+		{
+			emit entryAdded(iterator.value());
+		}
+	}
+
+	m_isIndexValid = true;
+
+	scheduleSave();
+}
+
+void NetworkCache::dropEntry(const QUrl &url)
+{
+	m_entriesSize -= m_entries.take(url).size;
+
+	scheduleSave();
+
+	emit entryRemoved(url);
+}
+
+void NetworkCache::saveIndex()
+{
+	if (!m_isIndexValid || cacheDirectory().isEmpty())
+	{
+		return;
+	}
+
+	QSaveFile file(getIndexPath());
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream << quint32(1) << quint32(m_entries.count());
+
+	QHash<QUrl, CacheEntry>::const_iterator iterator;
+
+	for (iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+	{
+		stream << iterator.value().url << iterator.value().path << iterator.value().type << iterator.value().lastModified << iterator.value().expirationDate << iterator.value().size;
+	}
+
+	file.commit();
 }
 
 void NetworkCache::insert(QIODevice *device)
 {
+	if (!m_devices.contains(device))
+	{
+		QNetworkDiskCache::insert(device);
+
+		return;
+	}
+
+	const QNetworkCacheMetaData metaData = m_devices.take(device);
+	QBuffer *buffer = qobject_cast<QBuffer*>(device);
+	CacheEntry entry;
+	entry.size = device->size();
+
+	updateEntry(entry, metaData);
+
+	if (buffer && buffer->size() <= getMemoryObjectLimit())
+	{
+		insertMemoryEntry(metaData, buffer->data(), true);
+	}
+	else
+	{
+		m_memoryEntries.remove(entry.url);
+	}
+
 	QNetworkDiskCache::insert(device);
 
-	if (m_devices.contains(device))
+	if (m_indexWatcher)
+	{
+		m_insertedEntries.insert(entry.url);
+		m_removedEntries.remove(entry.url);
+	}
+
+	m_entriesSize += (entry.size - m_entries.value(entry.url).size);
+	m_entries[entry.url] = entry;
+
+	scheduleSave();
+
+	emit entryAdded(entry);
+}
+
+void NetworkCache::updateMetaData(const QNetworkCacheMetaData &metaData)
+{
+	QNetworkDiskCache::updateMetaData(metaData);
+
+	if (m_memoryEntries.contains(metaData.url()))
 	{
-		emit entryAdded(m_devices[device]);
+		m_memoryEntries.object(metaData.url())->metaData = metaData;
+	}
 
-		m_devices.remove(device);
+	if (m_entries.contains(metaData.url()))
+	{
+		updateEntry(m_entries[metaData.url()], metaData);
+		scheduleSave();
 	}
 }
 
-QIODevice* NetworkCache::prepare(const QNetworkCacheMetaData &metaData)
+void NetworkCache::insertMemoryEntry(const QNetworkCacheMetaData &metaData, const QByteArray &data, bool hasData)
 {
-	QIODevice *device = QNetworkDiskCache::prepare(metaData);
+	const QNetworkCacheMetaData::RawHeaderList headers = metaData.rawHeaders();
+	int cost = (data.size() + metaData.url().toEncoded().size());
 
-	if (device)
+	for (int i = 0; i < headers.count(); ++i)
 	{
-		m_devices[device] = metaData.url();
+		cost += (headers.at(i).first.size() + headers.at(i).second.size());
 	}
 
-	return device;
+	MemoryEntry *entry = new MemoryEntry();
+	entry->metaData = metaData;
+	entry->data = data;
+	entry->hasData = hasData;
+
+	m_memoryEntries.insert(metaData.url(), entry, qMax(1, cost));
 }
 
-QString NetworkCache::getPathForUrl(const QUrl &url)
+void NetworkCache::updateEntry(CacheEntry &entry, const QNetworkCacheMetaData &metaData)
 {
-	if (!url.isValid() || !metaData(url).isValid())
+	entry.url = metaData.url();
+	entry.lastModified = metaData.lastModified();
+	entry.expirationDate = metaData.expirationDate();
+
+	const QList<QNetworkCacheMetaData::RawHeader> headers = metaData.rawHeaders();
+
+	for (int i = 0; i < headers.count(); ++i)
 	{
-		return QString();
+		if (headers.at(i).first.toLower() == QByteArray("content-type"))
+		{
+			entry.type = QString(headers.at(i).second).section(QLatin1Char(';'), 0, 0).trimmed();
+
+			break;
+		}
 	}
+}
 
-	const QDir cacheMainDirectory(cacheDirectory());
+QList<CacheEntry> NetworkCache::readEntries(const QString &path)
+{
+	QNetworkDiskCache cache;
+	QList<CacheEntry> entries;
+	const QDir cacheMainDirectory(path);
 	const QStringList directories = cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
 
 	for (int i = 0; i < directories.count(); ++i)
@@ -121,27 +461,52 @@ QString NetworkCache::getPathForUrl(const QUrl &url)
 		for (int j = 0; j < subDirectories.count(); ++j)
 		{
 			const QDir cacheFilesDirectory(cacheSubDirectory.absoluteFilePath(subDirectories.at(j)));
-			const QStringList files = cacheFilesDirectory.entryList(QDir::Files);
+			const QFileInfoList files = cacheFilesDirectory.entryInfoList(QDir::Files);
 
 			for (int k = 0; k < files.count(); ++k)
 			{
-				const QString cacheFilePath = cacheFilesDirectory.absoluteFilePath(files.at(k));
-				const QNetworkCacheMetaData metaData = fileMetaData(cacheFilePath);
+				const QNetworkCacheMetaData metaData = cache.fileMetaData(files.at(k).absoluteFilePath());
 
-				if (metaData.isValid() && url == metaData.url())
+				if (metaData.isValid() && metaData.url().isValid())
 				{
-					return cacheFilePath;
+					CacheEntry entry;
+					entry.path = files.at(k).absoluteFilePath();
+					entry.size = files.at(k).size();
+
+					updateEntry(entry, metaData);
+
+					entries.append(entry);
 				}
 			}
 		}
 	}
 
-	return QString();
+	return entries;
 }
 
-QList<QUrl> NetworkCache::getEntries() const
+QIODevice* NetworkCache::prepare(const QNetworkCacheMetaData &metaData)
 {
-	QList<QUrl> entries;
+	QIODevice *device = QNetworkDiskCache::prepare(metaData);
+
+	if (device)
+	{
+// response is going to be fetched from network, count it as miss here since metaData() is called for lookups that do not end up as requests too
+		++m_memoryMisses;
+
+		m_devices[device] = metaData;
+	}
+
+	return device;
+}
+
+QString NetworkCache::getIndexPath() const
+{
+	return QDir(cacheDirectory()).absoluteFilePath(QLatin1String("index.dat"));
+}
+
+QString NetworkCache::findCacheFileName(const QUrl &url)
+{
+	QString path;
 
 	const QDir cacheMainDirectory(cacheDirectory());
 	const QStringList directories = cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
@@ -158,24 +523,232 @@ QList<QUrl> NetworkCache::getEntries() const
 
 			for (int k = 0; k < files.count(); ++k)
 			{
-				const QNetworkCacheMetaData metaData = fileMetaData(cacheFilesDirectory.absoluteFilePath(files.at(k)));
+				const QString cacheFilePath = cacheFilesDirectory.absoluteFilePath(files.at(k));
+				const QNetworkCacheMetaData metaData = fileMetaData(cacheFilePath);
+
+				if (!metaData.isValid())
+				{
+					continue;
+				}
 
-				if (metaData.url().isValid())
+// location of files is private to QNetworkDiskCache, so paths of all entries seen by this scan are remembered
+				if (m_entries.contains(metaData.url()))
 				{
-					entries.append(metaData.url());
+					m_entries[metaData.url()].path = cacheFilePath;
+				}
+
+				if (url == metaData.url())
+				{
+					path = cacheFilePath;
 				}
 			}
 		}
 	}
 
-	return entries;
+	scheduleSave();
+
+	return path;
+}
+
+QIODevice* NetworkCache::data(const QUrl &url)
+{
+	return getData(url, true);
+}
+
+QIODevice* NetworkCache::getData(const QUrl &url, bool isRequest)
+{
+	MemoryEntry *entry = m_memoryEntries.object(url);
+
+	if (entry && entry->hasData)
+	{
+		if (isRequest)
+		{
+			++m_memoryHits;
+		}
+
+		QBuffer *buffer = new QBuffer();
+		buffer->setData(entry->data);
+		buffer->open(QIODevice::ReadOnly);
+
+		return buffer;
+	}
+
+	if (isRequest)
+	{
+		++m_memoryMisses;
+	}
+
+	QIODevice *device = QNetworkDiskCache::data(url);
+
+	if (!device || device->size() > getMemoryObjectLimit())
+	{
+		return device;
+	}
+
+	const QByteArray data = device->readAll();
+	const QNetworkCacheMetaData metaData = (entry ? entry->metaData : QNetworkDiskCache::metaData(url));
+
+	delete device;
+
+	if (metaData.isValid())
+	{
+		insertMemoryEntry(metaData, data, true);
+	}
+
+	QBuffer *buffer = new QBuffer();
+	buffer->setData(data);
+	buffer->open(QIODevice::ReadOnly);
+
+	return buffer;
+}
+
+QNetworkCacheMetaData NetworkCache::metaData(const QUrl &url)
+{
+	const MemoryEntry *entry = m_memoryEntries.object(url);
+
+	if (entry)
+	{
+		return entry->metaData;
+	}
+
+	const QNetworkCacheMetaData metaData = QNetworkDiskCache::metaData(url);
+
+	if (metaData.isValid() && m_memoryEntries.maxCost() > 0)
+	{
+		insertMemoryEntry(metaData, QByteArray(), false);
+	}
+
+	return metaData;
+}
+
+QString NetworkCache::getPathForUrl(const QUrl &url)
+{
+	if (!url.isValid())
+	{
+		return QString();
+	}
+
+	if (!m_isIndexValid)
+	{
+		loadEntries();
+	}
+
+	if (!m_entries.contains(url))
+	{
+		return QString();
+	}
+
+	const QString path = m_entries[url].path;
+
+	if (!path.isEmpty() && QFile::exists(path))
+	{
+		return path;
+	}
+
+	if (findCacheFileName(url).isEmpty())
+	{
+		dropEntry(url);
+
+		return QString();
+	}
+
+	return m_entries[url].path;
+}
+
+CacheEntry NetworkCache::getEntry(const QUrl &url)
+{
+	if (!m_isIndexValid)
+	{
+		loadEntries();
+	}
+
+	if (!m_entries.contains(url))
+	{
+		return CacheEntry();
+	}
+
+	const CacheEntry entry = m_entries.value(url);
+
+// index is saved with delay, so after crash it can still list files which are already gone
+	if (!entry.path.isEmpty() && !QFile::exists(entry.path))
+	{
+		dropEntry(url);
+
+		return CacheEntry();
+	}
+
+	return entry;
+}
+
+QList<CacheEntry> NetworkCache::getEntries()
+{
+	if (!m_isIndexValid)
+	{
+		loadEntries();
+	}
+
+	return m_entries.values();
+}
+
+qint64 NetworkCache::getMemoryCacheHits() const
+{
+	return m_memoryHits;
+}
+
+qint64 NetworkCache::getMemoryCacheMisses() const
+{
+	return m_memoryMisses;
+}
+
+qint64 NetworkCache::getMemoryCacheSize() const
+{
+	return m_memoryEntries.totalCost();
+}
+
+qint64 NetworkCache::getMemoryObjectLimit() const
+{
+	return (m_memoryEntries.maxCost() / 8);
+}
+
+bool NetworkCache::isLoaded() const
+{
+	return m_isIndexValid;
+}
+
+qint64 NetworkCache::expire()
+{
+	const qint64 size = QNetworkDiskCache::expire();
+
+// files are removed only once cache grows above its limit, index is then reconciled with disk in background
+	if (m_isIndexValid && m_entriesSize > maximumCacheSize())
+	{
+		scanEntries();
+	}
+
+	return size;
 }
 
 bool NetworkCache::remove(const QUrl &url)
 {
 	const bool result = QNetworkDiskCache::remove(url);
 
-	if (result)
+	m_memoryEntries.remove(url);
+	const bool wasIndexed = m_entries.contains(url);
+
+	if (m_indexWatcher)
+	{
+		m_insertedEntries.remove(url);
+		m_removedEntries.insert(url);
+	}
+
+	if (wasIndexed)
+	{
+		m_entriesSize -= m_entries.take(url).size;
+
+		scheduleSave();
+	}
+
+	if (result || wasIndexed)
 	{
 		emit entryRemoved(url);
 	}
@@ -189,6 +762,10 @@ void NetworkCache::optionChanged(const QString &option, const QVariant &value)
 	{
 		setMaximumCacheSize(value.toInt() * 1024);
 	}
+	else if (option == QLatin1String("Cache/MemoryCacheLimit"))
+	{
+		m_memoryEntries.setMaxCost(value.toInt() * 1024);
+	}
 }
 
 }
@@ -20,35 +20,103 @@
 #ifndef OTTER_NETWORKCACHE_H
 #define OTTER_NETWORKCACHE_H
 
+#include <QtCore/QCache>
+#include <QtCore/QDateTime>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QSet>
 #include <QtNetwork/QNetworkDiskCache>
 
 namespace Otter
 {
 
+struct CacheEntry
+{
+	QUrl url;
+	QString path;
+	QString type;
+	QDateTime lastModified;
+	QDateTime expirationDate;
+	qint64 size;
+
+	CacheEntry() : size(0) {}
+};
+
 class NetworkCache : public QNetworkDiskCache
 {
 	Q_OBJECT
 
 public:
 	explicit NetworkCache(QObject *parent = NULL);
+	~NetworkCache();
 
 	void clearCache(int period = 0);
+	void loadEntries();
 	void insert(QIODevice *device);
+	void updateMetaData(const QNetworkCacheMetaData &metaData);
 	QIODevice* prepare(const QNetworkCacheMetaData &metaData);
+	QIODevice* data(const QUrl &url);
+	QIODevice* getData(const QUrl &url, bool isRequest = false);
+	QNetworkCacheMetaData metaData(const QUrl &url);
 	QString getPathForUrl(const QUrl &url);
-	QList<QUrl> getEntries() const;
+	CacheEntry getEntry(const QUrl &url);
+	QList<CacheEntry> getEntries();
+	qint64 getMemoryCacheHits() const;
+	qint64 getMemoryCacheMisses() const;
+	qint64 getMemoryCacheSize() const;
 	bool remove(const QUrl &url);
+	bool isLoaded() const;
+
+public slots:
+	void clear();
+
+protected:
+	struct MemoryEntry
+	{
+		QNetworkCacheMetaData metaData;
+		QByteArray data;
+		bool hasData;
+
+		MemoryEntry() : hasData(false) {}
+	};
+
+	void timerEvent(QTimerEvent *event);
+	void scheduleSave();
+	void loadIndex();
+	void scanEntries();
+	void saveIndex();
+	void mergeEntries(const QList<CacheEntry> &entries);
+	void dropEntry(const QUrl &url);
+	QString getIndexPath() const;
+	QString findCacheFileName(const QUrl &url);
+	qint64 expire();
+	qint64 getMemoryObjectLimit() const;
+	void insertMemoryEntry(const QNetworkCacheMetaData &metaData, const QByteArray &data, bool hasData);
+	static void updateEntry(CacheEntry &entry, const QNetworkCacheMetaData &metaData);
+	static QList<CacheEntry> readEntries(const QString &path);
 
 protected slots:
 	void optionChanged(const QString &option, const QVariant &value);
+	void indexRebuilt();
 
 private:
-	QHash<QIODevice*, QUrl> m_devices;
+	QHash<QIODevice*, QNetworkCacheMetaData> m_devices;
+	QHash<QUrl, CacheEntry> m_entries;
+	QSet<QUrl> m_insertedEntries;
+	QSet<QUrl> m_removedEntries;
+	QFutureWatcher<QList<CacheEntry> > *m_indexWatcher;
+	QCache<QUrl, MemoryEntry> m_memoryEntries;
+	qint64 m_memoryHits;
+	qint64 m_memoryMisses;
+	qint64 m_entriesSize;
+	int m_saveTimer;
+	int m_clearPeriod;
+	bool m_isIndexValid;
 
 signals:
 	void cleared();
-	void entryAdded(QUrl url);
+	void entryAdded(CacheEntry entry);
 	void entryRemoved(QUrl url);
+	void entriesLoaded();
 };
 
 }
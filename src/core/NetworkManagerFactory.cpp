@@ -25,6 +25,7 @@
 #include "NetworkCache.h"
 #include "NetworkManager.h"
 #include "NetworkProxyFactory.h"
+#include "NetworkTransport.h"
 #include "SessionsManager.h"
 #include "SettingsManager.h"
 #include "WebBackend.h"
@@ -40,6 +41,8 @@ namespace Otter
 NetworkManagerFactory* NetworkManagerFactory::m_instance = NULL;
 CookieJar* NetworkManagerFactory::m_cookieJar = NULL;
 NetworkCache* NetworkManagerFactory::m_cache = NULL;
+NetworkTransport* NetworkManagerFactory::m_transport = NULL;
+NetworkTransport* NetworkManagerFactory::m_privateTransport = NULL;
 QString NetworkManagerFactory::m_acceptLanguage;
 QStringList NetworkManagerFactory::m_userAgentsOrder;
 QMap<QString, UserAgentInformation> NetworkManagerFactory::m_userAgents;
@@ -224,6 +227,26 @@ NetworkCache* NetworkManagerFactory::getCache()
 	return m_cache;
 }
 
+NetworkTransport* NetworkManagerFactory::getTransport(bool isPrivate)
+{
+	if (isPrivate)
+	{
+		if (!m_privateTransport)
+		{
+			m_privateTransport = new NetworkTransport(true, QCoreApplication::instance());
+		}
+
+		return m_privateTransport;
+	}
+
+	if (!m_transport)
+	{
+		m_transport = new NetworkTransport(false, QCoreApplication::instance());
+	}
+
+	return m_transport;
+}
+
 QString NetworkManagerFactory::getAcceptLanguage()
 {
 	return m_acceptLanguage;
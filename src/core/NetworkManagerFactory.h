@@ -40,6 +40,7 @@ class ContentsWidget;
 class CookieJar;
 class NetworkCache;
 class NetworkManager;
+class NetworkTransport;
 
 class NetworkManagerFactory : public QObject
 {
@@ -62,6 +63,7 @@ public:
 	static NetworkManagerFactory* getInstance();
 	static CookieJar* getCookieJar();
 	static NetworkCache* getCache();
+	static NetworkTransport* getTransport(bool isPrivate = false);
 	static QString getAcceptLanguage();
 	static QStringList getUserAgents();
 	static QList<QSslCipher> getDefaultCiphers();
@@ -81,6 +83,8 @@ private:
 	static NetworkManagerFactory *m_instance;
 	static CookieJar *m_cookieJar;
 	static NetworkCache *m_cache;
+	static NetworkTransport *m_transport;
+	static NetworkTransport *m_privateTransport;
 	static QString m_acceptLanguage;
 	static QStringList m_userAgentsOrder;
 	static QMap<QString, UserAgentInformation> m_userAgents;
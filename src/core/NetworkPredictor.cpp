@@ -0,0 +1,272 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "NetworkPredictor.h"
+#include "HistoryManager.h"
+#include "NetworkManagerFactory.h"
+#include "NetworkTransport.h"
+#include "SettingsManager.h"
+
+#include <QtCore/QTimerEvent>
+#include <QtNetwork/QHostAddress>
+
+namespace Otter
+{
+
+NetworkPredictor* NetworkPredictor::m_instance = NULL;
+const qint64 NetworkPredictor::m_predictionTime = 60000;
+const int NetworkPredictor::m_lookupsLimit = 16;
+const int NetworkPredictor::m_preconnectsLimit = 4;
+const int NetworkPredictor::m_predictionsLimit = 200;
+const int NetworkPredictor::m_historyHostsAmount = 8;
+
+NetworkPredictor::NetworkPredictor(QObject *parent) : QObject(parent),
+	m_hostsWatcher(NULL),
+	m_budgetTimer(0),
+	m_historyTimer(0),
+	m_lookups(0),
+	m_preconnects(0),
+	m_hits(0),
+	m_misses(0),
+	m_skipped(0),
+	m_budgetLookups(0),
+	m_budgetPreconnects(0),
+	m_isPrefetchingDns(true),
+	m_isPreconnecting(true)
+{
+	m_timer.start();
+
+	m_budgetTimer = startTimer(10000);
+	m_historyTimer = startTimer(5000);
+
+	optionChanged(QLatin1String("Network/EnableDnsPrefetch"));
+	optionChanged(QLatin1String("Network/EnablePreconnect"));
+
+	connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), this, SLOT(optionChanged(QString)));
+}
+
+void NetworkPredictor::createInstance(QObject *parent)
+{
+	if (!m_instance)
+	{
+		m_instance = new NetworkPredictor(parent);
+	}
+}
+
+void NetworkPredictor::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_budgetTimer)
+	{
+		m_budgetLookups = 0;
+		m_budgetPreconnects = 0;
+
+		prunePredictions();
+	}
+	else if (event->timerId() == m_historyTimer)
+	{
+		killTimer(m_historyTimer);
+
+		m_historyTimer = 0;
+
+		m_hostsWatcher = new QFutureWatcher<QStringList>(this);
+
+		connect(m_hostsWatcher, SIGNAL(finished()), this, SLOT(topHostsLoaded()));
+
+		m_hostsWatcher->setFuture(HistoryManager::getTopHosts(m_historyHostsAmount));
+	}
+}
+
+void NetworkPredictor::optionChanged(const QString &option)
+{
+	if (option == QLatin1String("Network/EnableDnsPrefetch"))
+	{
+		m_isPrefetchingDns = SettingsManager::getValue(option).toBool();
+	}
+	else if (option == QLatin1String("Network/EnablePreconnect"))
+	{
+		m_isPreconnecting = SettingsManager::getValue(option).toBool();
+	}
+}
+
+void NetworkPredictor::hostLookedUp(const QHostInfo &information)
+{
+// failed lookup would not speed up anything, so it should not count as prediction
+	if (information.error() != QHostInfo::NoError)
+	{
+		m_predictions.remove(information.hostName().toLower());
+	}
+}
+
+void NetworkPredictor::topHostsLoaded()
+{
+	const QStringList hosts = m_hostsWatcher->result();
+
+	m_hostsWatcher->deleteLater();
+	m_hostsWatcher = NULL;
+
+	for (int i = 0; i < hosts.count(); ++i)
+	{
+		predictUrl(QUrl(QLatin1String("http://") + hosts.at(i)), HistorySource);
+	}
+}
+
+void NetworkPredictor::prunePredictions()
+{
+	const qint64 currentTime = m_timer.elapsed();
+	QHash<QString, NetworkPrediction>::iterator iterator = m_predictions.begin();
+
+	while (iterator != m_predictions.end())
+	{
+		if ((currentTime - iterator.value().time) >= m_predictionTime)
+		{
+			iterator = m_predictions.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+
+	if (m_predictions.count() > m_predictionsLimit)
+	{
+		m_predictions.clear();
+	}
+}
+
+void NetworkPredictor::predictUrl(const QUrl &url, PredictionSource source, bool isPrivate)
+{
+	if (!m_instance || (url.scheme() != QLatin1String("http") && url.scheme() != QLatin1String("https")) || url.host().isEmpty() || NetworkManagerFactory::isWorkingOffline())
+	{
+		return;
+	}
+
+	const QString host = url.host().toLower();
+	const qint64 currentTime = m_instance->m_timer.elapsed();
+	const bool isKnown = (m_instance->m_predictions.contains(host) && (currentTime - m_instance->m_predictions[host].time) < m_predictionTime);
+	const bool canPreconnect = (m_instance->m_isPreconnecting && source != HistorySource && source != TypedSource && (!isKnown || !m_instance->m_predictions[host].isPreconnected));
+	bool isPredicted = isKnown;
+	bool isPreconnected = false;
+
+	if (!isKnown && m_instance->m_isPrefetchingDns && QHostAddress(host).isNull())
+	{
+		if (m_instance->m_budgetLookups < m_lookupsLimit)
+		{
+			++m_instance->m_budgetLookups;
+			++m_instance->m_lookups;
+
+			QHostInfo::lookupHost(host, m_instance, SLOT(hostLookedUp(QHostInfo)));
+
+			isPredicted = true;
+		}
+		else
+		{
+			++m_instance->m_skipped;
+		}
+	}
+
+	if (canPreconnect)
+	{
+		if (m_instance->m_budgetPreconnects < m_preconnectsLimit)
+		{
+			if (NetworkManagerFactory::getTransport(isPrivate)->preconnect(url))
+			{
+				++m_instance->m_budgetPreconnects;
+				++m_instance->m_preconnects;
+
+				isPredicted = true;
+				isPreconnected = true;
+			}
+		}
+		else
+		{
+			++m_instance->m_skipped;
+		}
+	}
+
+	if (!isPredicted)
+	{
+		return;
+	}
+
+	if (!isKnown)
+	{
+		NetworkPrediction prediction;
+		prediction.time = currentTime;
+
+		m_instance->m_predictions[host] = prediction;
+	}
+
+	if (isPreconnected)
+	{
+		m_instance->m_predictions[host].isPreconnected = true;
+	}
+}
+
+void NetworkPredictor::registerNavigation(const QUrl &url)
+{
+	if (!m_instance || (url.scheme() != QLatin1String("http") && url.scheme() != QLatin1String("https")))
+	{
+		return;
+	}
+
+	const QString host = url.host().toLower();
+
+	if (m_instance->m_predictions.contains(host) && (m_instance->m_timer.elapsed() - m_instance->m_predictions[host].time) < m_predictionTime)
+	{
+// prediction is counted only once, repeated navigations to the same host within its window are neither hits nor misses
+		if (!m_instance->m_predictions[host].isUsed)
+		{
+			m_instance->m_predictions[host].isUsed = true;
+
+			++m_instance->m_hits;
+		}
+	}
+	else
+	{
+		++m_instance->m_misses;
+	}
+}
+
+NetworkPredictor* NetworkPredictor::getInstance()
+{
+	return m_instance;
+}
+
+QVariantHash NetworkPredictor::getStatistics()
+{
+	QVariantHash statistics;
+
+	if (!m_instance)
+	{
+		return statistics;
+	}
+
+	const int navigations = (m_instance->m_hits + m_instance->m_misses);
+
+	statistics[QLatin1String("lookups")] = m_instance->m_lookups;
+	statistics[QLatin1String("preconnects")] = m_instance->m_preconnects;
+	statistics[QLatin1String("skipped")] = m_instance->m_skipped;
+	statistics[QLatin1String("hits")] = m_instance->m_hits;
+	statistics[QLatin1String("misses")] = m_instance->m_misses;
+	statistics[QLatin1String("hitRate")] = ((navigations > 0) ? ((m_instance->m_hits * 100) / navigations) : 0);
+
+	return statistics;
+}
+
+}
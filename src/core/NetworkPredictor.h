@@ -0,0 +1,97 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_NETWORKPREDICTOR_H
+#define OTTER_NETWORKPREDICTOR_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QObject>
+#include <QtCore/QUrl>
+#include <QtNetwork/QHostInfo>
+
+namespace Otter
+{
+
+struct NetworkPrediction
+{
+	qint64 time;
+	bool isPreconnected;
+	bool isUsed;
+
+	NetworkPrediction() : time(0), isPreconnected(false), isUsed(false) {}
+};
+
+class NetworkPredictor : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum PredictionSource
+	{
+		HistorySource = 0,
+		HoverSource = 1,
+		TypedSource = 2,
+		CompletionSource = 3
+	};
+
+	static void createInstance(QObject *parent = NULL);
+	static void predictUrl(const QUrl &url, PredictionSource source, bool isPrivate = false);
+	static void registerNavigation(const QUrl &url);
+	static NetworkPredictor* getInstance();
+	static QVariantHash getStatistics();
+
+protected:
+	explicit NetworkPredictor(QObject *parent = NULL);
+
+	void timerEvent(QTimerEvent *event);
+	void prunePredictions();
+
+protected slots:
+	void optionChanged(const QString &option);
+	void hostLookedUp(const QHostInfo &information);
+	void topHostsLoaded();
+
+private:
+	QFutureWatcher<QStringList> *m_hostsWatcher;
+	QElapsedTimer m_timer;
+	QHash<QString, NetworkPrediction> m_predictions;
+	int m_budgetTimer;
+	int m_historyTimer;
+	int m_lookups;
+	int m_preconnects;
+	int m_hits;
+	int m_misses;
+	int m_skipped;
+	int m_budgetLookups;
+	int m_budgetPreconnects;
+	bool m_isPrefetchingDns;
+	bool m_isPreconnecting;
+
+	static NetworkPredictor *m_instance;
+	static const qint64 m_predictionTime;
+	static const int m_lookupsLimit;
+	static const int m_preconnectsLimit;
+	static const int m_predictionsLimit;
+	static const int m_historyHostsAmount;
+};
+
+}
+
+#endif
@@ -54,6 +54,8 @@ void NetworkProxyFactory::optionChanged(const QString &option)
 		if (!m_automaticProxy)
 		{
 			m_automaticProxy = new NetworkAutomaticProxy();
+
+			connect(m_automaticProxy, SIGNAL(messageReported(QString,int)), this, SLOT(reportMessage(QString,int)));
 		}
 
 		const QString path = SettingsManager::getValue(QLatin1String("Proxy/AutomaticConfigurationPath")).toString();
@@ -110,6 +112,11 @@ void NetworkProxyFactory::optionChanged(const QString &option)
 	}
 }
 
+void NetworkProxyFactory::reportMessage(const QString &message, int level)
+{
+	Console::addMessage(message, NetworkMessageCategory, static_cast<MessageLevel>(level), SettingsManager::getValue(QLatin1String("Proxy/AutomaticConfigurationPath")).toString());
+}
+
 QList<QNetworkProxy> NetworkProxyFactory::queryProxy(const QNetworkProxyQuery &query)
 {
 	if (m_proxyMode == SystemProxy)
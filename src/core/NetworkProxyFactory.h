@@ -49,6 +49,7 @@ public:
 
 protected slots:
 	void optionChanged(const QString &option);
+	void reportMessage(const QString &message, int level);
 
 private:
 	NetworkAutomaticProxy *m_automaticProxy;
@@ -0,0 +1,350 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "NetworkTimeline.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+
+namespace Otter
+{
+
+QList<NetworkTimeline*> NetworkTimeline::m_timelines;
+const int NetworkTimeline::m_entriesLimit = 500;
+const int NetworkTimeline::m_pagesLimit = 20;
+
+NetworkTimeline::NetworkTimeline(QObject *parent) : QObject(parent),
+	m_startTime(QDateTime::currentDateTime()),
+	m_identifier(0),
+	m_firstEntry(0),
+	m_entriesAmount(0)
+{
+	m_timer.start();
+	m_entries.resize(m_entriesLimit);
+
+	m_timelines.append(this);
+}
+
+NetworkTimeline::~NetworkTimeline()
+{
+	m_timelines.removeAll(this);
+}
+
+void NetworkTimeline::startPage(const QUrl &url)
+{
+	NetworkTimelinePage page;
+	page.url = url;
+	page.startTime = m_timer.elapsed();
+	page.identifier = (m_pages.isEmpty() ? 1 : (m_pages.last().identifier + 1));
+
+	m_pages.append(page);
+
+	if (m_pages.count() > m_pagesLimit)
+	{
+		m_pages.removeFirst();
+	}
+}
+
+void NetworkTimeline::addRequest(QNetworkReply *reply, QNetworkAccessManager::Operation operation)
+{
+	if (!reply)
+	{
+		return;
+	}
+
+	m_replies[reply] = createEntry(reply->request(), operation)->identifier;
+
+	connect(reply, SIGNAL(metaDataChanged()), this, SLOT(replyMetaDataChanged()));
+	connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(replyDownloadProgress(qint64,qint64)));
+	connect(reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+	connect(reply, SIGNAL(destroyed(QObject*)), this, SLOT(replyDestroyed(QObject*)));
+}
+
+void NetworkTimeline::addBlockedRequest(const QNetworkRequest &request, QNetworkAccessManager::Operation operation)
+{
+	NetworkTimelineEntry *entry = createEntry(request, operation);
+	entry->responseTime = entry->startTime;
+	entry->finishTime = entry->startTime;
+	entry->isBlocked = true;
+}
+
+void NetworkTimeline::replyMetaDataChanged()
+{
+	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+	NetworkTimelineEntry *entry = getEntry(reply);
+
+	if (!entry)
+	{
+		return;
+	}
+
+	if (entry->responseTime < 0)
+	{
+		entry->responseTime = m_timer.elapsed();
+	}
+
+	entry->statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+	entry->mimeType = reply->header(QNetworkRequest::ContentTypeHeader).toString().section(QLatin1Char(';'), 0, 0).trimmed();
+	entry->isCached = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+	entry->isEncrypted = reply->attribute(QNetworkRequest::ConnectionEncryptedAttribute).toBool();
+}
+
+void NetworkTimeline::replyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+	Q_UNUSED(bytesTotal)
+
+	NetworkTimelineEntry *entry = getEntry(qobject_cast<QNetworkReply*>(sender()));
+
+	if (entry)
+	{
+		entry->size = bytesReceived;
+	}
+}
+
+void NetworkTimeline::replyFinished()
+{
+	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+	NetworkTimelineEntry *entry = getEntry(reply);
+
+	if (entry)
+	{
+		entry->finishTime = m_timer.elapsed();
+
+		if (entry->responseTime < 0)
+		{
+			entry->responseTime = entry->finishTime;
+		}
+	}
+
+	if (reply)
+	{
+		disconnect(reply, NULL, this, NULL);
+
+		m_replies.remove(reply);
+	}
+}
+
+void NetworkTimeline::replyDestroyed(QObject *object)
+{
+	m_replies.remove(object);
+}
+
+NetworkTimelineEntry* NetworkTimeline::createEntry(const QNetworkRequest &request, QNetworkAccessManager::Operation operation)
+{
+	int index = 0;
+
+	if (m_entriesAmount < m_entriesLimit)
+	{
+		index = ((m_firstEntry + m_entriesAmount) % m_entriesLimit);
+
+		++m_entriesAmount;
+	}
+	else
+	{
+		index = m_firstEntry;
+
+		m_firstEntry = ((m_firstEntry + 1) % m_entriesLimit);
+	}
+
+	++m_identifier;
+
+	NetworkTimelineEntry *entry = &m_entries[index];
+	*entry = NetworkTimelineEntry();
+	entry->url = request.url();
+	entry->startTime = m_timer.elapsed();
+	entry->identifier = m_identifier;
+	entry->page = (m_pages.isEmpty() ? 0 : m_pages.last().identifier);
+
+	switch (operation)
+	{
+		case QNetworkAccessManager::HeadOperation:
+			entry->method = QLatin1String("HEAD");
+
+			break;
+		case QNetworkAccessManager::PutOperation:
+			entry->method = QLatin1String("PUT");
+
+			break;
+		case QNetworkAccessManager::PostOperation:
+			entry->method = QLatin1String("POST");
+
+			break;
+		case QNetworkAccessManager::DeleteOperation:
+			entry->method = QLatin1String("DELETE");
+
+			break;
+		case QNetworkAccessManager::CustomOperation:
+			entry->method = QString(request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray());
+
+			break;
+		default:
+			entry->method = QLatin1String("GET");
+
+			break;
+	}
+
+	return entry;
+}
+
+NetworkTimelineEntry* NetworkTimeline::getEntry(QNetworkReply *reply)
+{
+	if (!reply || !m_replies.contains(reply))
+	{
+		return NULL;
+	}
+
+	const quint64 identifier = m_replies[reply];
+
+	if ((m_identifier - identifier) >= quint64(m_entriesAmount))
+	{
+		return NULL;
+	}
+
+	return &m_entries[(m_firstEntry + m_entriesAmount - 1 - int(m_identifier - identifier)) % m_entriesLimit];
+}
+
+QDateTime NetworkTimeline::getStartTime() const
+{
+	return m_startTime;
+}
+
+QList<NetworkTimelineEntry> NetworkTimeline::getEntries() const
+{
+	QList<NetworkTimelineEntry> entries;
+	entries.reserve(m_entriesAmount);
+
+	for (int i = 0; i < m_entriesAmount; ++i)
+	{
+		entries.append(m_entries.at((m_firstEntry + i) % m_entriesLimit));
+	}
+
+	return entries;
+}
+
+QList<NetworkTimelinePage> NetworkTimeline::getPages() const
+{
+	return m_pages;
+}
+
+QList<NetworkTimeline*> NetworkTimeline::getTimelines()
+{
+	return m_timelines;
+}
+
+QJsonDocument NetworkTimeline::exportHar() const
+{
+	const QString dateFormat(QLatin1String("yyyy-MM-dd'T'HH:mm:ss.zzz'Z'"));
+	const QDateTime startTime = m_startTime.toUTC();
+	const QList<NetworkTimelineEntry> entries = getEntries();
+	QJsonArray pagesArray;
+	QJsonArray entriesArray;
+
+	for (int i = 0; i < m_pages.count(); ++i)
+	{
+		QJsonObject pageTimingsObject;
+		pageTimingsObject.insert(QLatin1String("onContentLoad"), -1);
+		pageTimingsObject.insert(QLatin1String("onLoad"), -1);
+
+		QJsonObject pageObject;
+		pageObject.insert(QLatin1String("startedDateTime"), startTime.addMSecs(m_pages.at(i).startTime).toString(dateFormat));
+		pageObject.insert(QLatin1String("id"), QStringLiteral("page_%1").arg(m_pages.at(i).identifier));
+		pageObject.insert(QLatin1String("title"), m_pages.at(i).url.toString());
+		pageObject.insert(QLatin1String("pageTimings"), pageTimingsObject);
+
+		pagesArray.append(pageObject);
+	}
+
+	for (int i = 0; i < entries.count(); ++i)
+	{
+		const NetworkTimelineEntry &entry = entries.at(i);
+		const qint64 finishTime = ((entry.finishTime < 0) ? m_timer.elapsed() : entry.finishTime);
+		const qint64 responseTime = ((entry.responseTime < 0) ? finishTime : entry.responseTime);
+
+		QJsonObject requestObject;
+		requestObject.insert(QLatin1String("method"), entry.method);
+		requestObject.insert(QLatin1String("url"), entry.url.toString());
+		requestObject.insert(QLatin1String("httpVersion"), QString());
+		requestObject.insert(QLatin1String("cookies"), QJsonArray());
+		requestObject.insert(QLatin1String("headers"), QJsonArray());
+		requestObject.insert(QLatin1String("queryString"), QJsonArray());
+		requestObject.insert(QLatin1String("headersSize"), -1);
+		requestObject.insert(QLatin1String("bodySize"), -1);
+
+		QJsonObject contentObject;
+		contentObject.insert(QLatin1String("size"), entry.size);
+		contentObject.insert(QLatin1String("mimeType"), entry.mimeType);
+
+		QJsonObject responseObject;
+		responseObject.insert(QLatin1String("status"), entry.statusCode);
+		responseObject.insert(QLatin1String("statusText"), QString());
+		responseObject.insert(QLatin1String("httpVersion"), QString());
+		responseObject.insert(QLatin1String("cookies"), QJsonArray());
+		responseObject.insert(QLatin1String("headers"), QJsonArray());
+		responseObject.insert(QLatin1String("content"), contentObject);
+		responseObject.insert(QLatin1String("redirectURL"), QString());
+		responseObject.insert(QLatin1String("headersSize"), -1);
+		responseObject.insert(QLatin1String("bodySize"), (entry.isCached ? 0 : entry.size));
+
+		QJsonObject timingsObject;
+		timingsObject.insert(QLatin1String("blocked"), -1);
+		timingsObject.insert(QLatin1String("dns"), -1);
+		timingsObject.insert(QLatin1String("connect"), -1);
+		timingsObject.insert(QLatin1String("ssl"), -1);
+		timingsObject.insert(QLatin1String("send"), 0);
+		timingsObject.insert(QLatin1String("wait"), (responseTime - entry.startTime));
+		timingsObject.insert(QLatin1String("receive"), (finishTime - responseTime));
+
+		QJsonObject entryObject;
+
+		if (entry.page > 0)
+		{
+			entryObject.insert(QLatin1String("pageref"), QStringLiteral("page_%1").arg(entry.page));
+		}
+
+		entryObject.insert(QLatin1String("startedDateTime"), startTime.addMSecs(entry.startTime).toString(dateFormat));
+		entryObject.insert(QLatin1String("time"), (finishTime - entry.startTime));
+		entryObject.insert(QLatin1String("request"), requestObject);
+		entryObject.insert(QLatin1String("response"), responseObject);
+		entryObject.insert(QLatin1String("cache"), QJsonObject());
+		entryObject.insert(QLatin1String("timings"), timingsObject);
+		entryObject.insert(QLatin1String("_blocked"), entry.isBlocked);
+		entryObject.insert(QLatin1String("_fromCache"), entry.isCached);
+		entryObject.insert(QLatin1String("_encrypted"), entry.isEncrypted);
+
+		entriesArray.append(entryObject);
+	}
+
+	QJsonObject creatorObject;
+	creatorObject.insert(QLatin1String("name"), QCoreApplication::applicationName());
+	creatorObject.insert(QLatin1String("version"), QCoreApplication::applicationVersion());
+
+	QJsonObject logObject;
+	logObject.insert(QLatin1String("version"), QLatin1String("1.2"));
+	logObject.insert(QLatin1String("creator"), creatorObject);
+	logObject.insert(QLatin1String("pages"), pagesArray);
+	logObject.insert(QLatin1String("entries"), entriesArray);
+
+	QJsonObject rootObject;
+	rootObject.insert(QLatin1String("log"), logObject);
+
+	return QJsonDocument(rootObject);
+}
+
+}
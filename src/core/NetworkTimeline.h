@@ -0,0 +1,105 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_NETWORKTIMELINE_H
+#define OTTER_NETWORKTIMELINE_H
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QVector>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+
+namespace Otter
+{
+
+struct NetworkTimelineEntry
+{
+	QUrl url;
+	QString method;
+	QString mimeType;
+	qint64 startTime;
+	qint64 responseTime;
+	qint64 finishTime;
+	qint64 size;
+	quint64 identifier;
+	int page;
+	int statusCode;
+	bool isBlocked;
+	bool isCached;
+	bool isEncrypted;
+
+	NetworkTimelineEntry() : startTime(-1), responseTime(-1), finishTime(-1), size(0), identifier(0), page(0), statusCode(0), isBlocked(false), isCached(false), isEncrypted(false) {}
+};
+
+struct NetworkTimelinePage
+{
+	QUrl url;
+	qint64 startTime;
+	int identifier;
+
+	NetworkTimelinePage() : startTime(0), identifier(0) {}
+};
+
+class NetworkTimeline : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit NetworkTimeline(QObject *parent = NULL);
+	~NetworkTimeline();
+
+	void startPage(const QUrl &url);
+	void addRequest(QNetworkReply *reply, QNetworkAccessManager::Operation operation);
+	void addBlockedRequest(const QNetworkRequest &request, QNetworkAccessManager::Operation operation);
+	QDateTime getStartTime() const;
+	QList<NetworkTimelineEntry> getEntries() const;
+	QList<NetworkTimelinePage> getPages() const;
+	QJsonDocument exportHar() const;
+	static QList<NetworkTimeline*> getTimelines();
+
+protected:
+	NetworkTimelineEntry* createEntry(const QNetworkRequest &request, QNetworkAccessManager::Operation operation);
+	NetworkTimelineEntry* getEntry(QNetworkReply *reply);
+
+protected slots:
+	void replyMetaDataChanged();
+	void replyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+	void replyFinished();
+	void replyDestroyed(QObject *object);
+
+private:
+	QElapsedTimer m_timer;
+	QDateTime m_startTime;
+	QVector<NetworkTimelineEntry> m_entries;
+	QList<NetworkTimelinePage> m_pages;
+	QHash<QObject*, quint64> m_replies;
+	quint64 m_identifier;
+	int m_firstEntry;
+	int m_entriesAmount;
+
+	static QList<NetworkTimeline*> m_timelines;
+	static const int m_entriesLimit;
+	static const int m_pagesLimit;
+};
+
+}
+
+#endif
@@ -0,0 +1,261 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "NetworkTransport.h"
+#include "NetworkCache.h"
+#include "NetworkManagerFactory.h"
+#include "SessionsManager.h"
+#include "../ui/AuthenticationDialog.h"
+#include "../ui/MainWindow.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtNetwork/QNetworkProxy>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QSslError>
+
+namespace Otter
+{
+
+const int NetworkTransport::m_connectionsPerOrigin = 6;
+const int NetworkTransport::m_connectionsExpiryTime = 120;
+
+NetworkTransport::NetworkTransport(bool isPrivate, QObject *parent) : QNetworkAccessManager(parent),
+	m_requests(0),
+	m_openedConnections(0),
+	m_reusedConnections(0),
+	m_preconnectedConnections(0)
+{
+	if (!isPrivate)
+	{
+		QNetworkDiskCache *cache = NetworkManagerFactory::getCache();
+
+		setCache(cache);
+
+		cache->setParent(QCoreApplication::instance());
+	}
+
+	connect(this, SIGNAL(authenticationRequired(QNetworkReply*,QAuthenticator*)), this, SLOT(handleAuthenticationRequired(QNetworkReply*,QAuthenticator*)));
+	connect(this, SIGNAL(proxyAuthenticationRequired(QNetworkProxy,QAuthenticator*)), this, SLOT(handleProxyAuthenticationRequired(QNetworkProxy,QAuthenticator*)));
+	connect(this, SIGNAL(sslErrors(QNetworkReply*,QList<QSslError>)), this, SLOT(handleSslErrors(QNetworkReply*,QList<QSslError>)));
+	connect(this, SIGNAL(finished(QNetworkReply*)), this, SLOT(requestFinished(QNetworkReply*)));
+}
+
+void NetworkTransport::handleAuthenticationRequired(QNetworkReply *reply, QAuthenticator *authenticator)
+{
+	QObject *receiver = m_receivers.value(reply);
+
+	if (receiver)
+	{
+		QMetaObject::invokeMethod(receiver, "handleAuthenticationRequired", Qt::DirectConnection, Q_ARG(QNetworkReply*, reply), Q_ARG(QAuthenticator*, authenticator));
+	}
+}
+
+void NetworkTransport::handleProxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *authenticator)
+{
+	if (NetworkManagerFactory::isUsingSystemProxyAuthentication())
+	{
+		authenticator->setUser(QString());
+
+		return;
+	}
+
+	AuthenticationDialog dialog(QUrl(proxy.hostName()), authenticator, SessionsManager::getActiveWindow());
+	dialog.exec();
+}
+
+void NetworkTransport::handleSslErrors(QNetworkReply *reply, const QList<QSslError> &errors)
+{
+	QObject *receiver = m_receivers.value(reply);
+
+	if (receiver)
+	{
+		QMetaObject::invokeMethod(receiver, "handleSslErrors", Qt::DirectConnection, Q_ARG(QNetworkReply*, reply), Q_ARG(QList<QSslError>, errors));
+	}
+}
+
+void NetworkTransport::requestFinished(QNetworkReply *reply)
+{
+	QObject *receiver = m_receivers.value(reply);
+
+	removeReply(reply);
+
+	if (receiver)
+	{
+		QMetaObject::invokeMethod(receiver, "requestFinished", Qt::DirectConnection, Q_ARG(QNetworkReply*, reply));
+	}
+}
+
+void NetworkTransport::replyDestroyed(QObject *object)
+{
+	removeReply(static_cast<QNetworkReply*>(object));
+}
+
+void NetworkTransport::removeReply(QNetworkReply *reply)
+{
+	m_receivers.remove(reply);
+
+	if (!m_replies.contains(reply))
+	{
+		return;
+	}
+
+	const QString origin = m_replies.take(reply);
+
+	--m_activeRequests[origin];
+
+	if (m_activeRequests[origin] <= 0)
+	{
+		m_activeRequests.remove(origin);
+
+		m_idleConnections[origin] = QDateTime::currentMSecsSinceEpoch();
+	}
+}
+
+void NetworkTransport::expireConnections()
+{
+// connections of QNetworkAccessManager are closed after being unused for two minutes, so idle origins are considered disconnected after the same time
+	const qint64 expiryTime = (QDateTime::currentMSecsSinceEpoch() - (m_connectionsExpiryTime * 1000));
+	QHash<QString, qint64>::iterator iterator = m_idleConnections.begin();
+
+	while (iterator != m_idleConnections.end())
+	{
+		if (iterator.value() < expiryTime)
+		{
+			m_connections.remove(iterator.key());
+
+			iterator = m_idleConnections.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+}
+
+QNetworkReply* NetworkTransport::sendRequest(Operation operation, const QNetworkRequest &request, QIODevice *outgoingData, QObject *receiver)
+{
+	QNetworkReply *reply = createRequest(operation, request, outgoingData);
+	const QString origin = getOrigin(request.url());
+
+	if (!reply)
+	{
+		return reply;
+	}
+
+	if (receiver)
+	{
+		m_receivers[reply] = receiver;
+	}
+
+	connect(reply, SIGNAL(destroyed(QObject*)), this, SLOT(replyDestroyed(QObject*)));
+
+	if (origin.isEmpty())
+	{
+		return reply;
+	}
+
+	expireConnections();
+
+	++m_requests;
+
+	const int activeRequests = ++m_activeRequests[origin];
+	const int connections = m_connections.value(origin, 0);
+
+	if (activeRequests > connections && connections < m_connectionsPerOrigin)
+	{
+		m_connections[origin] = (connections + 1);
+
+		++m_openedConnections;
+	}
+	else
+	{
+		++m_reusedConnections;
+	}
+
+	m_replies[reply] = origin;
+	m_idleConnections.remove(origin);
+
+	return reply;
+}
+
+bool NetworkTransport::preconnect(const QUrl &url)
+{
+	const QString origin = getOrigin(url);
+
+	if (origin.isEmpty())
+	{
+		return false;
+	}
+
+	expireConnections();
+
+	if (m_connections.value(origin, 0) > 0)
+	{
+		return false;
+	}
+
+	if (url.scheme() == QLatin1String("https"))
+	{
+#ifdef QT_NO_SSL
+		return false;
+#else
+		connectToHostEncrypted(url.host(), url.port(443));
+#endif
+	}
+	else
+	{
+		connectToHost(url.host(), url.port(80));
+	}
+
+	m_connections[origin] = 1;
+	m_idleConnections[origin] = QDateTime::currentMSecsSinceEpoch();
+
+	++m_openedConnections;
+	++m_preconnectedConnections;
+
+	return true;
+}
+
+QString NetworkTransport::getOrigin(const QUrl &url)
+{
+	const QString scheme = url.scheme();
+
+	if (scheme != QLatin1String("http") && scheme != QLatin1String("https"))
+	{
+		return QString();
+	}
+
+	return QStringLiteral("%1://%2:%3").arg(scheme).arg(url.host()).arg(url.port((scheme == QLatin1String("https")) ? 443 : 80));
+}
+
+QVariantHash NetworkTransport::getStatistics() const
+{
+	QVariantHash statistics;
+	statistics[QLatin1String("requests")] = m_requests;
+	statistics[QLatin1String("openedConnections")] = m_openedConnections;
+	statistics[QLatin1String("reusedConnections")] = m_reusedConnections;
+	statistics[QLatin1String("preconnectedConnections")] = m_preconnectedConnections;
+	statistics[QLatin1String("activeRequests")] = m_replies.count();
+	statistics[QLatin1String("idleOrigins")] = m_idleConnections.count();
+
+	return statistics;
+}
+
+}
@@ -0,0 +1,69 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_NETWORKTRANSPORT_H
+#define OTTER_NETWORKTRANSPORT_H
+
+#include <QtCore/QPointer>
+#include <QtNetwork/QNetworkAccessManager>
+
+namespace Otter
+{
+
+class NetworkTransport : public QNetworkAccessManager
+{
+	Q_OBJECT
+
+public:
+	explicit NetworkTransport(bool isPrivate, QObject *parent = NULL);
+
+	QNetworkReply* sendRequest(Operation operation, const QNetworkRequest &request, QIODevice *outgoingData = NULL, QObject *receiver = NULL);
+	bool preconnect(const QUrl &url);
+	QVariantHash getStatistics() const;
+
+protected:
+	void removeReply(QNetworkReply *reply);
+	void expireConnections();
+	static QString getOrigin(const QUrl &url);
+
+protected slots:
+	void handleAuthenticationRequired(QNetworkReply *reply, QAuthenticator *authenticator);
+	void handleProxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *authenticator);
+	void handleSslErrors(QNetworkReply *reply, const QList<QSslError> &errors);
+	void requestFinished(QNetworkReply *reply);
+	void replyDestroyed(QObject *object);
+
+private:
+	QHash<QNetworkReply*, QString> m_replies;
+	QHash<QNetworkReply*, QPointer<QObject> > m_receivers;
+	QHash<QString, int> m_activeRequests;
+	QHash<QString, int> m_connections;
+	QHash<QString, qint64> m_idleConnections;
+	int m_requests;
+	int m_openedConnections;
+	int m_reusedConnections;
+	int m_preconnectedConnections;
+
+	static const int m_connectionsPerOrigin;
+	static const int m_connectionsExpiryTime;
+};
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include "SessionsManager.h"
 
 #include <QtCore/QDateTime>
+#include <QtCore/QCoreApplication>
 
 namespace Otter
 {
@@ -66,12 +67,17 @@ void NotesManager::scheduleSave()
 
 NotesManager* NotesManager::getInstance()
 {
+	if (!m_instance)
+	{
+		createInstance(QCoreApplication::instance());
+	}
+
 	return m_instance;
 }
 
 BookmarksModel* NotesManager::getModel()
 {
-	if (!m_model && m_instance)
+	if (!m_model && getInstance())
 	{
 		m_model = new BookmarksModel(SessionsManager::getWritableDataPath(QLatin1String("notes.xbel")), BookmarksModel::NotesMode, m_instance);
 
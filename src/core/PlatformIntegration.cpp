@@ -41,6 +41,11 @@ QList<ApplicationInformation> PlatformIntegration::getApplicationsForMimeType(co
 	return QList<ApplicationInformation>();
 }
 
+qint64 PlatformIntegration::getMemoryUsage() const
+{
+	return -1;
+}
+
 bool PlatformIntegration::canShowNotifications() const
 {
 	return false;
@@ -39,6 +39,7 @@ public:
 
 	virtual void runApplication(const QString &command, const QString &fileName = QString()) const;
 	virtual QList<ApplicationInformation> getApplicationsForMimeType(const QMimeType &mimeType);
+	virtual qint64 getMemoryUsage() const;
 	virtual bool canShowNotifications() const;
 	virtual bool canSetAsDefaultBrowser() const;
 	virtual bool isDefaultBrowser() const;
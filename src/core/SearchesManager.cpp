@@ -23,6 +23,7 @@
 #include "Utils.h"
 
 #include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QXmlStreamReader>
@@ -59,7 +60,7 @@ void SearchesManager::initialize()
 
 		loadSearchEngines();
 
-		connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), m_instance, SLOT(optionChanged(QString)));
+		connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), getInstance(), SLOT(optionChanged(QString)));
 	}
 }
 
@@ -121,7 +122,7 @@ void SearchesManager::addSearchEngine(const SearchInformation &engine, bool isDe
 
 		if (m_searchEnginesOrder.contains(engine.identifier))
 		{
-			emit m_instance->searchEnginesModified();
+			emit getInstance()->searchEnginesModified();
 
 			updateSearchEnginesModel();
 		}
@@ -369,6 +370,11 @@ SearchInformation SearchesManager::loadSearchEngine(QIODevice *device, const QSt
 
 SearchesManager* SearchesManager::getInstance()
 {
+	if (!m_instance)
+	{
+		createInstance(QCoreApplication::instance());
+	}
+
 	return m_instance;
 }
 
@@ -381,7 +387,7 @@ QStandardItemModel* SearchesManager::getSearchEnginesModel()
 
 	if (!m_searchEnginesModel)
 	{
-		m_searchEnginesModel = new QStandardItemModel(m_instance);
+		m_searchEnginesModel = new QStandardItemModel(getInstance());
 
 		m_instance->updateSearchEnginesModel();
 	}
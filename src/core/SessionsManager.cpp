@@ -20,25 +20,218 @@
 
 #include "SessionsManager.h"
 #include "ActionsManager.h"
+#include "ClosedItemsStore.h"
 #include "Application.h"
-#include "Utils.h"
+#include "Console.h"
 #include "WindowsManager.h"
 #include "../ui/MainWindow.h"
+#include "../ui/TabBarWidget.h"
+#include "../ui/Window.h"
 
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
 #include <QtCore/QSaveFile>
 #include <QtCore/QSettings>
+#include <QtCore/QVector>
 
 namespace Otter
 {
 
+struct SessionStringsTable
+{
+	QHash<QString, quint32> indexes;
+	QVector<QString> strings;
+
+	quint32 getIndex(const QString &string)
+	{
+		QHash<QString, quint32>::const_iterator iterator = indexes.constFind(string);
+
+		if (iterator != indexes.constEnd())
+		{
+			return iterator.value();
+		}
+
+		indexes.insert(string, strings.count());
+
+		strings.append(string);
+
+		return (strings.count() - 1);
+	}
+};
+
+struct SessionRecordWriter
+{
+	SessionStringsTable strings;
+	QString defaultSearchEngine;
+	QString defaultUserAgent;
+
+	SessionRecordWriter(const QString &defaultSearchEngineValue = QString(), const QString &defaultUserAgentValue = QString()) : defaultSearchEngine(defaultSearchEngineValue), defaultUserAgent(defaultUserAgentValue) {}
+
+	void writeStrings(QDataStream &stream) const
+	{
+		stream << quint32(strings.strings.count());
+
+		for (int i = 0; i < strings.strings.count(); ++i)
+		{
+			stream << strings.strings.at(i);
+		}
+	}
+
+	void writeWindow(QDataStream &stream, const SessionMainWindow &window)
+	{
+		stream << window.geometry << qint32(window.index) << quint32(window.windows.count());
+
+		for (int i = 0; i < window.windows.count(); ++i)
+		{
+			stream << writeRecord(window.windows.at(i));
+		}
+	}
+
+	QByteArray writeRecord(const SessionWindow &window)
+	{
+		QByteArray record;
+		QDataStream stream(&record, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_2);
+		stream << quint64(window.identifier);
+		stream << strings.getIndex((window.searchEngine == defaultSearchEngine) ? QString() : window.searchEngine);
+		stream << strings.getIndex((window.userAgent == defaultUserAgent) ? QString() : window.userAgent);
+		stream << qint32(window.group) << qint32(window.index) << qint32(window.reloadTime) << window.isPinned;
+		stream << quint32(window.history.count());
+
+// scheme and host are shared by most entries, so only the rest of URL is stored inline
+		for (int i = 0; i < window.history.count(); ++i)
+		{
+			const WindowHistoryEntry &entry = window.history.at(i);
+			const int offset = entry.url.indexOf(QLatin1String("://"));
+			const int hostEnd = ((offset < 0) ? 0 : entry.url.indexOf(QLatin1Char('/'), (offset + 3)));
+			const int length = ((hostEnd < 0) ? entry.url.length() : hostEnd);
+
+			stream << strings.getIndex(entry.url.left(length)) << entry.url.mid(length) << strings.getIndex(entry.title);
+			stream << qint32(entry.position.x()) << qint32(entry.position.y()) << qint32(entry.zoom);
+		}
+
+		return record;
+	}
+};
+
+struct SessionRecordReader
+{
+	typedef SessionWindow result_type;
+
+	QVector<QString> strings;
+	int defaultZoom;
+
+	SessionRecordReader(const QVector<QString> &stringsValue, int defaultZoomValue) : strings(stringsValue), defaultZoom(defaultZoomValue) {}
+
+	static QVector<QString> readStrings(QDataStream &stream)
+	{
+		QVector<QString> strings;
+		quint32 amount = 0;
+
+		stream >> amount;
+
+		for (quint32 i = 0; (i < amount && stream.status() == QDataStream::Ok); ++i)
+		{
+			QString string;
+
+			stream >> string;
+
+			strings.append(string);
+		}
+
+		return strings;
+	}
+
+	static int readWindow(QDataStream &stream, SessionMainWindow *window, QList<QByteArray> *records)
+	{
+		qint32 index = -1;
+		quint32 amount = 0;
+
+		stream >> window->geometry >> index >> amount;
+
+		window->index = index;
+
+		for (quint32 i = 0; (i < amount && stream.status() == QDataStream::Ok); ++i)
+		{
+			QByteArray record;
+
+			stream >> record;
+
+			records->append(record);
+		}
+
+		return amount;
+	}
+
+	SessionWindow operator()(const QByteArray &data) const
+	{
+		QDataStream stream(data);
+		stream.setVersion(QDataStream::Qt_5_2);
+
+		quint64 identifier = 0;
+		quint32 searchEngine = 0;
+		quint32 userAgent = 0;
+		qint32 group = 0;
+		qint32 index = -1;
+		qint32 reloadTime = -1;
+		quint32 history = 0;
+		SessionWindow window;
+
+		stream >> identifier >> searchEngine >> userAgent >> group >> index >> reloadTime >> window.isPinned >> history;
+
+		window.identifier = identifier;
+		window.searchEngine = strings.value(searchEngine);
+		window.userAgent = strings.value(userAgent);
+		window.group = group;
+		window.index = index;
+		window.reloadTime = reloadTime;
+
+		for (quint32 i = 0; (i < history && stream.status() == QDataStream::Ok); ++i)
+		{
+			quint32 host = 0;
+			quint32 title = 0;
+			qint32 x = 0;
+			qint32 y = 0;
+			qint32 zoom = defaultZoom;
+			QString path;
+			WindowHistoryEntry entry(defaultZoom);
+
+			stream >> host >> path >> title >> x >> y >> zoom;
+
+			entry.url = strings.value(host) + path;
+			entry.title = strings.value(title);
+			entry.position = QPoint(x, y);
+			entry.zoom = zoom;
+
+			window.history.append(entry);
+		}
+
+		return window;
+	}
+};
+
 SessionsManager* SessionsManager::m_instance = NULL;
 QPointer<MainWindow> SessionsManager::m_activeWindow = NULL;
 QString SessionsManager::m_session;
 QString SessionsManager::m_cachePath;
 QString SessionsManager::m_profilePath;
 QList<MainWindow*> SessionsManager::m_windows;
-QList<SessionMainWindow> SessionsManager::m_closedWindows;
+ClosedItemsStore* SessionsManager::m_closedWindows = NULL;
+QFutureWatcher<bool>* SessionsManager::m_compactionWatcher = NULL;
+QString SessionsManager::m_journalTitle;
+QString SessionsManager::m_journalToken;
+QJsonObject SessionsManager::m_journalLayout;
+QHash<quint64, SessionWindow> SessionsManager::m_journalWindows;
+QSet<quint64> SessionsManager::m_modifiedWindows;
+qint64 SessionsManager::m_journalSize = 0;
+const qint64 SessionsManager::m_journalLimit = 1048576;
+const quint32 SessionsManager::m_sessionMagic = 0x4F545353;
+const quint16 SessionsManager::m_sessionVersion = 1;
 bool SessionsManager::m_isDirty = false;
 bool SessionsManager::m_isPrivate = false;
 
@@ -47,6 +240,13 @@ SessionsManager::SessionsManager(QObject *parent) : QObject(parent),
 {
 }
 
+SessionsManager::~SessionsManager()
+{
+	delete m_closedWindows;
+
+	m_closedWindows = NULL;
+}
+
 void SessionsManager::timerEvent(QTimerEvent *event)
 {
 	if (event->timerId() == m_saveTimer)
@@ -59,7 +259,7 @@ void SessionsManager::timerEvent(QTimerEvent *event)
 
 		if (!m_isPrivate)
 		{
-			saveSession(QString(), QString(), NULL, false);
+			saveJournal();
 		}
 	}
 }
@@ -72,6 +272,10 @@ void SessionsManager::createInstance(const QString &profilePath, const QString &
 		m_cachePath = cachePath;
 		m_profilePath = profilePath;
 		m_isPrivate = isPrivate;
+
+		ClosedItemsStore::removeStaleFiles();
+
+		m_closedWindows = new ClosedItemsStore();
 	}
 }
 
@@ -83,9 +287,329 @@ void SessionsManager::scheduleSave()
 	}
 }
 
+void SessionsManager::saveJournal()
+{
+	if (m_compactionWatcher)
+	{
+		scheduleSave();
+
+		return;
+	}
+
+	const QList<MainWindow*> windows = Application::getInstance()->getWindows();
+
+	if (windows.isEmpty())
+	{
+		return;
+	}
+
+	const QJsonObject layout = getJournalLayout();
+	const QJsonArray mainWindows = layout.value(QLatin1String("windows")).toArray();
+	QSet<quint64> identifiers;
+
+	for (int i = 0; i < mainWindows.count(); ++i)
+	{
+		const QJsonArray tabs = mainWindows.at(i).toObject().value(QLatin1String("tabs")).toArray();
+
+		for (int j = 0; j < tabs.count(); ++j)
+		{
+			const quint64 identifier = tabs.at(j).toString().toULongLong();
+
+			identifiers.insert(identifier);
+
+			if (!m_journalWindows.contains(identifier))
+			{
+				m_modifiedWindows.insert(identifier);
+			}
+		}
+	}
+
+	const QList<quint64> modifiedWindows = m_modifiedWindows.toList();
+	QByteArray data;
+
+	m_modifiedWindows.clear();
+
+	for (int i = 0; i < modifiedWindows.count(); ++i)
+	{
+		if (!identifiers.contains(modifiedWindows.at(i)))
+		{
+			continue;
+		}
+
+		Window *window = NULL;
+
+		for (int j = 0; (j < windows.count() && !window); ++j)
+		{
+			window = windows.at(j)->getWindowsManager()->getWindowByIdentifier(modifiedWindows.at(i));
+		}
+
+		if (!window)
+		{
+			continue;
+		}
+
+		const SessionWindow session = window->getSession();
+
+		m_journalWindows[modifiedWindows.at(i)] = session;
+
+		if (!m_journalToken.isEmpty())
+		{
+			QJsonObject record = getJournalRecord(session);
+			record.insert(QLatin1String("type"), QLatin1String("window"));
+
+			data.append(QJsonDocument(record).toJson(QJsonDocument::Compact));
+			data.append('\n');
+		}
+	}
+
+	QHash<quint64, SessionWindow>::iterator iterator = m_journalWindows.begin();
+
+	while (iterator != m_journalWindows.end())
+	{
+		if (identifiers.contains(iterator.key()))
+		{
+			++iterator;
+		}
+		else
+		{
+			iterator = m_journalWindows.erase(iterator);
+		}
+	}
+
+// first save in this run writes full checkpoint, journal only contains changes made after it
+	if (m_journalToken.isEmpty())
+	{
+		m_journalLayout = layout;
+
+		compactJournal();
+
+		return;
+	}
+
+	if (layout != m_journalLayout)
+	{
+		m_journalLayout = layout;
+
+		QJsonObject record = layout;
+		record.insert(QLatin1String("type"), QLatin1String("layout"));
+
+		data.append(QJsonDocument(record).toJson(QJsonDocument::Compact));
+		data.append('\n');
+	}
+
+	if (data.isEmpty())
+	{
+		return;
+	}
+
+	QFile file(getJournalPath(getSessionPath(QLatin1String("default"))));
+
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(data) != data.size())
+	{
+		m_journalToken.clear();
+
+		scheduleSave();
+
+		return;
+	}
+
+	file.close();
+
+	m_journalSize += data.size();
+
+	if (m_journalSize > m_journalLimit)
+	{
+		compactJournal();
+	}
+}
+
+void SessionsManager::compactJournal()
+{
+	const QString sessionPath = getSessionPath(QLatin1String("default"));
+
+	if (m_journalToken.isEmpty())
+	{
+		m_journalTitle = getSessionTitle(sessionPath);
+	}
+
+	SessionInformation session;
+	session.path = QLatin1String("default");
+	session.title = m_journalTitle;
+	session.index = 0;
+	session.clean = false;
+
+	const QJsonArray mainWindows = m_journalLayout.value(QLatin1String("windows")).toArray();
+
+	for (int i = 0; i < mainWindows.count(); ++i)
+	{
+		const QJsonObject mainWindow = mainWindows.at(i).toObject();
+		const QJsonArray tabs = mainWindow.value(QLatin1String("tabs")).toArray();
+		SessionMainWindow sessionEntry;
+		sessionEntry.geometry = QByteArray::fromBase64(mainWindow.value(QLatin1String("geometry")).toString().toLatin1());
+		sessionEntry.index = mainWindow.value(QLatin1String("index")).toInt();
+
+		for (int j = 0; j < tabs.count(); ++j)
+		{
+			const quint64 identifier = tabs.at(j).toString().toULongLong();
+
+			if (m_journalWindows.contains(identifier))
+			{
+				sessionEntry.windows.append(m_journalWindows[identifier]);
+			}
+		}
+
+		session.windows.append(sessionEntry);
+	}
+
+	m_journalToken = QString::number(QDateTime::currentMSecsSinceEpoch());
+
+	m_compactionWatcher = new QFutureWatcher<bool>(m_instance);
+	m_compactionWatcher->setFuture(QtConcurrent::run(&SessionsManager::writeSession, sessionPath, session, m_journalToken, SettingsManager::getValue(QLatin1String("Search/DefaultSearchEngine")).toString(), SettingsManager::getValue(QLatin1String("Network/UserAgent")).toString()));
+
+	connect(m_compactionWatcher, SIGNAL(finished()), m_instance, SLOT(handleCompactionFinished()));
+}
+
+void SessionsManager::handleCompactionFinished()
+{
+	const bool result = m_compactionWatcher->result();
+
+	m_compactionWatcher->deleteLater();
+	m_compactionWatcher = NULL;
+
+	QFile file(getJournalPath(getSessionPath(QLatin1String("default"))));
+
+	if (!result || !file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		m_journalToken.clear();
+
+		scheduleSave();
+
+		return;
+	}
+
+	QJsonObject record;
+	record.insert(QLatin1String("type"), QLatin1String("journal"));
+	record.insert(QLatin1String("token"), m_journalToken);
+
+	QByteArray data = QJsonDocument(record).toJson(QJsonDocument::Compact);
+	data.append('\n');
+
+	file.write(data);
+	file.close();
+
+	m_journalSize = data.size();
+
+	if (!m_modifiedWindows.isEmpty())
+	{
+		scheduleSave();
+	}
+}
+
+void SessionsManager::handleWindowsChanged()
+{
+	markSessionModified();
+}
+
+void SessionsManager::readJournal(const QString &path, const QString &token, SessionInformation *session)
+{
+	QFile file(path);
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return;
+	}
+
+	QHash<quint64, SessionWindow> windows;
+	QJsonObject layout;
+	const int defaultZoom = SettingsManager::getValue(QLatin1String("Content/DefaultZoom")).toInt();
+	bool isValid = false;
+
+	for (int i = 0; i < session->windows.count(); ++i)
+	{
+		for (int j = 0; j < session->windows.at(i).windows.count(); ++j)
+		{
+			windows[session->windows.at(i).windows.at(j).identifier] = session->windows.at(i).windows.at(j);
+		}
+	}
+
+// journal is only valid for snapshot which has the same token, partially written last record is skipped
+	while (!file.atEnd())
+	{
+		const QJsonObject record = QJsonDocument::fromJson(file.readLine()).object();
+		const QString type = record.value(QLatin1String("type")).toString();
+
+		if (!isValid)
+		{
+			if (type != QLatin1String("journal") || record.value(QLatin1String("token")).toString() != token)
+			{
+				return;
+			}
+
+			isValid = true;
+		}
+		else if (type == QLatin1String("window"))
+		{
+			const SessionWindow window = getJournalWindow(record, defaultZoom);
+
+			windows[window.identifier] = window;
+		}
+		else if (type == QLatin1String("layout"))
+		{
+			layout = record;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (!isValid)
+	{
+		return;
+	}
+
+	if (layout.isEmpty())
+	{
+		for (int i = 0; i < session->windows.count(); ++i)
+		{
+			for (int j = 0; j < session->windows.at(i).windows.count(); ++j)
+			{
+				session->windows[i].windows[j] = windows.value(session->windows.at(i).windows.at(j).identifier, session->windows.at(i).windows.at(j));
+			}
+		}
+
+		return;
+	}
+
+	const QJsonArray mainWindows = layout.value(QLatin1String("windows")).toArray();
+
+	session->windows.clear();
+
+	for (int i = 0; i < mainWindows.count(); ++i)
+	{
+		const QJsonObject mainWindow = mainWindows.at(i).toObject();
+		const QJsonArray tabs = mainWindow.value(QLatin1String("tabs")).toArray();
+		SessionMainWindow sessionEntry;
+		sessionEntry.geometry = QByteArray::fromBase64(mainWindow.value(QLatin1String("geometry")).toString().toLatin1());
+		sessionEntry.index = mainWindow.value(QLatin1String("index")).toInt();
+
+		for (int j = 0; j < tabs.count(); ++j)
+		{
+			const quint64 identifier = tabs.at(j).toString().toULongLong();
+
+			if (windows.contains(identifier))
+			{
+				sessionEntry.windows.append(windows[identifier]);
+			}
+		}
+
+		session->windows.append(sessionEntry);
+	}
+}
+
 void SessionsManager::clearClosedWindows()
 {
-	m_closedWindows.clear();
+	m_closedWindows->clear();
 
 	emit m_instance->closedWindowsChanged();
 }
@@ -95,6 +619,9 @@ void SessionsManager::registerWindow(MainWindow *window)
 	if (window)
 	{
 		m_windows.append(window);
+
+		connect(window->getWindowsManager(), SIGNAL(windowAdded(qint64)), m_instance, SLOT(handleWindowsChanged()));
+		connect(window->getWindowsManager(), SIGNAL(windowRemoved(qint64)), m_instance, SLOT(handleWindowsChanged()));
 	}
 }
 
@@ -112,7 +639,7 @@ void SessionsManager::storeClosedWindow(MainWindow *window)
 
 	if (!session.windows.isEmpty())
 	{
-		m_closedWindows.prepend(session);
+		m_closedWindows->addItem(session);
 
 		emit m_instance->closedWindowsChanged();
 	}
@@ -128,6 +655,16 @@ void SessionsManager::markSessionModified()
 	}
 }
 
+void SessionsManager::markWindowModified(quint64 identifier)
+{
+	if (!m_isPrivate && m_session == QLatin1String("default"))
+	{
+		m_modifiedWindows.insert(identifier);
+
+		markSessionModified();
+	}
+}
+
 void SessionsManager::removeStoredUrl(const QString &url)
 {
 	emit m_instance->requestedRemoveStoredUrl(url);
@@ -181,13 +718,13 @@ QString SessionsManager::getSessionPath(const QString &path, bool bound)
 
 	if (cleanPath.isEmpty())
 	{
-		cleanPath = QLatin1String("default.ini");
+		cleanPath = QLatin1String("default.session");
 	}
 	else
 	{
-		if (!cleanPath.endsWith(QLatin1String(".ini")))
+		if (!cleanPath.endsWith(QLatin1String(".session")) && !cleanPath.endsWith(QLatin1String(".ini")))
 		{
-			cleanPath += QLatin1String(".ini");
+			cleanPath += QLatin1String(".session");
 		}
 
 		if (bound)
@@ -205,58 +742,228 @@ QString SessionsManager::getSessionPath(const QString &path, bool bound)
 
 SessionInformation SessionsManager::getSession(const QString &path)
 {
-	const QString sessionPath = getSessionPath(path);
-	QSettings sessionData(sessionPath, QSettings::IniFormat);
-	sessionData.setIniCodec("UTF-8");
+	QString sessionPath = getSessionPath(path);
+
+	if (!QFile::exists(sessionPath) && QFile::exists(getLegacySessionPath(sessionPath)))
+	{
+		sessionPath = getLegacySessionPath(sessionPath);
+	}
 
 	SessionInformation session;
 	session.path = path;
-	session.title = sessionData.value(QLatin1String("Session/title"), ((path == QLatin1String("default")) ? tr("Default") : tr("(Untitled)"))).toString();
-	session.index = (sessionData.value(QLatin1String("Session/index"), 1).toInt() - 1);
-	session.clean = sessionData.value(QLatin1String("Session/clean"), true).toBool();
 
-	const int windows = sessionData.value(QLatin1String("Session/windows"), 0).toInt();
-	const int defaultZoom = SettingsManager::getValue(QLatin1String("Content/DefaultZoom")).toInt();
+	QString journal;
 
-	for (int i = 1; i <= windows; ++i)
+	if (!readSession(sessionPath, &session, &journal) && QFileInfo(sessionPath).suffix() == QLatin1String("ini"))
 	{
-		const int tabs = sessionData.value(QStringLiteral("%1/Properties/windows").arg(i), 0).toInt();
-		SessionMainWindow sessionEntry;
-		sessionEntry.geometry = QByteArray::fromBase64(sessionData.value(QStringLiteral("%1/Properties/geometry").arg(i), 1).toString().toLatin1());
-		sessionEntry.index = (sessionData.value(QStringLiteral("%1/Properties/index").arg(i), 1).toInt() - 1);
+		QSettings sessionData(sessionPath, QSettings::IniFormat);
+		sessionData.setIniCodec("UTF-8");
+
+		session.title = sessionData.value(QLatin1String("Session/title")).toString();
+		session.index = (sessionData.value(QLatin1String("Session/index"), 1).toInt() - 1);
+		session.clean = sessionData.value(QLatin1String("Session/clean"), true).toBool();
 
-		for (int j = 1; j <= tabs; ++j)
+		journal = sessionData.value(QLatin1String("Session/journal")).toString();
+
+		const int windows = sessionData.value(QLatin1String("Session/windows"), 0).toInt();
+		const int defaultZoom = SettingsManager::getValue(QLatin1String("Content/DefaultZoom")).toInt();
+
+		for (int i = 1; i <= windows; ++i)
 		{
-			const int history = sessionData.value(QStringLiteral("%1/%2/Properties/history").arg(i).arg(j), 0).toInt();
-			SessionWindow sessionWindow;
-			sessionWindow.searchEngine = sessionData.value(QStringLiteral("%1/%2/Properties/searchEngine").arg(i).arg(j), QString()).toString();
-			sessionWindow.userAgent = sessionData.value(QStringLiteral("%1/%2/Properties/userAgent").arg(i).arg(j), QString()).toString();
-			sessionWindow.group = sessionData.value(QStringLiteral("%1/%2/Properties/group").arg(i).arg(j), 0).toInt();
-			sessionWindow.index = (sessionData.value(QStringLiteral("%1/%2/Properties/index").arg(i).arg(j), 1).toInt() - 1);
-			sessionWindow.reloadTime = (sessionData.value(QStringLiteral("%1/%2/Properties/reloadTime").arg(i).arg(j), -1).toInt());
-			sessionWindow.isPinned = sessionData.value(QStringLiteral("%1/%2/Properties/pinned").arg(i).arg(j), false).toBool();
+			const int tabs = sessionData.value(QStringLiteral("%1/Properties/windows").arg(i), 0).toInt();
+			SessionMainWindow sessionEntry;
+			sessionEntry.geometry = QByteArray::fromBase64(sessionData.value(QStringLiteral("%1/Properties/geometry").arg(i), 1).toString().toLatin1());
+			sessionEntry.index = (sessionData.value(QStringLiteral("%1/Properties/index").arg(i), 1).toInt() - 1);
 
-			for (int k = 1; k <= history; ++k)
+			for (int j = 1; j <= tabs; ++j)
 			{
-				const QStringList position = sessionData.value(QStringLiteral("%1/%2/History/%3/position").arg(i).arg(j).arg(k), 1).toStringList();
-				WindowHistoryEntry historyEntry;
-				historyEntry.url = sessionData.value(QStringLiteral("%1/%2/History/%3/url").arg(i).arg(j).arg(k), 0).toString();
-				historyEntry.title = sessionData.value(QStringLiteral("%1/%2/History/%3/title").arg(i).arg(j).arg(k), 1).toString();
-				historyEntry.position = QPoint(position.value(0, QString::number(0)).toInt(), position.value(1, QString::number(0)).toInt());
-				historyEntry.zoom = sessionData.value(QStringLiteral("%1/%2/History/%3/zoom").arg(i).arg(j).arg(k), defaultZoom).toInt();
-
-				sessionWindow.history.append(historyEntry);
+				const int history = sessionData.value(QStringLiteral("%1/%2/Properties/history").arg(i).arg(j), 0).toInt();
+				SessionWindow sessionWindow;
+				sessionWindow.searchEngine = sessionData.value(QStringLiteral("%1/%2/Properties/searchEngine").arg(i).arg(j), QString()).toString();
+				sessionWindow.userAgent = sessionData.value(QStringLiteral("%1/%2/Properties/userAgent").arg(i).arg(j), QString()).toString();
+				sessionWindow.group = sessionData.value(QStringLiteral("%1/%2/Properties/group").arg(i).arg(j), 0).toInt();
+				sessionWindow.index = (sessionData.value(QStringLiteral("%1/%2/Properties/index").arg(i).arg(j), 1).toInt() - 1);
+				sessionWindow.reloadTime = (sessionData.value(QStringLiteral("%1/%2/Properties/reloadTime").arg(i).arg(j), -1).toInt());
+				sessionWindow.isPinned = sessionData.value(QStringLiteral("%1/%2/Properties/pinned").arg(i).arg(j), false).toBool();
+				sessionWindow.identifier = sessionData.value(QStringLiteral("%1/%2/Properties/identifier").arg(i).arg(j), 0).toULongLong();
+
+				for (int k = 1; k <= history; ++k)
+				{
+					const QStringList position = sessionData.value(QStringLiteral("%1/%2/History/%3/position").arg(i).arg(j).arg(k), 1).toStringList();
+					WindowHistoryEntry historyEntry(defaultZoom);
+					historyEntry.url = sessionData.value(QStringLiteral("%1/%2/History/%3/url").arg(i).arg(j).arg(k), 0).toString();
+					historyEntry.title = sessionData.value(QStringLiteral("%1/%2/History/%3/title").arg(i).arg(j).arg(k), 1).toString();
+					historyEntry.position = QPoint(position.value(0, QString::number(0)).toInt(), position.value(1, QString::number(0)).toInt());
+					historyEntry.zoom = sessionData.value(QStringLiteral("%1/%2/History/%3/zoom").arg(i).arg(j).arg(k), defaultZoom).toInt();
+
+					sessionWindow.history.append(historyEntry);
+				}
+
+				sessionEntry.windows.append(sessionWindow);
 			}
 
-			sessionEntry.windows.append(sessionWindow);
+			session.windows.append(sessionEntry);
 		}
+	}
 
-		session.windows.append(sessionEntry);
+	if (session.title.isEmpty())
+	{
+		session.title = ((path == QLatin1String("default")) ? tr("Default") : tr("(Untitled)"));
+	}
+
+	if (!journal.isEmpty())
+	{
+		readJournal(getJournalPath(sessionPath), journal, &session);
 	}
 
 	return session;
 }
 
+QJsonObject SessionsManager::getJournalLayout()
+{
+	const QList<MainWindow*> windows = Application::getInstance()->getWindows();
+	QJsonArray mainWindows;
+
+	for (int i = 0; i < windows.count(); ++i)
+	{
+		WindowsManager *manager = windows.at(i)->getWindowsManager();
+		const int currentIndex = windows.at(i)->getTabBar()->currentIndex();
+		int index = currentIndex;
+		QJsonArray tabs;
+
+		for (int j = 0; j < manager->getWindowCount(); ++j)
+		{
+			Window *window = manager->getWindowByIndex(j);
+
+			if (window && !window->isPrivate())
+			{
+				tabs.append(QString::number(window->getIdentifier()));
+			}
+			else if (j < currentIndex)
+			{
+				--index;
+			}
+		}
+
+		QJsonObject mainWindow;
+		mainWindow.insert(QLatin1String("geometry"), QString::fromLatin1(windows.at(i)->saveGeometry().toBase64()));
+		mainWindow.insert(QLatin1String("index"), index);
+		mainWindow.insert(QLatin1String("tabs"), tabs);
+
+		mainWindows.append(mainWindow);
+	}
+
+	QJsonObject layout;
+	layout.insert(QLatin1String("windows"), mainWindows);
+
+	return layout;
+}
+
+QJsonObject SessionsManager::getJournalRecord(const SessionWindow &window)
+{
+	QJsonArray history;
+
+	for (int i = 0; i < window.history.count(); ++i)
+	{
+		QJsonObject entry;
+		entry.insert(QLatin1String("url"), window.history.at(i).url);
+		entry.insert(QLatin1String("title"), window.history.at(i).title);
+		entry.insert(QLatin1String("position"), QStringLiteral("%1,%2").arg(window.history.at(i).position.x()).arg(window.history.at(i).position.y()));
+		entry.insert(QLatin1String("zoom"), window.history.at(i).zoom);
+
+		history.append(entry);
+	}
+
+	QJsonObject record;
+	record.insert(QLatin1String("identifier"), QString::number(window.identifier));
+	record.insert(QLatin1String("searchEngine"), window.searchEngine);
+	record.insert(QLatin1String("userAgent"), window.userAgent);
+	record.insert(QLatin1String("group"), window.group);
+	record.insert(QLatin1String("index"), window.index);
+	record.insert(QLatin1String("reloadTime"), window.reloadTime);
+	record.insert(QLatin1String("pinned"), window.isPinned);
+	record.insert(QLatin1String("history"), history);
+
+	return record;
+}
+
+SessionWindow SessionsManager::getJournalWindow(const QJsonObject &object, int defaultZoom)
+{
+	const QJsonArray history = object.value(QLatin1String("history")).toArray();
+	SessionWindow window;
+	window.identifier = object.value(QLatin1String("identifier")).toString().toULongLong();
+	window.searchEngine = object.value(QLatin1String("searchEngine")).toString();
+	window.userAgent = object.value(QLatin1String("userAgent")).toString();
+	window.group = object.value(QLatin1String("group")).toInt();
+	window.index = object.value(QLatin1String("index")).toInt(-1);
+	window.reloadTime = object.value(QLatin1String("reloadTime")).toInt(-1);
+	window.isPinned = object.value(QLatin1String("pinned")).toBool();
+
+	for (int i = 0; i < history.count(); ++i)
+	{
+		const QJsonObject entry = history.at(i).toObject();
+		const QStringList position = entry.value(QLatin1String("position")).toString().split(QLatin1Char(','));
+		WindowHistoryEntry historyEntry(defaultZoom);
+		historyEntry.url = entry.value(QLatin1String("url")).toString();
+		historyEntry.title = entry.value(QLatin1String("title")).toString();
+		historyEntry.position = QPoint(position.value(0, QString::number(0)).toInt(), position.value(1, QString::number(0)).toInt());
+		historyEntry.zoom = entry.value(QLatin1String("zoom")).toInt(defaultZoom);
+
+		window.history.append(historyEntry);
+	}
+
+	return window;
+}
+
+QString SessionsManager::getJournalPath(const QString &path)
+{
+	return path.left(path.length() - QFileInfo(path).suffix().length()) + QLatin1String("journal");
+}
+
+QString SessionsManager::getLegacySessionPath(const QString &path)
+{
+	return path.left(path.length() - QFileInfo(path).suffix().length()) + QLatin1String("ini");
+}
+
+QString SessionsManager::getSessionTitle(const QString &path)
+{
+	QString sessionPath = path;
+
+	if (!QFile::exists(sessionPath) && QFile::exists(getLegacySessionPath(sessionPath)))
+	{
+		sessionPath = getLegacySessionPath(sessionPath);
+	}
+
+	QFile file(sessionPath);
+
+	if (file.open(QIODevice::ReadOnly))
+	{
+		QDataStream stream(&file);
+		stream.setVersion(QDataStream::Qt_5_2);
+
+		quint32 magic = 0;
+		quint16 version = 0;
+		QString title;
+
+		stream >> magic >> version;
+
+		if (magic == m_sessionMagic)
+		{
+			if (version == m_sessionVersion)
+			{
+				stream >> title;
+			}
+
+			return title;
+		}
+	}
+
+	QSettings sessionData(sessionPath, QSettings::IniFormat);
+	sessionData.setIniCodec("UTF-8");
+
+	return sessionData.value(QLatin1String("Session/title")).toString();
+}
+
 QList<MainWindow*> SessionsManager::getWindows()
 {
 	return m_windows;
@@ -266,10 +973,9 @@ QStringList SessionsManager::getClosedWindows()
 {
 	QStringList closedWindows;
 
-	for (int i = 0; i < m_closedWindows.count(); ++i)
+	for (int i = 0; i < m_closedWindows->count(); ++i)
 	{
-		const SessionMainWindow window = m_closedWindows.at(i);
-		const QString title = window.windows.value(window.index, SessionWindow()).getTitle();
+		const QString title = m_closedWindows->getItem(i).title;
 
 		closedWindows.append(title.isEmpty() ? tr("(Untitled)") : title);
 	}
@@ -279,13 +985,15 @@ QStringList SessionsManager::getClosedWindows()
 
 QStringList SessionsManager::getSessions()
 {
-	QStringList entries = QDir(m_profilePath + QLatin1String("/sessions/")).entryList(QStringList(QLatin1String("*.ini")), QDir::Files);
+	QStringList entries = QDir(m_profilePath + QLatin1String("/sessions/")).entryList(QStringList(QLatin1String("*.session")) << QLatin1String("*.ini"), QDir::Files);
 
 	for (int i = 0; i < entries.count(); ++i)
 	{
 		entries[i] = QFileInfo(entries.at(i)).completeBaseName();
 	}
 
+	entries.removeDuplicates();
+
 	if (!m_session.isEmpty() && !entries.contains(m_session))
 	{
 		entries.append(m_session);
@@ -308,9 +1016,7 @@ bool SessionsManager::restoreClosedWindow(int index)
 		index = 0;
 	}
 
-	Application::getInstance()->createWindow(false, false, m_closedWindows.value(index, SessionMainWindow()));
-
-	m_closedWindows.removeAt(index);
+	Application::getInstance()->createWindow(false, false, m_closedWindows->takeItem(index));
 
 	emit m_instance->closedWindowsChanged();
 
@@ -372,107 +1078,282 @@ bool SessionsManager::saveSession(const QString &path, const QString &title, Mai
 		return false;
 	}
 
-	QDir().mkpath(m_profilePath + QLatin1String("/sessions/"));
-
 	const QString sessionPath = getSessionPath(path);
-	QString sessionTitle = title;
+	SessionInformation session;
+	session.path = path;
+	session.title = title;
+	session.index = 0;
+	session.clean = clean;
 
 	if (title.isEmpty())
 	{
-		QSettings sessionData(sessionPath, QSettings::IniFormat);
-		sessionData.setIniCodec("UTF-8");
+		session.title = getSessionTitle(sessionPath);
+	}
+
+	for (int i = 0; i < windows.count(); ++i)
+	{
+		SessionMainWindow sessionEntry = windows.at(i)->getWindowsManager()->getSession();
+		sessionEntry.geometry = windows.at(i)->saveGeometry();
+
+		session.windows.append(sessionEntry);
+	}
+
+	const bool isDefault = (sessionPath == getSessionPath(QLatin1String("default")));
 
-		sessionTitle = sessionData.value(QLatin1String("Session/title")).toString();;
+	if (isDefault && m_compactionWatcher)
+	{
+		m_compactionWatcher->waitForFinished();
+
+		delete m_compactionWatcher;
+
+		m_compactionWatcher = NULL;
+	}
+
+	if (!writeSession(sessionPath, session, QString(), SettingsManager::getValue(QLatin1String("Search/DefaultSearchEngine")).toString(), SettingsManager::getValue(QLatin1String("Network/UserAgent")).toString()))
+	{
+		return false;
+	}
+
+	if (isDefault)
+	{
+		QFile::remove(getJournalPath(sessionPath));
+
+		m_journalToken.clear();
+		m_journalSize = 0;
+	}
+
+	return true;
+}
+
+bool SessionsManager::writeSession(const QString &path, const SessionInformation &session, const QString &journal, const QString &defaultSearchEngine, const QString &defaultUserAgent)
+{
+	SessionRecordWriter writer(defaultSearchEngine, defaultUserAgent);
+	QByteArray windowsData;
+	QDataStream windowsStream(&windowsData, QIODevice::WriteOnly);
+	windowsStream.setVersion(QDataStream::Qt_5_2);
+	windowsStream << quint32(session.windows.count());
+
+	for (int i = 0; i < session.windows.count(); ++i)
+	{
+		writer.writeWindow(windowsStream, session.windows.at(i));
 	}
 
-	QSaveFile file(sessionPath);
+	QDir().mkpath(QFileInfo(path).absolutePath());
+
+	QSaveFile file(path);
 
 	if (!file.open(QIODevice::WriteOnly))
 	{
 		return false;
 	}
 
-	const QString defaultSearchEngine = SettingsManager::getValue(QLatin1String("Search/DefaultSearchEngine")).toString();
-	const QString defaultUserAgent = SettingsManager::getValue(QLatin1String("Network/UserAgent")).toString();
-	QTextStream stream(&file);
-	stream.setCodec("UTF-8");
-	stream << QLatin1String("[Session]\n");
-	stream << Utils::formatConfigurationEntry(QLatin1String("title"), sessionTitle, true);
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_2);
+	stream << m_sessionMagic << m_sessionVersion;
+	stream << session.title << journal << session.clean << qint32(session.index);
+
+	writer.writeStrings(stream);
+
+	stream.writeRawData(windowsData.constData(), windowsData.size());
 
-	if (!clean)
+	if (stream.status() != QDataStream::Ok || !file.commit())
 	{
-		stream << QLatin1String("clean=false\n");
+		return false;
 	}
 
-	stream << QLatin1String("windows=") << windows.count() << QLatin1Char('\n');
-	stream << QLatin1String("index=1\n\n");
+	if (QFileInfo(path).suffix() == QLatin1String("session"))
+	{
+		QFile::remove(getLegacySessionPath(path));
+	}
 
-	for (int i = 0; i < windows.count(); ++i)
+	return true;
+}
+
+bool SessionsManager::readSession(const QString &path, SessionInformation *session, QString *journal)
+{
+	QFile file(path);
+
+	if (!file.open(QIODevice::ReadOnly))
 	{
-		const SessionMainWindow sessionEntry = windows.at(i)->getWindowsManager()->getSession();
+		return false;
+	}
 
-		stream << QStringLiteral("[%1/Properties]\n").arg(i + 1);
-		stream << Utils::formatConfigurationEntry(QLatin1String("geometry"), windows.at(i)->saveGeometry().toBase64(), true);
-		stream << QLatin1String("groups=0\n");
-		stream << QLatin1String("windows=") << sessionEntry.windows.count() << QLatin1Char('\n');
-		stream << QLatin1String("index=") << (sessionEntry.index + 1) << QLatin1String("\n\n");
+	const QByteArray data = file.readAll();
+	QDataStream stream(data);
+	stream.setVersion(QDataStream::Qt_5_2);
 
-		for (int j = 0; j < sessionEntry.windows.count(); ++j)
-		{
-			stream << QStringLiteral("[%1/%2/Properties]\n").arg(i + 1).arg(j + 1);
+	quint32 magic = 0;
+	quint16 version = 0;
 
-			if (sessionEntry.windows.at(j).searchEngine != defaultSearchEngine)
-			{
-				stream << Utils::formatConfigurationEntry(QLatin1String("searchEngine"), sessionEntry.windows.at(j).searchEngine);
-			}
+	stream >> magic >> version;
 
-			if (sessionEntry.windows.at(j).userAgent != defaultUserAgent)
-			{
-				stream << Utils::formatConfigurationEntry(QLatin1String("userAgent"), sessionEntry.windows.at(j).userAgent, true);
-			}
+	if (magic != m_sessionMagic)
+	{
+		return false;
+	}
 
-			if (sessionEntry.windows.at(j).reloadTime != -1)
-			{
-				stream << Utils::formatConfigurationEntry(QLatin1String("reloadTime"), QString::number(sessionEntry.windows.at(j).reloadTime));
-			}
+	if (version != m_sessionVersion)
+	{
+		backupSession(path);
 
-			if (sessionEntry.windows.at(j).isPinned)
-			{
-				stream << QLatin1String("pinned=true\n");
-			}
+		return false;
+	}
 
-			stream << QLatin1String("history=") << sessionEntry.windows.at(j).history.count() << QLatin1Char('\n');
-			stream << QLatin1String("index=") << (sessionEntry.windows.at(j).index + 1) << QLatin1String("\n\n");
+	qint32 index = 0;
+	quint32 amount = 0;
 
-			for (int k = 0; k < sessionEntry.windows.at(j).history.count(); ++k)
-			{
-				stream << QStringLiteral("[%1/%2/History/%3]\n").arg(i + 1).arg(j + 1).arg(k + 1);
-				stream << Utils::formatConfigurationEntry(QLatin1String("url"), sessionEntry.windows.at(j).history.at(k).url, true);
-				stream << Utils::formatConfigurationEntry(QLatin1String("title"), sessionEntry.windows.at(j).history.at(k).title, true);
-				stream << QLatin1String("position=") << sessionEntry.windows.at(j).history.at(k).position.x() << ',' << sessionEntry.windows.at(j).history.at(k).position.y() << QLatin1Char('\n');
-				stream << QLatin1String("zoom=") << sessionEntry.windows.at(j).history.at(k).zoom << QLatin1String("\n\n");
-			}
+	stream >> session->title >> *journal >> session->clean >> index;
+
+	session->index = index;
+
+	const QVector<QString> strings = SessionRecordReader::readStrings(stream);
+	QList<QByteArray> records;
+	QList<int> tabs;
+
+	stream >> amount;
+
+	for (quint32 i = 0; (i < amount && stream.status() == QDataStream::Ok); ++i)
+	{
+		SessionMainWindow sessionEntry;
+
+		tabs.append(SessionRecordReader::readWindow(stream, &sessionEntry, &records));
+
+		session->windows.append(sessionEntry);
+	}
+
+	if (stream.status() != QDataStream::Ok)
+	{
+		session->title.clear();
+		session->windows.clear();
+		session->index = 0;
+
+		journal->clear();
+
+		backupSession(path);
+
+		return false;
+	}
+
+// records are self-contained apart from strings table, so bigger sessions are decoded in parallel
+	const SessionRecordReader reader(strings, SettingsManager::getValue(QLatin1String("Content/DefaultZoom")).toInt());
+	QList<SessionWindow> windows;
+
+	if (records.count() > 50)
+	{
+		windows = QtConcurrent::blockingMapped<QList<SessionWindow> >(records, reader);
+	}
+	else
+	{
+		for (int i = 0; i < records.count(); ++i)
+		{
+			windows.append(reader(records.at(i)));
 		}
 	}
 
-	return file.commit();
+	int offset = 0;
+
+	for (int i = 0; i < session->windows.count(); ++i)
+	{
+		session->windows[i].windows = windows.mid(offset, tabs.at(i));
+
+		offset += tabs.at(i);
+	}
+
+	return true;
+}
+
+QByteArray SessionsManager::serializeWindow(const SessionMainWindow &window)
+{
+	SessionRecordWriter writer;
+	QByteArray windowData;
+	QDataStream windowStream(&windowData, QIODevice::WriteOnly);
+	windowStream.setVersion(QDataStream::Qt_5_2);
+
+	writer.writeWindow(windowStream, window);
+
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_2);
+
+	writer.writeStrings(stream);
+
+	stream.writeRawData(windowData.constData(), windowData.size());
+
+	return data;
+}
+
+SessionMainWindow SessionsManager::deserializeWindow(const QByteArray &data)
+{
+	SessionMainWindow window;
+
+	if (data.isEmpty())
+	{
+		return window;
+	}
+
+	QDataStream stream(data);
+	stream.setVersion(QDataStream::Qt_5_2);
+
+	const SessionRecordReader reader(SessionRecordReader::readStrings(stream), SettingsManager::getValue(QLatin1String("Content/DefaultZoom")).toInt());
+	QList<QByteArray> records;
+
+	SessionRecordReader::readWindow(stream, &window, &records);
+
+	for (int i = 0; (i < records.count() && stream.status() == QDataStream::Ok); ++i)
+	{
+		window.windows.append(reader(records.at(i)));
+	}
+
+	return window;
+}
+
+void SessionsManager::backupSession(const QString &path)
+{
+// session written by newer version or damaged one would be replaced by next save, so its copy is kept
+	const QString backupPath = path + QLatin1String(".bak");
+
+	QFile::remove(backupPath);
+	QFile::copy(path, backupPath);
+
+	Console::addMessage(tr("Failed to read session, its copy was saved as %1").arg(QDir::toNativeSeparators(backupPath)), OtherMessageCategory, ErrorMessageLevel, path);
 }
 
 bool SessionsManager::deleteSession(const QString &path)
 {
 	const QString cleanPath = getSessionPath(path, true);
+	const QString legacyPath = getLegacySessionPath(cleanPath);
+	bool result = false;
+
+	QFile::remove(getJournalPath(cleanPath));
+
+	if (QFile::exists(legacyPath))
+	{
+		result = QFile::remove(legacyPath);
+	}
 
 	if (QFile::exists(cleanPath))
 	{
-		return QFile::remove(cleanPath);
+		result = QFile::remove(cleanPath);
 	}
 
-	return false;
+	return result;
 }
 
 bool SessionsManager::moveSession(const QString &from, const QString &to)
 {
-	return QFile::rename(getSessionPath(from), getSessionPath(to));
+	const QString sessionPath = getSessionPath(from);
+
+	if (QFile::exists(getJournalPath(sessionPath)))
+	{
+		QFile::rename(getJournalPath(sessionPath), getJournalPath(getSessionPath(to)));
+	}
+
+	if (!QFile::exists(sessionPath) && QFile::exists(getLegacySessionPath(sessionPath)))
+	{
+		return QFile::rename(getLegacySessionPath(sessionPath), getLegacySessionPath(getSessionPath(to)));
+	}
+
+	return QFile::rename(sessionPath, getSessionPath(to));
 }
 
 bool SessionsManager::isLastWindow()
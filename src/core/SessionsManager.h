@@ -23,8 +23,11 @@
 #include "SettingsManager.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QJsonObject>
 #include <QtCore/QPoint>
 #include <QtCore/QPointer>
+#include <QtCore/QSet>
 
 namespace Otter
 {
@@ -37,6 +40,7 @@ struct WindowHistoryEntry
 	int zoom;
 
 	WindowHistoryEntry() : zoom(SettingsManager::getValue(QLatin1String("Content/DefaultZoom")).toInt()) {}
+	explicit WindowHistoryEntry(int zoomValue) : zoom(zoomValue) {}
 };
 
 struct WindowHistoryInformation
@@ -52,12 +56,13 @@ struct SessionWindow
 	QString searchEngine;
 	QString userAgent;
 	QList<WindowHistoryEntry> history;
+	quint64 identifier;
 	int group;
 	int index;
 	int reloadTime;
 	bool isPinned;
 
-	SessionWindow() : group(0), index(-1), reloadTime(-1), isPinned(false) {}
+	SessionWindow() : identifier(0), group(0), index(-1), reloadTime(-1), isPinned(false) {}
 
 	QString getUrl() const
 	{
@@ -110,6 +115,7 @@ struct SessionInformation
 	SessionInformation() : index(-1), clean(true) {}
 };
 
+class ClosedItemsStore;
 class MainWindow;
 class WindowsManager;
 
@@ -123,6 +129,7 @@ public:
 	static void registerWindow(MainWindow *window);
 	static void storeClosedWindow(MainWindow *window);
 	static void markSessionModified();
+	static void markWindowModified(quint64 identifier);
 	static void removeStoredUrl(const QString &url);
 	static void setActiveWindow(MainWindow *window);
 	static SessionsManager* getInstance();
@@ -134,6 +141,8 @@ public:
 	static QString getWritableDataPath(const QString &path);
 	static QString getSessionPath(const QString &path, bool bound = false);
 	static SessionInformation getSession(const QString &path);
+	static SessionMainWindow deserializeWindow(const QByteArray &data);
+	static QByteArray serializeWindow(const SessionMainWindow &window);
 	static QStringList getClosedWindows();
 	static QStringList getSessions();
 	static QList<MainWindow*> getWindows();
@@ -148,9 +157,26 @@ public:
 
 protected:
 	explicit SessionsManager(QObject *parent = NULL);
+	~SessionsManager();
 
 	void timerEvent(QTimerEvent *event);
 	void scheduleSave();
+	void saveJournal();
+	void compactJournal();
+	static void readJournal(const QString &path, const QString &token, SessionInformation *session);
+	static void backupSession(const QString &path);
+	static QJsonObject getJournalLayout();
+	static QJsonObject getJournalRecord(const SessionWindow &window);
+	static SessionWindow getJournalWindow(const QJsonObject &object, int defaultZoom);
+	static QString getJournalPath(const QString &path);
+	static QString getLegacySessionPath(const QString &path);
+	static QString getSessionTitle(const QString &path);
+	static bool readSession(const QString &path, SessionInformation *session, QString *journal);
+	static bool writeSession(const QString &path, const SessionInformation &session, const QString &journal, const QString &defaultSearchEngine, const QString &defaultUserAgent);
+
+protected slots:
+	void handleWindowsChanged();
+	void handleCompactionFinished();
 
 private:
 	int m_saveTimer;
@@ -161,7 +187,17 @@ private:
 	static QString m_cachePath;
 	static QString m_profilePath;
 	static QList<MainWindow*> m_windows;
-	static QList<SessionMainWindow> m_closedWindows;
+	static ClosedItemsStore *m_closedWindows;
+	static QFutureWatcher<bool> *m_compactionWatcher;
+	static QString m_journalTitle;
+	static QString m_journalToken;
+	static QJsonObject m_journalLayout;
+	static QHash<quint64, SessionWindow> m_journalWindows;
+	static QSet<quint64> m_modifiedWindows;
+	static qint64 m_journalSize;
+	static const qint64 m_journalLimit;
+	static const quint32 m_sessionMagic;
+	static const quint16 m_sessionVersion;
 	static bool m_isDirty;
 	static bool m_isPrivate;
 
@@ -19,6 +19,7 @@
 **************************************************************************/
 
 #include "SettingsManager.h"
+#include "options.h"
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QSettings>
@@ -100,9 +101,65 @@ SettingsManager* SettingsManager::getInstance()
 	return m_instance;
 }
 
+QString SettingsManager::getOptionType(const QString &key)
+{
+	const int index = findOption(key);
+
+	return ((index < 0) ? QString(QLatin1String("string")) : QString(QLatin1String(optionDefinitions[index].typeName)));
+}
+
+QStringList SettingsManager::getOptions()
+{
+	QStringList options;
+	options.reserve(optionDefinitionsAmount);
+
+	for (int i = 0; i < optionDefinitionsAmount; ++i)
+	{
+		options.append(QLatin1String(optionDefinitions[i].key));
+	}
+
+	return options;
+}
+
+QStringList SettingsManager::getOptionChoices(const QString &key)
+{
+	const int index = findOption(key);
+
+	if (index < 0 || !optionDefinitions[index].choices)
+	{
+		return QStringList();
+	}
+
+	return QString(QLatin1String(optionDefinitions[index].choices)).split(QLatin1Char(','));
+}
+
 QVariant SettingsManager::getDefaultValue(const QString &key)
 {
-	return m_defaults[key];
+	if (m_defaults.contains(key))
+	{
+		return m_defaults[key];
+	}
+
+	const int index = findOption(key);
+
+	if (index < 0)
+	{
+		return QVariant();
+	}
+
+	const OptionDefinition &definition = optionDefinitions[index];
+
+	switch (definition.type)
+	{
+		case BoolOptionValue:
+			return QVariant(definition.number != 0);
+		case IntegerOptionValue:
+			return QVariant(definition.number);
+		case ListOptionValue:
+			return QVariant(QString(QLatin1String(definition.text)).split(QLatin1Char(',')));
+		default:
+			return QVariant(QString(QLatin1String(definition.text)));
+	}
 }
 
 QVariant SettingsManager::getValue(const QString &key, const QUrl &url)
@@ -127,4 +184,52 @@ bool SettingsManager::hasOverride(const QUrl &url, const QString &key)
 	}
 }
 
+bool SettingsManager::isDefaultValue(const QString &key, const QVariant &value)
+{
+	const QVariant defaultValue = getDefaultValue(key);
+
+// values read back from INI files are strings, so compare them as type of option
+	switch (defaultValue.type())
+	{
+		case QVariant::Bool:
+			return (value.toBool() == defaultValue.toBool());
+		case QVariant::Int:
+			return (value.toInt() == defaultValue.toInt());
+		case QVariant::StringList:
+			return (value.toStringList() == defaultValue.toStringList());
+		case QVariant::Invalid:
+			return value.isNull();
+		default:
+			return (value.toString() == defaultValue.toString());
+	}
+}
+
+int SettingsManager::findOption(const QString &key)
+{
+	int begin = 0;
+	int end = (optionDefinitionsAmount - 1);
+
+	while (begin <= end)
+	{
+		const int middle = ((begin + end) / 2);
+		const int result = key.compare(QLatin1String(optionDefinitions[middle].key));
+
+		if (result == 0)
+		{
+			return middle;
+		}
+
+		if (result < 0)
+		{
+			end = (middle - 1);
+		}
+		else
+		{
+			begin = (middle + 1);
+		}
+	}
+
+	return -1;
+}
+
 }
@@ -22,6 +22,7 @@
 #define OTTER_SETTINGSMANAGER_H
 
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
 #include <QtCore/QUrl>
 #include <QtCore/QVariant>
 
@@ -39,13 +40,19 @@ public:
 	static void setDefaultValue(const QString &key, const QVariant &value);
 	static void setValue(const QString &key, const QVariant &value, const QUrl &url = QUrl());
 	static SettingsManager* getInstance();
+	static QString getOptionType(const QString &key);
+	static QStringList getOptions();
+	static QStringList getOptionChoices(const QString &key);
 	static QVariant getDefaultValue(const QString &key);
 	static QVariant getValue(const QString &key, const QUrl &url = QUrl());
 	static bool hasOverride(const QUrl &url, const QString &key = QString());
+	static bool isDefaultValue(const QString &key, const QVariant &value);
 
 protected:
 	explicit SettingsManager(QObject *parent = NULL);
 
+	static int findOption(const QString &key);
+
 private:
 	static SettingsManager *m_instance;
 	static QString m_globalPath;
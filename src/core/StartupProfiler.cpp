@@ -0,0 +1,181 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "StartupProfiler.h"
+#include "Console.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+namespace Otter
+{
+
+QElapsedTimer StartupProfiler::m_timer;
+QString StartupProfiler::m_path;
+QVector<StartupPhase> StartupProfiler::m_phases;
+QVector<int> StartupProfiler::m_activePhases;
+bool StartupProfiler::m_isFinished = false;
+
+void StartupProfiler::start()
+{
+	if (!m_timer.isValid())
+	{
+		m_timer.start();
+	}
+}
+
+void StartupProfiler::beginPhase(const QString &name)
+{
+	if (m_isFinished || !m_timer.isValid())
+	{
+		return;
+	}
+
+	StartupPhase phase;
+	phase.name = name;
+	phase.startTime = m_timer.nsecsElapsed();
+	phase.depth = m_activePhases.count();
+
+	m_activePhases.append(m_phases.count());
+	m_phases.append(phase);
+}
+
+void StartupProfiler::endPhase()
+{
+	if (m_isFinished || m_activePhases.isEmpty())
+	{
+		return;
+	}
+
+	const int index = m_activePhases.last();
+
+	m_activePhases.removeLast();
+
+	m_phases[index].duration = (m_timer.nsecsElapsed() - m_phases.at(index).startTime);
+}
+
+void StartupProfiler::markEvent(const QString &name)
+{
+	if (m_isFinished || !m_timer.isValid())
+	{
+		return;
+	}
+
+	StartupPhase phase;
+	phase.name = name;
+	phase.startTime = m_timer.nsecsElapsed();
+	phase.depth = m_activePhases.count();
+
+	m_phases.append(phase);
+}
+
+void StartupProfiler::finish()
+{
+	if (m_isFinished)
+	{
+		return;
+	}
+
+	m_isFinished = true;
+
+	const qint64 firstWindowTime = getEventTime(QLatin1String("First window"));
+
+	if (firstWindowTime >= 0)
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Startup took %1 ms to first window, %2 ms to first paint and %3 ms to full initialization").arg(firstWindowTime / 1000000).arg(getEventTime(QLatin1String("First paint")) / 1000000).arg(m_timer.nsecsElapsed() / 1000000), OtherMessageCategory, LogMessageLevel);
+	}
+
+	if (m_path.isEmpty())
+	{
+		m_phases.clear();
+		m_activePhases.clear();
+
+		return;
+	}
+
+// uses Trace Event Format, so output can be inspected in chrome://tracing or similar tools
+	QJsonArray events;
+
+	for (int i = 0; i < m_phases.count(); ++i)
+	{
+		const StartupPhase &phase = m_phases.at(i);
+		QJsonObject event;
+		event.insert(QLatin1String("name"), phase.name);
+		event.insert(QLatin1String("cat"), QLatin1String("startup"));
+		event.insert(QLatin1String("ph"), ((phase.duration < 0) ? QLatin1String("i") : QLatin1String("X")));
+		event.insert(QLatin1String("ts"), (phase.startTime / 1000.0));
+		event.insert(QLatin1String("pid"), 1);
+		event.insert(QLatin1String("tid"), 1);
+
+		if (phase.duration < 0)
+		{
+			event.insert(QLatin1String("s"), QLatin1String("g"));
+		}
+		else
+		{
+			event.insert(QLatin1String("dur"), (phase.duration / 1000.0));
+		}
+
+		events.append(event);
+	}
+
+	QJsonObject summary;
+	summary.insert(QLatin1String("timeToFirstWindow"), (getEventTime(QLatin1String("First window")) / 1000000.0));
+	summary.insert(QLatin1String("timeToFirstPaint"), (getEventTime(QLatin1String("First paint")) / 1000000.0));
+	summary.insert(QLatin1String("timeToFullInitialization"), (m_timer.nsecsElapsed() / 1000000.0));
+
+	QJsonObject trace;
+	trace.insert(QLatin1String("traceEvents"), events);
+	trace.insert(QLatin1String("displayTimeUnit"), QLatin1String("ms"));
+	trace.insert(QLatin1String("otherData"), summary);
+
+	QFile file(m_path);
+
+	if (file.open(QIODevice::WriteOnly))
+	{
+		file.write(QJsonDocument(trace).toJson());
+		file.close();
+	}
+
+	m_phases.clear();
+	m_activePhases.clear();
+}
+
+void StartupProfiler::setPath(const QString &path)
+{
+	m_path = path;
+}
+
+qint64 StartupProfiler::getEventTime(const QString &name)
+{
+	for (int i = 0; i < m_phases.count(); ++i)
+	{
+		if (m_phases.at(i).duration < 0 && m_phases.at(i).name == name)
+		{
+			return m_phases.at(i).startTime;
+		}
+	}
+
+	return -1;
+}
+
+}
@@ -0,0 +1,61 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_STARTUPPROFILER_H
+#define OTTER_STARTUPPROFILER_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+namespace Otter
+{
+
+struct StartupPhase
+{
+	QString name;
+	qint64 startTime;
+	qint64 duration;
+	int depth;
+
+	StartupPhase() : startTime(0), duration(-1), depth(0) {}
+};
+
+class StartupProfiler
+{
+public:
+	static void start();
+	static void beginPhase(const QString &name);
+	static void endPhase();
+	static void markEvent(const QString &name);
+	static void finish();
+	static void setPath(const QString &path);
+	static qint64 getEventTime(const QString &name);
+
+private:
+	static QElapsedTimer m_timer;
+	static QString m_path;
+	static QVector<StartupPhase> m_phases;
+	static QVector<int> m_activePhases;
+	static bool m_isFinished;
+};
+
+}
+
+#endif
@@ -0,0 +1,233 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "ThumbnailsManager.h"
+#include "SessionsManager.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+namespace Otter
+{
+
+ThumbnailsManager* ThumbnailsManager::m_instance = NULL;
+const QSize ThumbnailsManager::m_thumbnailSize = QSize(260, 170);
+
+ThumbnailsManager::ThumbnailsManager(QObject *parent) : QObject(parent)
+{
+	m_thumbnails.setMaxCost(8192);
+
+// identifiers of windows are only valid for current run, so thumbnails left behind by previous one are useless
+	QDir(SessionsManager::getCachePath() + QLatin1String("/thumbnails/")).removeRecursively();
+}
+
+void ThumbnailsManager::createInstance(QObject *parent)
+{
+	if (!m_instance)
+	{
+		m_instance = new ThumbnailsManager(parent);
+	}
+}
+
+void ThumbnailsManager::updateThumbnail(quint64 identifier, const QImage &image)
+{
+	if (!m_instance || image.isNull())
+	{
+		return;
+	}
+
+	QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(m_instance);
+
+	m_instance->m_watchers.insert(watcher, identifier);
+
+	connect(watcher, SIGNAL(finished()), m_instance, SLOT(handleThumbnailScaled()));
+
+	watcher->setFuture(QtConcurrent::run(&ThumbnailsManager::scaleThumbnail, image));
+}
+
+void ThumbnailsManager::storeThumbnail(quint64 identifier)
+{
+	if (!m_instance || !m_instance->m_thumbnails.contains(identifier))
+	{
+		return;
+	}
+
+	QDir().mkpath(SessionsManager::getCachePath() + QLatin1String("/thumbnails/"));
+
+	const QImage image = *m_instance->m_thumbnails.object(identifier);
+	QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(m_instance);
+
+// image stays in memory until it is written, otherwise it could not be found in the meantime
+	m_instance->m_storedThumbnails[identifier] = image;
+	m_instance->m_writers.insert(watcher, identifier);
+	m_instance->m_thumbnails.remove(identifier);
+
+	connect(watcher, SIGNAL(finished()), m_instance, SLOT(handleThumbnailStored()));
+
+	watcher->setFuture(QtConcurrent::run(&ThumbnailsManager::writeThumbnail, image, getThumbnailPath(identifier)));
+}
+
+void ThumbnailsManager::removeThumbnail(quint64 identifier)
+{
+	if (!m_instance)
+	{
+		return;
+	}
+
+	m_instance->m_thumbnails.remove(identifier);
+	m_instance->m_storedThumbnails.remove(identifier);
+
+	const QString path = getThumbnailPath(identifier);
+
+	if (QFile::exists(path))
+	{
+		QFile::remove(path);
+	}
+}
+
+void ThumbnailsManager::handleThumbnailScaled()
+{
+	QFutureWatcher<QImage> *watcher = static_cast<QFutureWatcher<QImage>*>(sender());
+
+	if (!watcher || !m_watchers.contains(watcher))
+	{
+		return;
+	}
+
+	const quint64 identifier = m_watchers.take(watcher);
+	const QImage image = watcher->result();
+
+	watcher->deleteLater();
+
+	if (image.isNull())
+	{
+		return;
+	}
+
+	m_thumbnails.insert(identifier, new QImage(image), qMax(1, (image.byteCount() / 1024)));
+
+	emit thumbnailChanged(identifier);
+}
+
+void ThumbnailsManager::handleThumbnailStored()
+{
+	QFutureWatcher<bool> *watcher = static_cast<QFutureWatcher<bool>*>(sender());
+
+	if (!watcher || !m_writers.contains(watcher))
+	{
+		return;
+	}
+
+	const quint64 identifier = m_writers.take(watcher);
+	const bool isWritten = watcher->result();
+
+	watcher->deleteLater();
+
+// thumbnail was removed while it was being written
+	if (!m_storedThumbnails.contains(identifier))
+	{
+		QFile::remove(getThumbnailPath(identifier));
+
+		return;
+	}
+
+// image is kept if it could not be written, so thumbnail is still available
+	if (isWritten && !m_writers.values().contains(identifier))
+	{
+		m_storedThumbnails.remove(identifier);
+	}
+}
+
+ThumbnailsManager* ThumbnailsManager::getInstance()
+{
+	return m_instance;
+}
+
+QImage ThumbnailsManager::scaleThumbnail(const QImage &image)
+{
+	QImage thumbnail = image;
+
+	if (thumbnail.width() > (m_thumbnailSize.width() * 2))
+	{
+		thumbnail = thumbnail.scaledToWidth((m_thumbnailSize.width() * 2), Qt::FastTransformation);
+	}
+
+	thumbnail = thumbnail.copy(0, 0, thumbnail.width(), qMin(thumbnail.height(), qRound(thumbnail.width() * (qreal(m_thumbnailSize.height()) / m_thumbnailSize.width()))));
+
+	return thumbnail.scaled(m_thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+
+QString ThumbnailsManager::getThumbnailPath(quint64 identifier)
+{
+	return SessionsManager::getCachePath() + QStringLiteral("/thumbnails/%1.png").arg(identifier);
+}
+
+QPixmap ThumbnailsManager::getThumbnail(quint64 identifier)
+{
+	if (!m_instance)
+	{
+		return QPixmap();
+	}
+
+	QImage *thumbnail = m_instance->m_thumbnails.object(identifier);
+
+	if (thumbnail)
+	{
+		return QPixmap::fromImage(*thumbnail);
+	}
+
+	if (m_instance->m_storedThumbnails.contains(identifier))
+	{
+		return QPixmap::fromImage(m_instance->m_storedThumbnails[identifier]);
+	}
+
+	const QString path = getThumbnailPath(identifier);
+
+	if (!QFile::exists(path))
+	{
+		return QPixmap();
+	}
+
+	const QImage image(path);
+
+	if (image.isNull())
+	{
+		return QPixmap();
+	}
+
+	m_instance->m_thumbnails.insert(identifier, new QImage(image), qMax(1, (image.byteCount() / 1024)));
+
+	return QPixmap::fromImage(image);
+}
+
+bool ThumbnailsManager::writeThumbnail(const QImage &image, const QString &path)
+{
+	QSaveFile file(path);
+
+	if (!file.open(QIODevice::WriteOnly) || !image.save(&file, "PNG"))
+	{
+		return false;
+	}
+
+	return file.commit();
+}
+
+}
@@ -0,0 +1,70 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_THUMBNAILSMANAGER_H
+#define OTTER_THUMBNAILSMANAGER_H
+
+#include <QtCore/QCache>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QObject>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+
+namespace Otter
+{
+
+class ThumbnailsManager : public QObject
+{
+	Q_OBJECT
+
+public:
+	static void createInstance(QObject *parent = NULL);
+	static void updateThumbnail(quint64 identifier, const QImage &image);
+	static void storeThumbnail(quint64 identifier);
+	static void removeThumbnail(quint64 identifier);
+	static ThumbnailsManager* getInstance();
+	static QPixmap getThumbnail(quint64 identifier);
+
+protected:
+	explicit ThumbnailsManager(QObject *parent = NULL);
+
+	static QImage scaleThumbnail(const QImage &image);
+	static QString getThumbnailPath(quint64 identifier);
+	static bool writeThumbnail(const QImage &image, const QString &path);
+
+protected slots:
+	void handleThumbnailScaled();
+	void handleThumbnailStored();
+
+private:
+	QCache<quint64, QImage> m_thumbnails;
+	QHash<quint64, QImage> m_storedThumbnails;
+	QHash<QFutureWatcher<QImage>*, quint64> m_watchers;
+	QHash<QFutureWatcher<bool>*, quint64> m_writers;
+
+	static ThumbnailsManager *m_instance;
+	static const QSize m_thumbnailSize;
+
+signals:
+	void thumbnailChanged(quint64 identifier);
+};
+
+}
+
+#endif
@@ -34,50 +34,105 @@
 #include <QtCore/QRegularExpression>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QTemporaryFile>
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtWidgets/QMessageBox>
 
 namespace Otter
 {
 
 NetworkManager* Transfer::m_networkManager = NULL;
+QThreadPool* Transfer::m_hashingPool = NULL;
+QByteArray Transfer::m_buffer;
+const qint64 Transfer::m_minimumSegmentSize = 1048576;
+const qint64 Transfer::m_readBufferSize = 1048576;
+const int Transfer::m_bufferSize = 65536;
+const int Transfer::m_segmentRetriesLimit = 3;
 
 Transfer::Transfer(QObject *parent) : QObject(parent),
 	m_reply(NULL),
 	m_device(NULL),
+	m_hashWatcher(NULL),
+	m_hash(NULL),
 	m_speed(0),
 	m_bytesStart(0),
 	m_bytesReceivedDifference(0),
 	m_bytesReceived(0),
 	m_bytesTotal(0),
+	m_bandwidthLimit(0),
+	m_bandwidthTokens(0),
+	m_hashPosition(0),
 	m_state(UnknownState),
+	m_priority(NormalPriority),
+	m_algorithm(QCryptographicHash::Sha256),
+	m_verificationState(UnverifiedState),
+	m_operation(QNetworkAccessManager::GetOperation),
 	m_updateTimer(0),
-	m_updateInterval(0)
+	m_updateInterval(0),
+	m_segmentRetries(0)
 {
 }
 
 Transfer::Transfer(const QSettings &settings, QObject *parent) : QObject(parent),
 	m_reply(NULL),
 	m_device(NULL),
+	m_hashWatcher(NULL),
+	m_hash(NULL),
 	m_source(settings.value(QLatin1String("source")).toUrl()),
 	m_target(settings.value(QLatin1String("target")).toString()),
 	m_timeStarted(settings.value(QLatin1String("timeStarted")).toDateTime()),
 	m_timeFinished(settings.value(QLatin1String("timeFinished")).toDateTime()),
-	m_mimeType(QMimeDatabase().mimeTypeForFile(m_target)),
+	m_mimeType(QMimeDatabase().mimeTypeForFile(m_target, QMimeDatabase::MatchExtension)),
 	m_speed(0),
 	m_bytesStart(0),
 	m_bytesReceivedDifference(0),
 	m_bytesReceived(settings.value(QLatin1String("bytesReceived")).toLongLong()),
 	m_bytesTotal(settings.value(QLatin1String("bytesTotal")).toLongLong()),
-	m_state((m_bytesReceived > 0 && m_bytesTotal == m_bytesReceived) ? FinishedState : ErrorState),
+	m_bandwidthLimit(settings.value(QLatin1String("bandwidthLimit")).toLongLong()),
+	m_bandwidthTokens(0),
+	m_hashPosition(0),
+	m_state((m_bytesReceived > 0 && m_bytesTotal == m_bytesReceived) ? FinishedState : (settings.value(QLatin1String("queued")).toBool() ? QueuedState : ErrorState)),
+	m_priority(static_cast<TransferPriority>(settings.value(QLatin1String("priority"), NormalPriority).toInt())),
+	m_algorithm(QCryptographicHash::Sha256),
+	m_verificationState(UnverifiedState),
+	m_operation(QNetworkAccessManager::GetOperation),
 	m_updateTimer(0),
-	m_updateInterval(0)
+	m_updateInterval(0),
+	m_segmentRetries(0)
 {
+	m_expectedChecksum = parseChecksum(settings.value(QLatin1String("expectedChecksum")).toString(), &m_algorithm);
+
+	QCryptographicHash::Algorithm algorithm = m_algorithm;
+
+	m_checksum = parseChecksum(settings.value(QLatin1String("checksum")).toString(), &algorithm);
+
+	if (m_state == FinishedState)
+	{
+		if (!m_checksum.isEmpty() && (m_expectedChecksum.isEmpty() || algorithm == m_algorithm))
+		{
+			m_algorithm = algorithm;
+
+			updateVerificationState();
+		}
+		else
+		{
+			m_checksum.clear();
+		}
+
+		return;
+	}
+
+	m_checksum.clear();
+
+	setSegments(settings.value(QLatin1String("segments")).toStringList());
 }
 
 Transfer::Transfer(const QUrl &source, const QString &target, bool quickTransfer, QObject *parent) : QObject(parent),
 	m_reply(NULL),
 	m_device(NULL),
+	m_hashWatcher(NULL),
+	m_hash(NULL),
 	m_source(source),
 	m_target(target),
 	m_speed(0),
@@ -85,9 +140,17 @@ Transfer::Transfer(const QUrl &source, const QString &target, bool quickTransfer
 	m_bytesReceivedDifference(0),
 	m_bytesReceived(0),
 	m_bytesTotal(0),
+	m_bandwidthLimit(0),
+	m_bandwidthTokens(0),
+	m_hashPosition(0),
 	m_state(UnknownState),
+	m_priority(NormalPriority),
+	m_algorithm(QCryptographicHash::Sha256),
+	m_verificationState(UnverifiedState),
+	m_operation(QNetworkAccessManager::GetOperation),
 	m_updateTimer(0),
-	m_updateInterval(0)
+	m_updateInterval(0),
+	m_segmentRetries(0)
 {
 	QNetworkRequest request;
 	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
@@ -105,6 +168,8 @@ Transfer::Transfer(const QUrl &source, const QString &target, bool quickTransfer
 Transfer::Transfer(const QNetworkRequest &request, const QString &target, bool quickTransfer, QObject *parent) : QObject(parent),
 	m_reply(NULL),
 	m_device(NULL),
+	m_hashWatcher(NULL),
+	m_hash(NULL),
 	m_source(request.url()),
 	m_target(target),
 	m_speed(0),
@@ -112,9 +177,17 @@ Transfer::Transfer(const QNetworkRequest &request, const QString &target, bool q
 	m_bytesReceivedDifference(0),
 	m_bytesReceived(0),
 	m_bytesTotal(0),
+	m_bandwidthLimit(0),
+	m_bandwidthTokens(0),
+	m_hashPosition(0),
 	m_state(UnknownState),
+	m_priority(NormalPriority),
+	m_algorithm(QCryptographicHash::Sha256),
+	m_verificationState(UnverifiedState),
+	m_operation(QNetworkAccessManager::GetOperation),
 	m_updateTimer(0),
-	m_updateInterval(0)
+	m_updateInterval(0),
+	m_segmentRetries(0)
 {
 	if (!m_networkManager)
 	{
@@ -126,6 +199,8 @@ Transfer::Transfer(const QNetworkRequest &request, const QString &target, bool q
 
 Transfer::Transfer(QNetworkReply *reply, const QString &target, bool quickTransfer, QObject *parent) : QObject(parent),
 	m_reply(reply),
+	m_hashWatcher(NULL),
+	m_hash(NULL),
 	m_source(m_reply->url().adjusted(QUrl::RemovePassword | QUrl::PreferLocalFile)),
 	m_target(target),
 	m_speed(0),
@@ -133,13 +208,26 @@ Transfer::Transfer(QNetworkReply *reply, const QString &target, bool quickTransf
 	m_bytesReceivedDifference(0),
 	m_bytesReceived(0),
 	m_bytesTotal(0),
+	m_bandwidthLimit(0),
+	m_bandwidthTokens(0),
+	m_hashPosition(0),
 	m_state(UnknownState),
+	m_priority(NormalPriority),
+	m_algorithm(QCryptographicHash::Sha256),
+	m_verificationState(UnverifiedState),
+	m_operation(QNetworkAccessManager::GetOperation),
 	m_updateTimer(0),
-	m_updateInterval(0)
+	m_updateInterval(0),
+	m_segmentRetries(0)
 {
 	start(reply, target, quickTransfer);
 }
 
+Transfer::~Transfer()
+{
+	delete m_hash;
+}
+
 void Transfer::timerEvent(QTimerEvent *event)
 {
 	if (event->timerId() == m_updateTimer)
@@ -166,6 +254,18 @@ void Transfer::start(QNetworkReply *reply, const QString &target, bool quickTran
 	}
 
 	m_reply = reply;
+	m_reply->setReadBufferSize(m_readBufferSize);
+
+// replies sent through shared transport belong to its manager, the one which created them is their parent
+	m_manager = qobject_cast<QNetworkAccessManager*>(m_reply->parent());
+
+	if (!m_manager)
+	{
+		m_manager = m_reply->manager();
+	}
+
+	m_request = m_reply->request();
+	m_operation = m_reply->operation();
 
 	QTemporaryFile temporaryFile(QStandardPaths::writableLocation(QStandardPaths::TempLocation) + QDir::separator() + QLatin1String("otter-download-XXXXXX.dat"), this);
 
@@ -183,6 +283,8 @@ void Transfer::start(QNetworkReply *reply, const QString &target, bool quickTran
 
 	m_state = (m_reply->isFinished() ? FinishedState : RunningState);
 
+	updateExpectedChecksum();
+	startHash();
 	downloadData();
 
 	const bool isRunning = (m_state == RunningState);
@@ -297,9 +399,27 @@ void Transfer::start(QNetworkReply *reply, const QString &target, bool quickTran
 		return;
 	}
 
+	if (m_reply && m_state == RunningState)
+	{
+		disconnect(m_reply, SIGNAL(readyRead()), this, SLOT(downloadData()));
+	}
+
+	if (QFile::exists(m_target))
+	{
+		QFile::remove(m_target);
+	}
+
+	const bool isMoved = temporaryFile.rename(m_target);
+
+	if (isMoved)
+	{
+		temporaryFile.setAutoRemove(false);
+	}
+
 	QFile *file = new QFile(m_target);
 
-	if (!file->open(QIODevice::WriteOnly))
+// segments are written at their own positions, appending mode would move each write to the end of file
+	if (!file->open(isMoved ? QIODevice::ReadWrite : QIODevice::WriteOnly) || (isMoved && !file->seek(file->size())))
 	{
 		m_state = ErrorState;
 
@@ -308,16 +428,33 @@ void Transfer::start(QNetworkReply *reply, const QString &target, bool quickTran
 		return;
 	}
 
-	if (m_reply && m_state == RunningState)
+	m_device = file;
+
+	if (!isMoved)
 	{
-		disconnect(m_reply, SIGNAL(readyRead()), this, SLOT(downloadData()));
-	}
+// rename() closes spooled file before trying and does not copy it between file systems, so it has to be reopened and copied here
+		if (!temporaryFile.isOpen() && !temporaryFile.open())
+		{
+			stop();
+
+			m_state = ErrorState;
 
-	temporaryFile.reset();
+			return;
+		}
 
-	file->write(temporaryFile.readAll());
+		startHash();
 
-	m_device = file;
+		temporaryFile.reset();
+
+		if (transferData(&temporaryFile) != temporaryFile.size())
+		{
+			stop();
+
+			m_state = ErrorState;
+
+			return;
+		}
+	}
 
 	if (m_reply)
 	{
@@ -364,34 +501,286 @@ void Transfer::start(QNetworkReply *reply, const QString &target, bool quickTran
 		file->deleteLater();
 
 		m_state = FinishedState;
+
+		calculateChecksum(false);
+	}
+	else if (m_state == RunningState)
+	{
+		startSegments();
 	}
 }
 
-void Transfer::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+void Transfer::startSegments()
 {
-	m_bytesReceivedDifference += (bytesReceived - (m_bytesReceived - m_bytesStart));
-	m_bytesReceived = (m_bytesStart + bytesReceived);
-	m_bytesTotal = (m_bytesStart + bytesTotal);
+	const int limit = SettingsManager::getValue(QLatin1String("Network/TransferSegmentsLimit")).toInt();
+	QFile *file = qobject_cast<QFile*>(m_device);
+
+	if (limit < 2 || !file || !m_reply || m_reply->operation() != QNetworkAccessManager::GetOperation || (m_source.scheme() != QLatin1String("http") && m_source.scheme() != QLatin1String("https")) || m_reply->rawHeader(QStringLiteral("Accept-Ranges").toLatin1()).trimmed().toLower() != QByteArray("bytes") || m_reply->hasRawHeader(QStringLiteral("Content-Encoding").toLatin1()))
+	{
+		return;
+	}
+
+// only part which was not spooled yet is split, so first segment never starts past its own end
+	const qint64 position = file->pos();
+	const qint64 remaining = (m_bytesTotal - position);
+
+	if (remaining < (m_minimumSegmentSize * 2))
+	{
+		return;
+	}
+
+	const int amount = qMin(limit, int(remaining / m_minimumSegmentSize));
+	const qint64 segmentSize = (remaining / amount);
+
+	disconnect(m_reply, NULL, this, NULL);
+
+	TransferSegment segment;
+	segment.reply = m_reply;
+	segment.position = position;
+	segment.end = (position + segmentSize - 1);
+	segment.isChecked = true;
+
+	m_segments.append(segment);
+
+	connect(m_reply, SIGNAL(readyRead()), this, SLOT(segmentData()));
+	connect(m_reply, SIGNAL(finished()), this, SLOT(segmentFinished()));
+	connect(m_reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(segmentError(QNetworkReply::NetworkError)));
+
+	m_reply = NULL;
+	m_bytesStart = 0;
+	m_bytesReceived = position;
+	m_segmentRetries = 0;
+
+	delete m_hash;
+
+	m_hash = NULL;
+
+	file->resize(m_bytesTotal);
+
+	for (int i = 1; i < amount; ++i)
+	{
+		startSegment((position + (i * segmentSize)), ((i == (amount - 1)) ? (m_bytesTotal - 1) : (position + ((i + 1) * segmentSize) - 1)));
+	}
+
+	writeSegment(0);
 }
 
-void Transfer::downloadData()
+void Transfer::startSegment(qint64 position, qint64 end, int index)
 {
-	if (!m_reply)
+	TransferSegment segment;
+	segment.reply = createReply(position, end);
+	segment.position = position;
+	segment.end = end;
+
+	if (index >= 0 && index < m_segments.count())
+	{
+		m_segments[index] = segment;
+	}
+	else
+	{
+		m_segments.append(segment);
+	}
+
+	connect(segment.reply, SIGNAL(readyRead()), this, SLOT(segmentData()));
+	connect(segment.reply, SIGNAL(finished()), this, SLOT(segmentFinished()));
+	connect(segment.reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(segmentError(QNetworkReply::NetworkError)));
+}
+
+void Transfer::writeSegment(int index)
+{
+	if (index < 0 || index >= m_segments.count() || !m_segments.at(index).reply || !m_device)
 	{
 		return;
 	}
 
-	if (m_state == ErrorState)
+	QNetworkReply *reply = m_segments.at(index).reply;
+
+	if (!m_segments.at(index).isChecked)
 	{
-		m_state = RunningState;
+		if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206)
+		{
+// server refuses ranges now, so data is downloaded again over single connection instead of retrying segments
+			if (!restart())
+			{
+				stop();
+
+				m_state = ErrorState;
+			}
+
+			return;
+		}
+
+		m_segments[index].isChecked = true;
+	}
+
+	const qint64 remaining = (m_segments.at(index).end - m_segments.at(index).position + 1);
+
+	if (remaining > 0)
+	{
+		const qint64 available = getAvailableBandwidth();
+
+		m_device->seek(m_segments.at(index).position);
+
+		const qint64 amount = transferData(reply, ((available < 0) ? remaining : qMin(remaining, available)));
+
+		consumeBandwidth(amount);
+
+		m_segments[index].position += amount;
+		m_bytesReceived += amount;
+		m_bytesReceivedDifference += amount;
+
+		if (m_segments.at(index).position <= m_segments.at(index).end)
+		{
+			return;
+		}
+	}
+
+	disconnect(reply, NULL, this, NULL);
+
+	if (!reply->isFinished())
+	{
+		reply->abort();
+	}
+
+	reply->deleteLater();
+
+	m_segments.removeAt(index);
+
+	if (m_segments.isEmpty())
+	{
+		finishSegments();
+	}
+	else
+	{
+		splitSegment();
+	}
+}
+
+void Transfer::splitSegment()
+{
+	if (m_segments.count() >= SettingsManager::getValue(QLatin1String("Network/TransferSegmentsLimit")).toInt())
+	{
+		return;
+	}
+
+	qint64 remaining = 0;
+	int index = -1;
 
-		if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid() && m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206)
+	for (int i = 0; i < m_segments.count(); ++i)
+	{
+		if (m_segments.at(i).reply && (m_segments.at(i).end - m_segments.at(i).position + 1) > remaining)
 		{
-			m_device->reset();
+			remaining = (m_segments.at(i).end - m_segments.at(i).position + 1);
+			index = i;
 		}
 	}
 
-	m_device->write(m_reply->readAll());
+	if (index < 0 || remaining < (m_minimumSegmentSize * 2))
+	{
+		return;
+	}
+
+	const qint64 end = m_segments.at(index).end;
+	const qint64 middle = (m_segments.at(index).position + (remaining / 2));
+
+	m_segments[index].end = (middle - 1);
+
+	startSegment(middle, end);
+}
+
+void Transfer::finishSegments()
+{
+	if (m_updateTimer != 0)
+	{
+		killTimer(m_updateTimer);
+
+		m_updateTimer = 0;
+	}
+
+	if (m_device)
+	{
+		m_device->close();
+		m_device->deleteLater();
+		m_device = NULL;
+	}
+
+	m_state = FinishedState;
+	m_timeFinished = QDateTime::currentDateTime();
+	m_mimeType = QMimeDatabase().mimeTypeForFile(m_target);
+	m_bytesReceived = m_bytesTotal;
+
+	emit finished();
+	emit changed();
+
+	calculateChecksum(false);
+}
+
+void Transfer::segmentData()
+{
+	if (m_state == RunningState)
+	{
+		writeSegment(findSegment(qobject_cast<QNetworkReply*>(sender())));
+	}
+}
+
+void Transfer::segmentFinished()
+{
+	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+	int index = findSegment(reply);
+
+	if (index < 0)
+	{
+		return;
+	}
+
+	if (m_state == RunningState)
+	{
+		writeSegment(index);
+
+		index = findSegment(reply);
+	}
+
+// data held back by bandwidth limit or queue is written later, only reply which ended before its range did is an error
+	if (index >= 0 && m_state != ErrorState && (m_segments.at(index).position + reply->bytesAvailable()) <= m_segments.at(index).end && !restartSegment(index))
+	{
+		stop();
+
+		m_state = ErrorState;
+	}
+}
+
+void Transfer::segmentError(QNetworkReply::NetworkError error)
+{
+	const int index = findSegment(qobject_cast<QNetworkReply*>(sender()));
+
+	if (index < 0 || (error != QNetworkReply::OperationCanceledError && restartSegment(index)))
+	{
+		return;
+	}
+
+	stop();
+
+	m_state = ErrorState;
+}
+
+void Transfer::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+	checkRangeResponse();
+
+	m_bytesReceivedDifference += (bytesReceived - (m_bytesReceived - m_bytesStart));
+	m_bytesReceived = (m_bytesStart + bytesReceived);
+	m_bytesTotal = (m_bytesStart + bytesTotal);
+}
+
+void Transfer::downloadData()
+{
+	if (!m_reply || m_state == QueuedState)
+	{
+		return;
+	}
+
+	checkRangeResponse();
+	consumeBandwidth(transferData(m_reply, getAvailableBandwidth()));
 }
 
 void Transfer::downloadFinished()
@@ -415,9 +804,10 @@ void Transfer::downloadFinished()
 		m_updateTimer = 0;
 	}
 
-	if (m_reply->size() > 0)
+	if (m_reply->bytesAvailable() > 0)
 	{
-		m_device->write(m_reply->readAll());
+		checkRangeResponse();
+		transferData(m_reply);
 	}
 
 	disconnect(m_reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(downloadProgress(qint64,qint64)));
@@ -456,6 +846,11 @@ void Transfer::downloadFinished()
 			QTimer::singleShot(250, m_reply, SLOT(deleteLater()));
 		}
 	}
+
+	if (m_state == FinishedState)
+	{
+		calculateChecksum(false);
+	}
 }
 
 void Transfer::downloadError(QNetworkReply::NetworkError error)
@@ -488,6 +883,22 @@ void Transfer::stop()
 		QTimer::singleShot(250, m_reply, SLOT(deleteLater()));
 	}
 
+	for (int i = 0; i < m_segments.count(); ++i)
+	{
+		QNetworkReply *reply = m_segments.at(i).reply;
+
+		if (reply)
+		{
+			disconnect(reply, NULL, this, NULL);
+
+			reply->abort();
+
+			QTimer::singleShot(250, reply, SLOT(deleteLater()));
+
+			m_segments[i].reply = NULL;
+		}
+	}
+
 	if (m_device)
 	{
 		m_device->close();
@@ -495,7 +906,7 @@ void Transfer::stop()
 		m_device = NULL;
 	}
 
-	if (m_state == RunningState)
+	if (m_state == RunningState || m_state == QueuedState)
 	{
 		m_state = ErrorState;
 	}
@@ -504,29 +915,352 @@ void Transfer::stop()
 	emit changed();
 }
 
-void Transfer::setUpdateInterval(int interval)
+void Transfer::queue()
 {
-	m_updateInterval = interval;
-
-	if (m_updateTimer != 0)
+	if (m_state != RunningState && m_state != ErrorState)
 	{
-		killTimer(m_updateTimer);
-
-		m_updateTimer = 0;
+		return;
 	}
 
-	if (interval > 0 && m_updateInterval > 0 && m_state == Transfer::RunningState)
+	if (m_state == RunningState)
 	{
-		m_updateTimer = startTimer(m_updateInterval);
+// replies are kept open but no longer read, so read buffer limit makes them wait without losing request or data
+		if (m_updateTimer != 0)
+		{
+			killTimer(m_updateTimer);
+
+			m_updateTimer = 0;
+		}
+
+		m_speed = 0;
 	}
+
+	m_state = QueuedState;
+
+	emit changed();
 }
 
-QUrl Transfer::getSource() const
+void Transfer::consumeBandwidth(qint64 amount)
 {
-	return m_source;
+	if (m_bandwidthLimit > 0)
+	{
+		m_bandwidthTokens = qMax(qint64(0), (m_bandwidthTokens - amount));
+	}
+
+	TransfersManager::consumeBandwidth(amount);
 }
 
-QString Transfer::getTarget() const
+void Transfer::checkRangeResponse()
+{
+	if (m_bytesStart <= 0 || !m_reply || !m_device || !m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid() || m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 206)
+	{
+		return;
+	}
+
+// server ignored range, so partial file is truncated before full response is written into it
+	QFile *file = qobject_cast<QFile*>(m_device);
+
+	if (file)
+	{
+		file->resize(0);
+	}
+
+	m_device->reset();
+
+	m_bytesStart = 0;
+
+	startHash();
+}
+
+void Transfer::updateBandwidth(int interval)
+{
+	if (m_bandwidthLimit > 0)
+	{
+		m_bandwidthTokens = ((m_bandwidthLimit * interval) / 1000);
+	}
+
+	if (m_state != RunningState)
+	{
+		return;
+	}
+
+	if (m_reply && m_reply->bytesAvailable() > 0)
+	{
+		downloadData();
+	}
+
+	for (int i = (m_segments.count() - 1); i >= 0; --i)
+	{
+		if (m_state != RunningState)
+		{
+			break;
+		}
+
+		if (i < m_segments.count() && m_segments.at(i).reply && m_segments.at(i).reply->bytesAvailable() > 0)
+		{
+			writeSegment(i);
+		}
+	}
+}
+
+void Transfer::setPriority(TransferPriority priority)
+{
+	if (priority != m_priority)
+	{
+		m_priority = priority;
+
+		emit changed();
+	}
+}
+
+void Transfer::setBandwidthLimit(qint64 limit)
+{
+	if (limit != m_bandwidthLimit)
+	{
+		m_bandwidthLimit = qMax(qint64(0), limit);
+		m_bandwidthTokens = 0;
+
+		emit changed();
+	}
+}
+
+void Transfer::startHash()
+{
+	delete m_hash;
+
+	m_hash = NULL;
+	m_hashPosition = (m_device ? m_device->pos() : 0);
+	m_checksum.clear();
+	m_verificationState = UnverifiedState;
+
+	if (m_hashPosition == 0)
+	{
+		m_hash = new QCryptographicHash(m_algorithm);
+	}
+}
+
+void Transfer::updateExpectedChecksum()
+{
+	if (!m_reply || !m_expectedChecksum.isEmpty() || m_reply->hasRawHeader(QStringLiteral("Content-Encoding").toLatin1()))
+	{
+		return;
+	}
+
+	const QStringList digests = QString(m_reply->rawHeader(QStringLiteral("Digest").toLatin1())).split(QLatin1Char(','), QString::SkipEmptyParts);
+	const QStringList algorithms = (QStringList() << QLatin1String("sha-512") << QLatin1String("sha-256") << QLatin1String("sha") << QLatin1String("md5"));
+	int bestIndex = algorithms.count();
+
+	for (int i = 0; i < digests.count(); ++i)
+	{
+		const int separator = digests.at(i).indexOf(QLatin1Char('='));
+
+		if (separator < 0)
+		{
+			continue;
+		}
+
+		const int index = algorithms.indexOf(digests.at(i).left(separator).trimmed().toLower());
+		const QByteArray checksum = QByteArray::fromBase64(digests.at(i).mid(separator + 1).trimmed().toLatin1()).toHex();
+
+		if (index >= 0 && index < bestIndex && !checksum.isEmpty())
+		{
+			const QCryptographicHash::Algorithm types[] = {QCryptographicHash::Sha512, QCryptographicHash::Sha256, QCryptographicHash::Sha1, QCryptographicHash::Md5};
+
+			bestIndex = index;
+
+			m_expectedChecksum = checksum;
+			m_algorithm = types[index];
+		}
+	}
+
+	if (m_expectedChecksum.isEmpty() && m_reply->hasRawHeader(QStringLiteral("Content-MD5").toLatin1()) && m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200)
+	{
+		m_expectedChecksum = QByteArray::fromBase64(m_reply->rawHeader(QStringLiteral("Content-MD5").toLatin1()).trimmed()).toHex();
+		m_algorithm = QCryptographicHash::Md5;
+	}
+}
+
+void Transfer::updateVerificationState()
+{
+	if (m_checksum.isEmpty())
+	{
+		m_verificationState = (m_hashWatcher ? VerifyingState : UnverifiedState);
+	}
+	else
+	{
+		m_verificationState = (m_expectedChecksum.isEmpty() ? UnverifiedState : ((m_checksum == m_expectedChecksum) ? VerifiedState : CorruptedState));
+	}
+}
+
+void Transfer::verify()
+{
+	calculateChecksum(true);
+}
+
+void Transfer::calculateChecksum(bool forceHash)
+{
+	if (m_state != FinishedState || m_hashWatcher)
+	{
+		return;
+	}
+
+	if (m_checksum.isEmpty() && m_hash && m_hashPosition == m_bytesReceived)
+	{
+		m_checksum = m_hash->result().toHex();
+	}
+
+	delete m_hash;
+
+	m_hash = NULL;
+
+	if (m_checksum.isEmpty() && (forceHash || !m_expectedChecksum.isEmpty()))
+	{
+		if (!m_hashingPool)
+		{
+			m_hashingPool = new QThreadPool(QCoreApplication::instance());
+			m_hashingPool->setMaxThreadCount(qMax(1, (QThread::idealThreadCount() / 2)));
+		}
+
+		m_hashWatcher = new QFutureWatcher<QByteArray>(this);
+#if QT_VERSION >= 0x050400
+		m_hashWatcher->setFuture(QtConcurrent::run(m_hashingPool, &Transfer::hashFile, m_target, m_algorithm));
+#else
+		m_hashWatcher->setFuture(QtConcurrent::run(&Transfer::hashFile, m_target, m_algorithm));
+#endif
+
+		connect(m_hashWatcher, SIGNAL(finished()), this, SLOT(hashFinished()));
+	}
+
+	updateVerificationState();
+
+	emit changed();
+}
+
+void Transfer::hashFinished()
+{
+	if (!m_hashWatcher)
+	{
+		return;
+	}
+
+	m_checksum = m_hashWatcher->result();
+
+	m_hashWatcher->deleteLater();
+	m_hashWatcher = NULL;
+
+	if (m_checksum.isEmpty())
+	{
+		m_verificationState = (m_expectedChecksum.isEmpty() ? UnverifiedState : CorruptedState);
+	}
+	else
+	{
+		updateVerificationState();
+	}
+
+	emit changed();
+}
+
+void Transfer::setExpectedChecksum(const QString &checksum)
+{
+	QCryptographicHash::Algorithm algorithm = m_algorithm;
+	const QByteArray expectedChecksum = parseChecksum(checksum, &algorithm);
+
+	if (expectedChecksum == m_expectedChecksum && algorithm == m_algorithm)
+	{
+		return;
+	}
+
+	m_expectedChecksum = expectedChecksum;
+
+	if (algorithm != m_algorithm)
+	{
+		m_algorithm = algorithm;
+		m_checksum.clear();
+
+		delete m_hash;
+
+		m_hash = NULL;
+	}
+
+	if (m_state == FinishedState)
+	{
+		verify();
+	}
+	else
+	{
+		updateVerificationState();
+
+		emit changed();
+	}
+}
+
+void Transfer::setSegments(const QStringList &segments)
+{
+	m_segments.clear();
+
+	for (int i = 0; i < segments.count(); ++i)
+	{
+		const QStringList range = segments.at(i).split(QLatin1Char('-'));
+
+		if (range.count() == 2)
+		{
+			TransferSegment segment;
+			segment.position = range.at(0).toLongLong();
+			segment.end = range.at(1).toLongLong();
+
+			if (segment.position <= segment.end)
+			{
+				m_segments.append(segment);
+			}
+		}
+	}
+}
+
+void Transfer::setRecordPath(const QString &path)
+{
+	if (m_state != FinishedState)
+	{
+		m_recordPath = path;
+	}
+}
+
+void Transfer::loadRecord()
+{
+	if (m_recordPath.isEmpty())
+	{
+		return;
+	}
+
+	const QSettings record(m_recordPath, QSettings::IniFormat);
+
+	setSegments(record.value(QLatin1String("segments")).toStringList());
+
+	m_recordPath.clear();
+}
+
+void Transfer::setUpdateInterval(int interval)
+{
+	m_updateInterval = interval;
+
+	if (m_updateTimer != 0)
+	{
+		killTimer(m_updateTimer);
+
+		m_updateTimer = 0;
+	}
+
+	if (interval > 0 && m_updateInterval > 0 && m_state == Transfer::RunningState)
+	{
+		m_updateTimer = startTimer(m_updateInterval);
+	}
+}
+
+QUrl Transfer::getSource() const
+{
+	return m_source;
+}
+
+QString Transfer::getTarget() const
 {
 	return m_target;
 }
@@ -546,6 +1280,107 @@ QMimeType Transfer::getMimeType() const
 	return m_mimeType;
 }
 
+QString Transfer::getChecksum() const
+{
+	return formatChecksum(m_checksum, m_algorithm);
+}
+
+QString Transfer::getExpectedChecksum() const
+{
+	return formatChecksum(m_expectedChecksum, m_algorithm);
+}
+
+QString Transfer::formatChecksum(const QByteArray &checksum, QCryptographicHash::Algorithm algorithm)
+{
+	if (checksum.isEmpty())
+	{
+		return QString();
+	}
+
+	QString name;
+
+	switch (algorithm)
+	{
+		case QCryptographicHash::Md5:
+			name = QLatin1String("md5");
+
+			break;
+		case QCryptographicHash::Sha1:
+			name = QLatin1String("sha1");
+
+			break;
+		case QCryptographicHash::Sha512:
+			name = QLatin1String("sha512");
+
+			break;
+		default:
+			name = QLatin1String("sha256");
+
+			break;
+	}
+
+	return name + QLatin1Char(':') + QString::fromLatin1(checksum);
+}
+
+QByteArray Transfer::parseChecksum(const QString &checksum, QCryptographicHash::Algorithm *algorithm)
+{
+	QString value = checksum.trimmed().section(QRegularExpression(QLatin1String("\\s+")), 0, 0).toLower();
+	QString name;
+
+	if (value.contains(QLatin1Char(':')))
+	{
+		name = value.section(QLatin1Char(':'), 0, 0).remove(QLatin1Char('-'));
+		value = value.section(QLatin1Char(':'), 1);
+	}
+
+	if (value.isEmpty() || !QRegularExpression(QLatin1String("^[0-9a-f]+$")).match(value).hasMatch())
+	{
+		return QByteArray();
+	}
+
+	if (name == QLatin1String("md5") || (name.isEmpty() && value.length() == 32))
+	{
+		*algorithm = QCryptographicHash::Md5;
+	}
+	else if (name == QLatin1String("sha1") || (name.isEmpty() && value.length() == 40))
+	{
+		*algorithm = QCryptographicHash::Sha1;
+	}
+	else if (name == QLatin1String("sha256") || (name.isEmpty() && value.length() == 64))
+	{
+		*algorithm = QCryptographicHash::Sha256;
+	}
+	else if (name == QLatin1String("sha512") || (name.isEmpty() && value.length() == 128))
+	{
+		*algorithm = QCryptographicHash::Sha512;
+	}
+	else
+	{
+		return QByteArray();
+	}
+
+	return value.toLatin1();
+}
+
+QByteArray Transfer::hashFile(const QString &path, QCryptographicHash::Algorithm algorithm)
+{
+	QFile file(path);
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return QByteArray();
+	}
+
+	QCryptographicHash hash(algorithm);
+
+	if (!hash.addData(&file))
+	{
+		return QByteArray();
+	}
+
+	return hash.result().toHex();
+}
+
 qint64 Transfer::getSpeed() const
 {
 	return m_speed;
@@ -561,14 +1396,223 @@ qint64 Transfer::getBytesTotal() const
 	return m_bytesTotal;
 }
 
+qint64 Transfer::getBandwidthLimit() const
+{
+	return m_bandwidthLimit;
+}
+
+qint64 Transfer::getAvailableBandwidth() const
+{
+	const qint64 available = TransfersManager::getAvailableBandwidth();
+
+	if (m_bandwidthLimit <= 0)
+	{
+		return available;
+	}
+
+	return ((available < 0) ? m_bandwidthTokens : qMin(available, m_bandwidthTokens));
+}
+
+QStringList Transfer::getSegments() const
+{
+	if (!m_recordPath.isEmpty())
+	{
+		const QSettings record(m_recordPath, QSettings::IniFormat);
+
+		return record.value(QLatin1String("segments")).toStringList();
+	}
+
+	QStringList segments;
+
+	for (int i = 0; i < m_segments.count(); ++i)
+	{
+		segments.append(QStringLiteral("%1-%2").arg(m_segments.at(i).position).arg(m_segments.at(i).end));
+	}
+
+	return segments;
+}
+
+qint64 Transfer::transferData(QIODevice *source, qint64 limit)
+{
+	if (!source || !m_device)
+	{
+		return 0;
+	}
+
+	if (m_buffer.isEmpty())
+	{
+		m_buffer.resize(m_bufferSize);
+	}
+
+	qint64 amount = 0;
+
+	while (limit < 0 || amount < limit)
+	{
+		const qint64 bytes = source->read(m_buffer.data(), ((limit < 0) ? m_buffer.size() : qMin(qint64(m_buffer.size()), (limit - amount))));
+
+		if (bytes <= 0 || m_device->write(m_buffer.constData(), bytes) != bytes)
+		{
+			break;
+		}
+
+		if (m_hash)
+		{
+			if (m_hashPosition == (m_device->pos() - bytes))
+			{
+				m_hash->addData(m_buffer.constData(), bytes);
+
+				m_hashPosition += bytes;
+			}
+			else
+			{
+				delete m_hash;
+
+				m_hash = NULL;
+			}
+		}
+
+		amount += bytes;
+	}
+
+	return amount;
+}
+
+QNetworkReply* Transfer::createReply(qint64 position, qint64 end)
+{
+	QNetworkRequest request(m_request);
+	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+
+	if (request.url().isEmpty())
+	{
+		request.setHeader(QNetworkRequest::UserAgentHeader, AddonsManager::getWebBackend()->getUserAgent());
+		request.setUrl(m_source);
+	}
+
+	if (position > 0 || end >= 0)
+	{
+		request.setRawHeader(QStringLiteral("Range").toLatin1(), ((end >= 0) ? QStringLiteral("bytes=%1-%2").arg(position).arg(end) : QStringLiteral("bytes=%1-").arg(position)).toLatin1());
+	}
+	else
+	{
+		request.setRawHeader(QStringLiteral("Range").toLatin1(), QByteArray());
+	}
+
+// manager of original reply keeps its cookies and credentials, shared one is used only when it is gone
+	QNetworkAccessManager *manager = m_manager;
+
+	if (manager)
+	{
+// cookies of original request could be outdated already, let manager attach current ones from its cookie jar
+		request.setHeader(QNetworkRequest::CookieHeader, QVariant());
+		request.setAttribute(QNetworkRequest::CookieLoadControlAttribute, QNetworkRequest::Automatic);
+		request.setAttribute(QNetworkRequest::CookieSaveControlAttribute, QNetworkRequest::Automatic);
+	}
+	else
+	{
+		if (!m_networkManager)
+		{
+			m_networkManager = new NetworkManager(true, QCoreApplication::instance());
+		}
+
+		manager = m_networkManager;
+	}
+
+	QNetworkReply *reply = manager->get(request);
+	reply->setReadBufferSize(m_readBufferSize);
+
+	return reply;
+}
+
+bool Transfer::restartSegment(int index)
+{
+	if (index < 0 || index >= m_segments.count() || m_segmentRetries >= m_segmentRetriesLimit)
+	{
+		return false;
+	}
+
+	++m_segmentRetries;
+
+	QNetworkReply *reply = m_segments.at(index).reply;
+
+	if (reply)
+	{
+		disconnect(reply, NULL, this, NULL);
+
+		reply->deleteLater();
+	}
+
+	startSegment(m_segments.at(index).position, m_segments.at(index).end, index);
+
+	return true;
+}
+
+int Transfer::findSegment(QNetworkReply *reply) const
+{
+	if (!reply)
+	{
+		return -1;
+	}
+
+	for (int i = 0; i < m_segments.count(); ++i)
+	{
+		if (m_segments.at(i).reply == reply)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
 Transfer::TransferState Transfer::getState() const
 {
 	return m_state;
 }
 
+Transfer::TransferPriority Transfer::getPriority() const
+{
+	return m_priority;
+}
+
+Transfer::VerificationState Transfer::getVerificationState() const
+{
+	return m_verificationState;
+}
+
 bool Transfer::resume()
 {
-	if (m_state != ErrorState || !QFile::exists(m_target))
+	if (m_state == QueuedState && m_device && (m_reply || !m_segments.isEmpty()))
+	{
+		m_state = RunningState;
+
+		if (m_updateTimer == 0 && m_updateInterval > 0)
+		{
+			m_updateTimer = startTimer(m_updateInterval);
+		}
+
+		downloadData();
+
+		for (int i = (m_segments.count() - 1); i >= 0; --i)
+		{
+			if (m_state != RunningState)
+			{
+				break;
+			}
+
+			if (i < m_segments.count() && m_segments.at(i).reply && m_segments.at(i).reply->bytesAvailable() > 0)
+			{
+				writeSegment(i);
+			}
+		}
+
+		emit changed();
+
+		return true;
+	}
+
+	loadRecord();
+
+	if ((m_state != ErrorState && m_state != QueuedState) || !QFile::exists(m_target) || m_operation != QNetworkAccessManager::GetOperation)
 	{
 		return false;
 	}
@@ -578,9 +1622,14 @@ bool Transfer::resume()
 		return restart();
 	}
 
+	if (!m_segments.isEmpty())
+	{
+		return resumeSegments();
+	}
+
 	QFile *file = new QFile(m_target);
 
-	if (!file->open(QIODevice::WriteOnly | QIODevice::Append))
+	if (!file->open(QIODevice::ReadWrite) || !file->seek(file->size()))
 	{
 		file->deleteLater();
 
@@ -593,18 +1642,13 @@ bool Transfer::resume()
 	m_timeFinished = QDateTime();
 	m_bytesStart = file->size();
 
-	QNetworkRequest request;
-	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
-	request.setHeader(QNetworkRequest::UserAgentHeader, AddonsManager::getWebBackend()->getUserAgent());
-	request.setRawHeader(QStringLiteral("Range").toLatin1(), QStringLiteral("bytes=%1-").arg(file->size()).toLatin1());
-	request.setUrl(m_source);
+	delete m_hash;
 
-	if (!m_networkManager)
-	{
-		m_networkManager = new NetworkManager(true, QCoreApplication::instance());
-	}
+	m_hash = NULL;
+	m_checksum.clear();
+	m_verificationState = UnverifiedState;
 
-	m_reply = m_networkManager->get(request);
+	m_reply = createReply(file->size());
 
 	downloadData();
 
@@ -621,10 +1665,62 @@ bool Transfer::resume()
 	return true;
 }
 
+bool Transfer::resumeSegments()
+{
+	QFile *file = new QFile(m_target);
+
+	if (file->size() != m_bytesTotal || !file->open(QIODevice::ReadWrite))
+	{
+		file->deleteLater();
+
+		m_segments.clear();
+
+		return restart();
+	}
+
+	m_state = RunningState;
+	m_device = file;
+	m_timeStarted = QDateTime::currentDateTime();
+	m_timeFinished = QDateTime();
+	m_bytesStart = 0;
+
+	delete m_hash;
+
+	m_hash = NULL;
+	m_checksum.clear();
+	m_verificationState = UnverifiedState;
+
+	m_segmentRetries = 0;
+
+	const QList<TransferSegment> segments = m_segments;
+
+	m_segments.clear();
+
+	for (int i = 0; i < segments.count(); ++i)
+	{
+		startSegment(segments.at(i).position, segments.at(i).end);
+	}
+
+	if (m_updateTimer == 0 && m_updateInterval > 0)
+	{
+		m_updateTimer = startTimer(m_updateInterval);
+	}
+
+	return true;
+}
+
 bool Transfer::restart()
 {
+	if (m_operation != QNetworkAccessManager::GetOperation)
+	{
+		return false;
+	}
+
 	stop();
 
+	m_segments.clear();
+	m_recordPath.clear();
+
 	QFile *file = new QFile(m_target);
 
 	if (!file->open(QIODevice::WriteOnly))
@@ -640,17 +1736,9 @@ bool Transfer::restart()
 	m_timeFinished = QDateTime();
 	m_bytesStart = 0;
 
-	QNetworkRequest request;
-	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
-	request.setHeader(QNetworkRequest::UserAgentHeader, AddonsManager::getWebBackend()->getUserAgent());
-	request.setUrl(QUrl(m_source));
-
-	if (!m_networkManager)
-	{
-		m_networkManager = new NetworkManager(true, QCoreApplication::instance());
-	}
+	startHash();
 
-	m_reply = m_networkManager->get(request);
+	m_reply = createReply();
 
 	downloadData();
 
@@ -20,10 +20,13 @@
 #ifndef OTTER_TRANSFER_H
 #define OTTER_TRANSFER_H
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QIODevice>
 #include <QtCore/QMimeType>
 #include <QtCore/QPointer>
 #include <QtCore/QSettings>
+#include <QtCore/QThreadPool>
 #include <QtNetwork/QNetworkReply>
 
 namespace Otter
@@ -42,7 +45,23 @@ public:
 		RunningState = 1,
 		FinishedState = 2,
 		ErrorState = 3,
-		CancelledState = 4
+		CancelledState = 4,
+		QueuedState = 5
+	};
+
+	enum VerificationState
+	{
+		UnverifiedState = 0,
+		VerifyingState = 1,
+		VerifiedState = 2,
+		CorruptedState = 3
+	};
+
+	enum TransferPriority
+	{
+		LowPriority = 0,
+		NormalPriority = 1,
+		HighPriority = 2
 	};
 
 	explicit Transfer(QObject *parent);
@@ -50,52 +69,124 @@ public:
 	Transfer(const QUrl &source, const QString &target, bool quickTransfer, QObject *parent);
 	Transfer(const QNetworkRequest &request, const QString &target, bool quickTransfer, QObject *parent);
 	Transfer(QNetworkReply *reply, const QString &target, bool quickTransfer, QObject *parent);
+	~Transfer();
 
 	virtual void setUpdateInterval(int interval);
+	virtual void setPriority(TransferPriority priority);
+	virtual void setBandwidthLimit(qint64 limit);
+	virtual void setExpectedChecksum(const QString &checksum);
+	virtual void setRecordPath(const QString &path);
+	virtual void updateBandwidth(int interval);
 	virtual QUrl getSource() const;
 	virtual QString getTarget() const;
 	virtual QDateTime getTimeStarted() const;
 	virtual QDateTime getTimeFinished() const;
 	virtual QMimeType getMimeType() const;
+	virtual QString getChecksum() const;
+	virtual QString getExpectedChecksum() const;
 	virtual qint64 getSpeed() const;
 	virtual qint64 getBytesReceived() const;
 	virtual qint64 getBytesTotal() const;
+	virtual qint64 getBandwidthLimit() const;
+	virtual QStringList getSegments() const;
 	virtual TransferState getState() const;
+	virtual TransferPriority getPriority() const;
+	virtual VerificationState getVerificationState() const;
 
 public slots:
 	void openTarget();
 	virtual void stop();
+	virtual void queue();
 	virtual bool resume();
 	virtual bool restart();
+	virtual void verify();
 
 protected:
+	struct TransferSegment
+	{
+		QPointer<QNetworkReply> reply;
+		qint64 position;
+		qint64 end;
+		bool isChecked;
+
+		TransferSegment() : position(0), end(-1), isChecked(false) {}
+	};
+
 	void timerEvent(QTimerEvent *event);
 	void start(QNetworkReply *reply, const QString &target, bool quickTransfer);
+	void startSegments();
+	void startSegment(qint64 position, qint64 end, int index = -1);
+	void writeSegment(int index);
+	void splitSegment();
+	void finishSegments();
+	void consumeBandwidth(qint64 amount);
+	void checkRangeResponse();
+	void startHash();
+	void loadRecord();
+	void setSegments(const QStringList &segments);
+	void updateExpectedChecksum();
+	void updateVerificationState();
+	void calculateChecksum(bool forceHash);
+	static QByteArray hashFile(const QString &path, QCryptographicHash::Algorithm algorithm);
+	static QByteArray parseChecksum(const QString &checksum, QCryptographicHash::Algorithm *algorithm);
+	static QString formatChecksum(const QByteArray &checksum, QCryptographicHash::Algorithm algorithm);
+	QNetworkReply* createReply(qint64 position = 0, qint64 end = -1);
+	qint64 transferData(QIODevice *source, qint64 limit = -1);
+	qint64 getAvailableBandwidth() const;
+	int findSegment(QNetworkReply *reply) const;
+	bool restartSegment(int index);
+	bool resumeSegments();
 
 protected slots:
 	void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
 	void downloadData();
 	void downloadFinished();
 	void downloadError(QNetworkReply::NetworkError error);
+	void segmentData();
+	void segmentFinished();
+	void segmentError(QNetworkReply::NetworkError error);
+	void hashFinished();
 
 private:
 	QPointer<QNetworkReply> m_reply;
 	QPointer<QIODevice> m_device;
+	QPointer<QNetworkAccessManager> m_manager;
+	QFutureWatcher<QByteArray> *m_hashWatcher;
+	QCryptographicHash *m_hash;
+	QNetworkRequest m_request;
+	QList<TransferSegment> m_segments;
 	QUrl m_source;
 	QString m_target;
+	QString m_recordPath;
 	QDateTime m_timeStarted;
 	QDateTime m_timeFinished;
 	QMimeType m_mimeType;
+	QByteArray m_checksum;
+	QByteArray m_expectedChecksum;
 	qint64 m_speed;
 	qint64 m_bytesStart;
 	qint64 m_bytesReceivedDifference;
 	qint64 m_bytesReceived;
 	qint64 m_bytesTotal;
+	qint64 m_bandwidthLimit;
+	qint64 m_bandwidthTokens;
+	qint64 m_hashPosition;
 	TransferState m_state;
+	TransferPriority m_priority;
+	QCryptographicHash::Algorithm m_algorithm;
+	VerificationState m_verificationState;
+	QNetworkAccessManager::Operation m_operation;
 	int m_updateTimer;
 	int m_updateInterval;
+	int m_segmentRetries;
 
 	static NetworkManager *m_networkManager;
+	static QThreadPool *m_hashingPool;
+	static QByteArray m_buffer;
+	static const qint64 m_minimumSegmentSize;
+	static const qint64 m_readBufferSize;
+	static const int m_bufferSize;
+	static const int m_segmentRetriesLimit;
 
 signals:
 	void started();
@@ -20,11 +20,15 @@
 #include "TransfersManager.h"
 #include "NotificationsManager.h"
 #include "SessionsManager.h"
+#include "SettingsManager.h"
 #include "Transfer.h"
 #include "../ui/MainWindow.h"
 
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
 #include <QtCore/QMimeDatabase>
 #include <QtCore/QSettings>
+#include <QtCore/QTimer>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMessageBox>
 
@@ -33,12 +37,23 @@ namespace Otter
 
 TransfersManager* TransfersManager::m_instance = NULL;
 QList<Transfer*> TransfersManager::m_transfers;
-QList<Transfer*> TransfersManager::m_privateTransfers;
+QSet<Transfer*> TransfersManager::m_privateTransfers;
+QSet<Transfer*> TransfersManager::m_changedTransfers;
+QHash<Transfer*, QString> TransfersManager::m_records;
+int TransfersManager::m_recordIdentifier = 0;
+qint64 TransfersManager::m_bandwidthLimit = 0;
+qint64 TransfersManager::m_bandwidthTokens = 0;
+const int TransfersManager::m_bandwidthInterval = 100;
 bool TransfersManager::m_initilized = false;
 
 TransfersManager::TransfersManager(QObject *parent) : QObject(parent),
-	m_saveTimer(0)
+	m_saveTimer(0),
+	m_bandwidthTimer(0)
 {
+	m_bandwidthLimit = (SettingsManager::getValue(QLatin1String("Network/TransfersBandwidthLimit")).toLongLong() * 1024);
+
+	connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), this, SLOT(optionChanged(QString,QVariant)));
+	connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(save()));
 }
 
 void TransfersManager::createInstance(QObject *parent)
@@ -59,6 +74,43 @@ void TransfersManager::timerEvent(QTimerEvent *event)
 
 		save();
 	}
+	else if (event->timerId() == m_bandwidthTimer)
+	{
+		m_bandwidthTokens = ((m_bandwidthLimit * m_bandwidthInterval) / 1000);
+
+		QList<Transfer*> transfers;
+
+		for (int i = 0; i < m_transfers.count(); ++i)
+		{
+			if (m_transfers.at(i)->getState() == Transfer::RunningState)
+			{
+				transfers.prepend(m_transfers.at(i));
+			}
+		}
+
+		qStableSort(transfers.begin(), transfers.end(), compareTransfers);
+
+		for (int i = 0; i < transfers.count(); ++i)
+		{
+			transfers.at(i)->updateBandwidth(m_bandwidthInterval);
+		}
+
+		updateBandwidthTimer();
+	}
+}
+
+void TransfersManager::optionChanged(const QString &option, const QVariant &value)
+{
+	if (option == QLatin1String("Network/TransfersBandwidthLimit"))
+	{
+		m_bandwidthLimit = (value.toLongLong() * 1024);
+
+		updateBandwidthTimer();
+	}
+	else if (option == QLatin1String("Network/TransfersLimit") || option == QLatin1String("Network/TransfersHostLimit"))
+	{
+		scheduleQueueUpdate();
+	}
 }
 
 void TransfersManager::scheduleSave()
@@ -69,64 +121,218 @@ void TransfersManager::scheduleSave()
 	}
 }
 
+void TransfersManager::markTransferChanged(Transfer *transfer)
+{
+	if (!m_privateTransfers.contains(transfer))
+	{
+		m_changedTransfers.insert(transfer);
+
+		scheduleSave();
+	}
+}
+
+void TransfersManager::scheduleQueueUpdate()
+{
+	QTimer::singleShot(0, this, SLOT(updateQueue()));
+}
+
+void TransfersManager::updateQueue()
+{
+	QList<Transfer*> transfers;
+
+	for (int i = 0; i < m_transfers.count(); ++i)
+	{
+		if (m_transfers.at(i)->getState() == Transfer::QueuedState)
+		{
+			transfers.prepend(m_transfers.at(i));
+		}
+	}
+
+	qStableSort(transfers.begin(), transfers.end(), compareTransfers);
+
+	for (int i = 0; i < transfers.count(); ++i)
+	{
+		if (transfers.at(i)->getState() == Transfer::QueuedState && canStartTransfer(transfers.at(i)) && !transfers.at(i)->resume())
+		{
+			transfers.at(i)->stop();
+		}
+	}
+
+	updateBandwidthTimer();
+}
+
+void TransfersManager::updateBandwidthTimer()
+{
+	bool isNeeded = false;
+
+	for (int i = 0; i < m_transfers.count(); ++i)
+	{
+		if (m_transfers.at(i)->getState() == Transfer::RunningState && (m_bandwidthLimit > 0 || m_transfers.at(i)->getBandwidthLimit() > 0))
+		{
+			isNeeded = true;
+
+			break;
+		}
+	}
+
+	if (isNeeded && m_bandwidthTimer == 0)
+	{
+		m_bandwidthTimer = startTimer(m_bandwidthInterval);
+	}
+	else if (!isNeeded && m_bandwidthTimer != 0)
+	{
+		killTimer(m_bandwidthTimer);
+
+		m_bandwidthTimer = 0;
+	}
+}
+
 void TransfersManager::addTransfer(Transfer *transfer, bool isPrivate)
 {
 	m_transfers.prepend(transfer);
 
 	transfer->setUpdateInterval(500);
 
-	connect(transfer, SIGNAL(started()), m_instance, SLOT(transferStarted()));
-	connect(transfer, SIGNAL(finished()), m_instance, SLOT(transferFinished()));
-	connect(transfer, SIGNAL(changed()), m_instance, SLOT(transferChanged()));
-	connect(transfer, SIGNAL(stopped()), m_instance, SLOT(transferStopped()));
+	TransfersManager *manager = getInstance();
+
+	connect(transfer, SIGNAL(started()), manager, SLOT(transferStarted()));
+	connect(transfer, SIGNAL(finished()), manager, SLOT(transferFinished()));
+	connect(transfer, SIGNAL(changed()), manager, SLOT(transferChanged()));
+	connect(transfer, SIGNAL(stopped()), manager, SLOT(transferStopped()));
 
 	if (m_initilized)
 	{
-		emit m_instance->transferStarted(transfer);
+		emit manager->transferStarted(transfer);
 
 		if (transfer->getState() == Transfer::RunningState)
 		{
-			emit m_instance->transferFinished(transfer);
+			emit manager->transferFinished(transfer);
 		}
 	}
 
 	if (isPrivate)
 	{
-		m_privateTransfers.append(transfer);
+		m_privateTransfers.insert(transfer);
 	}
+	else
+	{
+		m_changedTransfers.insert(transfer);
+
+		manager->scheduleSave();
+	}
+
+	if (transfer->getState() == Transfer::RunningState && !canStartTransfer(transfer))
+	{
+		transfer->queue();
+	}
+
+	manager->updateBandwidthTimer();
 }
 
 void TransfersManager::save()
 {
 	if (SettingsManager::getValue(QLatin1String("Browser/PrivateMode")).toBool() || !SettingsManager::getValue(QLatin1String("History/RememberDownloads")).toBool())
+	{
+		m_changedTransfers.clear();
+
+		return;
+	}
+
+	if (m_changedTransfers.isEmpty())
 	{
 		return;
 	}
 
-	QSettings history(SessionsManager::getWritableDataPath(QLatin1String("transfers.ini")), QSettings::IniFormat);
-	history.clear();
+	QDir().mkpath(getRecordPath());
 
-	const int limit = SettingsManager::getValue(QLatin1String("History/DownloadsLimitPeriod")).toInt();
-	int entry = 1;
+	QSettings index(getRecordPath(QLatin1String("index")), QSettings::IniFormat);
+	QSet<Transfer*>::const_iterator iterator;
 
-	for (int i = 0; i < m_transfers.count(); ++i)
+	for (iterator = m_changedTransfers.constBegin(); iterator != m_changedTransfers.constEnd(); ++iterator)
 	{
-		if (m_privateTransfers.contains(m_transfers.at(i)) || (m_transfers.at(i)->getState() == Transfer::FinishedState && m_transfers.at(i)->getTimeFinished().isValid() && m_transfers.at(i)->getTimeFinished().daysTo(QDateTime::currentDateTime()) > limit))
+		Transfer *transfer = *iterator;
+
+		if (isExpired(transfer))
 		{
+			if (m_records.contains(transfer))
+			{
+				const QString record = m_records.take(transfer);
+
+				index.remove(QFileInfo(record).baseName());
+
+				QFile::remove(getRecordPath(record));
+			}
+
 			continue;
 		}
 
-		history.setValue(QStringLiteral("%1/source").arg(entry), m_transfers.at(i)->getSource().toString());
-		history.setValue(QStringLiteral("%1/target").arg(entry), m_transfers.at(i)->getTarget());
-		history.setValue(QStringLiteral("%1/timeStarted").arg(entry), m_transfers.at(i)->getTimeStarted().toString(Qt::ISODate));
-		history.setValue(QStringLiteral("%1/timeFinished").arg(entry), ((m_transfers.at(i)->getTimeFinished().isValid() && m_transfers.at(i)->getState() != Transfer::RunningState) ? m_transfers.at(i)->getTimeFinished() : QDateTime::currentDateTime()).toString(Qt::ISODate));
-		history.setValue(QStringLiteral("%1/bytesTotal").arg(entry), m_transfers.at(i)->getBytesTotal());
-		history.setValue(QStringLiteral("%1/bytesReceived").arg(entry), m_transfers.at(i)->getBytesReceived());
+		if (!m_records.contains(transfer))
+		{
+			++m_recordIdentifier;
+
+			m_records[transfer] = QStringLiteral("%1.ini").arg(m_recordIdentifier, 8, 10, QLatin1Char('0'));
+		}
+
+// segments of transfers not resumed yet are read from their record, so they have to be taken before it is cleared
+		const QStringList segments = transfer->getSegments();
+		QSettings record(getRecordPath(m_records[transfer]), QSettings::IniFormat);
+		record.clear();
 
-		++entry;
+		saveTransfer(transfer, record);
+
+		if (!segments.isEmpty())
+		{
+			record.setValue(QLatin1String("segments"), segments);
+		}
+
+		record.sync();
+
+		index.beginGroup(QFileInfo(m_records[transfer]).baseName());
+		index.remove(QString());
+
+		saveTransfer(transfer, index);
+
+		index.endGroup();
 	}
 
-	history.sync();
+	index.sync();
+
+	m_changedTransfers.clear();
+}
+
+void TransfersManager::saveTransfer(Transfer *transfer, QSettings &record)
+{
+	record.setValue(QLatin1String("source"), transfer->getSource().toString());
+	record.setValue(QLatin1String("target"), transfer->getTarget());
+	record.setValue(QLatin1String("timeStarted"), transfer->getTimeStarted().toString(Qt::ISODate));
+	record.setValue(QLatin1String("timeFinished"), ((transfer->getTimeFinished().isValid() && transfer->getState() != Transfer::RunningState) ? transfer->getTimeFinished() : QDateTime::currentDateTime()).toString(Qt::ISODate));
+	record.setValue(QLatin1String("bytesTotal"), transfer->getBytesTotal());
+	record.setValue(QLatin1String("bytesReceived"), transfer->getBytesReceived());
+
+	if (transfer->getState() == Transfer::QueuedState)
+	{
+		record.setValue(QLatin1String("queued"), true);
+	}
+
+	if (transfer->getPriority() != Transfer::NormalPriority)
+	{
+		record.setValue(QLatin1String("priority"), transfer->getPriority());
+	}
+
+	if (transfer->getBandwidthLimit() > 0)
+	{
+		record.setValue(QLatin1String("bandwidthLimit"), transfer->getBandwidthLimit());
+	}
+
+	if (!transfer->getExpectedChecksum().isEmpty())
+	{
+		record.setValue(QLatin1String("expectedChecksum"), transfer->getExpectedChecksum());
+	}
+
+	if (!transfer->getChecksum().isEmpty())
+	{
+		record.setValue(QLatin1String("checksum"), transfer->getChecksum());
+	}
 }
 
 void TransfersManager::transferStarted()
@@ -137,7 +343,7 @@ void TransfersManager::transferStarted()
 	{
 		emit transferStarted(transfer);
 
-		scheduleSave();
+		markTransferChanged(transfer);
 	}
 }
 
@@ -154,10 +360,9 @@ void TransfersManager::transferFinished()
 
 		emit transferFinished(transfer);
 
-		if (!m_privateTransfers.contains(transfer))
-		{
-			scheduleSave();
-		}
+		markTransferChanged(transfer);
+
+		scheduleQueueUpdate();
 	}
 }
 
@@ -169,7 +374,8 @@ void TransfersManager::transferChanged()
 	{
 		emit transferChanged(transfer);
 
-		scheduleSave();
+		markTransferChanged(transfer);
+		updateBandwidthTimer();
 	}
 }
 
@@ -181,7 +387,8 @@ void TransfersManager::transferStopped()
 	{
 		emit transferStopped(transfer);
 
-		scheduleSave();
+		markTransferChanged(transfer);
+		scheduleQueueUpdate();
 	}
 }
 
@@ -198,12 +405,17 @@ void TransfersManager::clearTransfers(int period)
 
 TransfersManager* TransfersManager::getInstance()
 {
+	if (!m_instance)
+	{
+		createInstance(QCoreApplication::instance());
+	}
+
 	return m_instance;
 }
 
 Transfer* TransfersManager::startTransfer(const QUrl &source, const QString &target, bool quickTransfer, bool isPrivate)
 {
-	Transfer *transfer = new Transfer(source, target, quickTransfer, m_instance);
+	Transfer *transfer = new Transfer(source, target, quickTransfer, getInstance());
 
 	if (transfer->getState() == Transfer::CancelledState)
 	{
@@ -219,7 +431,7 @@ Transfer* TransfersManager::startTransfer(const QUrl &source, const QString &tar
 
 Transfer* TransfersManager::startTransfer(const QNetworkRequest &request, const QString &target, bool quickTransfer, bool isPrivate)
 {
-	Transfer *transfer = new Transfer(request, target, quickTransfer, m_instance);
+	Transfer *transfer = new Transfer(request, target, quickTransfer, getInstance());
 
 	if (transfer->getState() == Transfer::CancelledState)
 	{
@@ -235,7 +447,7 @@ Transfer* TransfersManager::startTransfer(const QNetworkRequest &request, const
 
 Transfer* TransfersManager::startTransfer(QNetworkReply *reply, const QString &target, bool quickTransfer, bool isPrivate)
 {
-	Transfer *transfer = new Transfer(reply, target, quickTransfer, m_instance);
+	Transfer *transfer = new Transfer(reply, target, quickTransfer, getInstance());
 
 	if (transfer->getState() == Transfer::CancelledState)
 	{
@@ -323,7 +535,46 @@ QList<Transfer*> TransfersManager::getTransfers()
 {
 	if (!m_initilized)
 	{
-		QSettings history(SessionsManager::getWritableDataPath(QLatin1String("transfers.ini")), QSettings::IniFormat);
+		const QString legacyPath = SessionsManager::getWritableDataPath(QLatin1String("transfers.ini"));
+		const QString markerPath = getRecordPath(QLatin1String("imported"));
+
+		loadTransfers(getRecordPath());
+
+// records directory may already exist because of transfers saved before first call, so import is tracked by separate marker
+		if (QFile::exists(legacyPath) && !QFile::exists(markerPath))
+		{
+			loadTransfers(legacyPath);
+
+			if (!SettingsManager::getValue(QLatin1String("Browser/PrivateMode")).toBool() && SettingsManager::getValue(QLatin1String("History/RememberDownloads")).toBool())
+			{
+				getInstance()->save();
+
+				QFile marker(markerPath);
+
+				if (marker.open(QIODevice::WriteOnly))
+				{
+					marker.close();
+
+					QFile::remove(legacyPath);
+				}
+			}
+		}
+
+		m_initilized = true;
+
+		getInstance()->scheduleQueueUpdate();
+	}
+
+	return m_transfers;
+}
+
+void TransfersManager::loadTransfers(const QString &path)
+{
+	const QFileInfo information(path);
+
+	if (information.isFile())
+	{
+		QSettings history(path, QSettings::IniFormat);
 		const QStringList entries = history.childGroups();
 
 		m_transfers.reserve(entries.count());
@@ -334,18 +585,121 @@ QList<Transfer*> TransfersManager::getTransfers()
 
 			if (!history.value(QLatin1String("source")).toString().isEmpty() && !history.value(QLatin1String("target")).toString().isEmpty())
 			{
-				addTransfer(new Transfer(history, m_instance), false);
+				Transfer *transfer = new Transfer(history, getInstance());
+
+				if (isExpired(transfer))
+				{
+					delete transfer;
+				}
+				else
+				{
+					addTransfer(transfer, false);
+				}
 			}
 
 			history.endGroup();
 		}
 
-		m_initilized = true;
+		return;
+	}
 
-		connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), m_instance, SLOT(save()));
+	const QStringList records = QDir(path).entryList(QStringList(QLatin1String("*.ini")), QDir::Files, QDir::Name);
+	const QSet<QString> availableRecords = records.toSet();
+	QSet<QString> existingRecords = m_records.values().toSet();
+	QSettings index(getRecordPath(QLatin1String("index")), QSettings::IniFormat);
+	const QStringList entries = index.childGroups();
+
+	m_transfers.reserve(m_transfers.count() + records.count());
+
+// listing uses summaries from index only, full records are read when transfer is resumed
+	for (int i = 0; i < entries.count(); ++i)
+	{
+		const QString record = entries.at(i) + QLatin1String(".ini");
+
+		if (existingRecords.contains(record))
+		{
+			continue;
+		}
+
+		existingRecords.insert(record);
+
+		index.beginGroup(entries.at(i));
+
+		if (!availableRecords.contains(record) || index.value(QLatin1String("source")).toString().isEmpty() || index.value(QLatin1String("target")).toString().isEmpty())
+		{
+			index.remove(QString());
+			index.endGroup();
+
+			QFile::remove(getRecordPath(record));
+
+			continue;
+		}
+
+		Transfer *transfer = new Transfer(index, getInstance());
+
+		index.endGroup();
+
+		if (isExpired(transfer))
+		{
+			index.remove(entries.at(i));
+
+			QFile::remove(getRecordPath(record));
+
+			delete transfer;
+
+			continue;
+		}
+
+		transfer->setRecordPath(getRecordPath(record));
+
+		m_records[transfer] = record;
+
+		addTransfer(transfer, false);
+
+		m_changedTransfers.remove(transfer);
 	}
 
-	return m_transfers;
+// records missing in index (saved by older versions or before crash) are loaded in full and added to index on next save
+	for (int i = 0; i < records.count(); ++i)
+	{
+		m_recordIdentifier = qMax(m_recordIdentifier, QFileInfo(records.at(i)).baseName().toInt());
+
+		if (existingRecords.contains(records.at(i)))
+		{
+			continue;
+		}
+
+		const QSettings record(getRecordPath(records.at(i)), QSettings::IniFormat);
+
+		if (record.value(QLatin1String("source")).toString().isEmpty() || record.value(QLatin1String("target")).toString().isEmpty())
+		{
+			QFile::remove(getRecordPath(records.at(i)));
+
+			continue;
+		}
+
+		Transfer *transfer = new Transfer(record, getInstance());
+
+		if (isExpired(transfer))
+		{
+			QFile::remove(getRecordPath(records.at(i)));
+
+			delete transfer;
+
+			continue;
+		}
+
+		m_records[transfer] = records.at(i);
+
+		addTransfer(transfer, false);
+	}
+}
+
+QString TransfersManager::getRecordPath(const QString &record)
+{
+	const QString path = SessionsManager::getWritableDataPath(QLatin1String("transfers"));
+
+	return (record.isEmpty() ? path : path + QDir::separator() + record);
 }
 
 bool TransfersManager::removeTransfer(Transfer *transfer, bool keepFile)
@@ -357,7 +711,18 @@ bool TransfersManager::removeTransfer(Transfer *transfer, bool keepFile)
 
 	m_transfers.removeAll(transfer);
 
-	m_privateTransfers.removeAll(transfer);
+	m_privateTransfers.remove(transfer);
+
+	m_changedTransfers.remove(transfer);
+
+	if (m_records.contains(transfer))
+	{
+		const QString record = m_records.take(transfer);
+		QSettings index(getRecordPath(QLatin1String("index")), QSettings::IniFormat);
+		index.remove(QFileInfo(record).baseName());
+
+		QFile::remove(getRecordPath(record));
+	}
 
 	if (transfer->getState() == Transfer::RunningState)
 	{
@@ -369,13 +734,62 @@ bool TransfersManager::removeTransfer(Transfer *transfer, bool keepFile)
 		QFile::remove(transfer->getTarget());
 	}
 
-	emit m_instance->transferRemoved(transfer);
+	emit getInstance()->transferRemoved(transfer);
 
 	transfer->deleteLater();
 
+	getInstance()->scheduleQueueUpdate();
+
 	return true;
 }
 
+qint64 TransfersManager::getAvailableBandwidth()
+{
+	return ((m_bandwidthLimit > 0) ? m_bandwidthTokens : -1);
+}
+
+void TransfersManager::consumeBandwidth(qint64 amount)
+{
+	if (m_bandwidthLimit > 0)
+	{
+		m_bandwidthTokens = qMax(qint64(0), (m_bandwidthTokens - amount));
+	}
+}
+
+bool TransfersManager::canStartTransfer(Transfer *transfer)
+{
+	const int limit = SettingsManager::getValue(QLatin1String("Network/TransfersLimit")).toInt();
+	const int hostLimit = SettingsManager::getValue(QLatin1String("Network/TransfersHostLimit")).toInt();
+	const QString host = transfer->getSource().host();
+	int transfers = 0;
+	int hostTransfers = 0;
+
+	for (int i = 0; i < m_transfers.count(); ++i)
+	{
+		if (m_transfers.at(i) != transfer && m_transfers.at(i)->getState() == Transfer::RunningState)
+		{
+			++transfers;
+
+			if (m_transfers.at(i)->getSource().host() == host)
+			{
+				++hostTransfers;
+			}
+		}
+	}
+
+	return ((limit <= 0 || transfers < limit) && (hostLimit <= 0 || hostTransfers < hostLimit));
+}
+
+bool TransfersManager::isExpired(Transfer *transfer)
+{
+	return (transfer->getState() == Transfer::FinishedState && transfer->getTimeFinished().isValid() && transfer->getTimeFinished().daysTo(QDateTime::currentDateTime()) > SettingsManager::getValue(QLatin1String("History/DownloadsLimitPeriod")).toInt());
+}
+
+bool TransfersManager::compareTransfers(Transfer *first, Transfer *second)
+{
+	return (first->getPriority() > second->getPriority());
+}
+
 bool TransfersManager::isDownloading(const QString &source, const QString &target)
 {
 	if (source.isEmpty() && target.isEmpty())
@@ -20,6 +20,8 @@
 #ifndef OTTER_TRANSFERSMANAGER_H
 #define OTTER_TRANSFERSMANAGER_H
 
+#include <QtCore/QSet>
+#include <QtCore/QSettings>
 #include <QtNetwork/QNetworkReply>
 
 namespace Otter
@@ -40,6 +42,8 @@ public:
 	static Transfer* startTransfer(QNetworkReply *reply, const QString &target = QString(), bool quickTransfer = false, bool isPrivate = false);
 	static QString getSavePath(const QString &fileName, QString path = QString());
 	static QList<Transfer*> getTransfers();
+	static qint64 getAvailableBandwidth();
+	static void consumeBandwidth(qint64 amount);
 	static bool removeTransfer(Transfer *transfer, bool keepFile = true);
 	static bool isDownloading(const QString &source, const QString &target = QString());
 
@@ -48,10 +52,21 @@ protected:
 
 	void timerEvent(QTimerEvent *event);
 	void scheduleSave();
+	void scheduleQueueUpdate();
+	void markTransferChanged(Transfer *transfer);
+	void updateBandwidthTimer();
 	static void addTransfer(Transfer *transfer, bool isPrivate);
+	static void loadTransfers(const QString &path);
+	static void saveTransfer(Transfer *transfer, QSettings &record);
+	static QString getRecordPath(const QString &record = QString());
+	static bool canStartTransfer(Transfer *transfer);
+	static bool isExpired(Transfer *transfer);
+	static bool compareTransfers(Transfer *first, Transfer *second);
 
 protected slots:
 	void save();
+	void updateQueue();
+	void optionChanged(const QString &option, const QVariant &value);
 	void transferStarted();
 	void transferFinished();
 	void transferChanged();
@@ -59,10 +74,17 @@ protected slots:
 
 private:
 	int m_saveTimer;
+	int m_bandwidthTimer;
 
 	static TransfersManager *m_instance;
 	static QList<Transfer*> m_transfers;
-	static QList<Transfer*> m_privateTransfers;
+	static QSet<Transfer*> m_privateTransfers;
+	static QSet<Transfer*> m_changedTransfers;
+	static QHash<Transfer*, QString> m_records;
+	static int m_recordIdentifier;
+	static qint64 m_bandwidthLimit;
+	static qint64 m_bandwidthTokens;
+	static const int m_bandwidthInterval;
 	static bool m_initilized;
 
 signals:
@@ -21,6 +21,8 @@
 #include "WindowsManager.h"
 #include "Application.h"
 #include "BookmarksManager.h"
+#include "Console.h"
+#include "PlatformIntegration.h"
 #include "SettingsManager.h"
 #include "Utils.h"
 #include "../ui/ContentsWidget.h"
@@ -28,6 +30,7 @@
 #include "../ui/MdiWidget.h"
 #include "../ui/TabBarWidget.h"
 
+#include <QtCore/QTimerEvent>
 #include <QtGui/QStatusTipEvent>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QCheckBox>
@@ -38,9 +41,43 @@ namespace Otter
 
 WindowsManager::WindowsManager(bool isPrivate, MainWindow *parent) : QObject(parent),
 	m_mainWindow(parent),
+	m_memoryUsage(-1),
+	m_hibernatedWindows(0),
+	m_hibernationTimer(0),
+	m_restoreTimer(0),
 	m_isPrivate(isPrivate),
 	m_isRestored(false)
 {
+	m_hibernationTimer = startTimer(60000);
+}
+
+void WindowsManager::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_hibernationTimer)
+	{
+		hibernateWindows();
+	}
+	else if (event->timerId() == m_restoreTimer)
+	{
+		while (!m_delayedWindows.isEmpty())
+		{
+			const QPointer<Window> window = m_delayedWindows.takeFirst();
+
+			if (window && window->getLoadingState() == DelayedState)
+			{
+				window->getContentsWidget();
+
+				break;
+			}
+		}
+
+		if (m_delayedWindows.isEmpty())
+		{
+			killTimer(m_restoreTimer);
+
+			m_restoreTimer = 0;
+		}
+	}
 }
 
 void WindowsManager::triggerAction(int identifier, bool checked)
@@ -251,6 +288,73 @@ void WindowsManager::openTab(const QUrl &url, OpenHints hints)
 	window->setUrl(url, false);
 }
 
+void WindowsManager::hibernateWindows()
+{
+	PlatformIntegration *integration = Application::getInstance()->getPlatformIntegration();
+	const qint64 memoryUsage = (integration ? integration->getMemoryUsage() : -1);
+
+	if (m_hibernatedWindows > 0)
+	{
+		if (m_memoryUsage >= 0 && memoryUsage >= 0)
+		{
+			Console::addMessage(tr("Hibernated %n tab(s), reclaimed %1 of memory", "", m_hibernatedWindows).arg(Utils::formatUnit(qMax(qint64(0), (m_memoryUsage - memoryUsage)))), OtherMessageCategory, LogMessageLevel);
+		}
+		else
+		{
+			Console::addMessage(tr("Hibernated %n tab(s)", "", m_hibernatedWindows), OtherMessageCategory, LogMessageLevel);
+		}
+
+		m_hibernatedWindows = 0;
+	}
+
+	const qint64 memoryLimit = (SettingsManager::getValue(QLatin1String("Browser/TabHibernationMemoryLimit")).toLongLong() * 1048576);
+	const int timeout = (SettingsManager::getValue(QLatin1String("Browser/TabHibernationTimeout")).toInt() * 60);
+	const bool isOverLimit = (memoryLimit > 0 && memoryUsage > memoryLimit);
+
+	if (timeout <= 0 && !isOverLimit)
+	{
+		return;
+	}
+
+	const QDateTime currentTime = QDateTime::currentDateTime();
+	const int currentIndex = m_mainWindow->getTabBar()->currentIndex();
+	Window *leastActiveWindow = NULL;
+	QDateTime leastActivity;
+
+	for (int i = 0; i < m_mainWindow->getTabBar()->count(); ++i)
+	{
+		Window *window = getWindowByIndex(i);
+
+		if (!window || i == currentIndex || window->isPinned() || window->getLoadingState() != LoadedState)
+		{
+			continue;
+		}
+
+		const QDateTime activity = (window->getLastActivity().isValid() ? window->getLastActivity() : window->getCreationTime());
+
+		if (timeout > 0 && activity.secsTo(currentTime) > timeout)
+		{
+			if (window->hibernate())
+			{
+				++m_hibernatedWindows;
+			}
+		}
+		else if (isOverLimit && (!leastActiveWindow || activity < leastActivity))
+		{
+			leastActiveWindow = window;
+			leastActivity = activity;
+		}
+	}
+
+// memory usage is checked again on next run, so only one tab is unloaded at a time to stay close to limit
+	if (isOverLimit && m_hibernatedWindows == 0 && leastActiveWindow && leastActiveWindow->hibernate())
+	{
+		++m_hibernatedWindows;
+	}
+
+	m_memoryUsage = memoryUsage;
+}
+
 void WindowsManager::search(const QString &query, const QString &engine, OpenHints hints)
 {
 	Window *window = m_mainWindow->getMdi()->getActiveWindow();
@@ -352,12 +456,34 @@ void WindowsManager::restore(const SessionMainWindow &session)
 	}
 	else
 	{
+		const bool isDelayingRestore = SettingsManager::getValue(QLatin1String("Browser/DelayRestoringOfBackgroundTabs")).toBool();
+
+		m_mainWindow->getTabBar()->beginBatchUpdate();
+
 		for (int i = 0; i < session.windows.count(); ++i)
 		{
 			Window *window = new Window(m_isPrivate, NULL, m_mainWindow->getMdi());
-			window->setSession(session.windows.at(i));
+			window->setSession(session.windows.at(i), true);
 
-			addWindow(window);
+			addWindow(window, NewBackgroundTabEndOpen);
+
+			if (i != session.index)
+			{
+// first tab is added as current one, so it would stay unthrottled when another tab is going to be activated
+				window->setThrottled(true);
+
+				if (!isDelayingRestore)
+				{
+					m_delayedWindows.append(window);
+				}
+			}
+		}
+
+		m_mainWindow->getTabBar()->endBatchUpdate();
+
+		if (!m_delayedWindows.isEmpty() && m_restoreTimer == 0)
+		{
+			m_restoreTimer = startTimer(100);
 		}
 	}
 
@@ -381,7 +507,7 @@ void WindowsManager::restore(int index)
 		return;
 	}
 
-	const ClosedWindow closedWindow = m_closedWindows.at(index);
+	const ClosedItem closedWindow = m_closedWindows.getItem(index);
 	int windowIndex = -1;
 
 	if (closedWindow.previousWindow == 0)
@@ -412,9 +538,7 @@ void WindowsManager::restore(int index)
 	}
 
 	Window *window = new Window(m_isPrivate, NULL, m_mainWindow->getMdi());
-	window->setSession(closedWindow.window);
-
-	m_closedWindows.removeAt(index);
+	window->setSession(m_closedWindows.takeItem(index).windows.value(0, SessionWindow()));
 
 	if (m_closedWindows.isEmpty() && SessionsManager::getClosedWindows().isEmpty())
 	{
@@ -471,7 +595,11 @@ void WindowsManager::addWindow(Window *window, OpenHints hints, int index)
 		m_mainWindow->getAction(ActionsManager::CloseTabAction)->setEnabled(true);
 	}
 
-	if (!(hints & BackgroundOpen) || m_mainWindow->getTabBar()->count() < 2)
+	if ((hints & BackgroundOpen) && m_mainWindow->getTabBar()->count() > 1)
+	{
+		window->setThrottled(true);
+	}
+	else
 	{
 		m_mainWindow->getTabBar()->setCurrentIndex(index);
 
@@ -566,9 +694,9 @@ void WindowsManager::removeStoredUrl(const QString &url)
 {
 	for (int i = (m_closedWindows.count() - 1); i >= 0; --i)
 	{
-		if (url == m_closedWindows.at(i).window.getUrl())
+		if (url == m_closedWindows.getItem(i).url)
 		{
-			m_closedWindows.removeAt(i);
+			m_closedWindows.removeItem(i);
 
 			break;
 		}
@@ -591,24 +719,24 @@ void WindowsManager::handleWindowClose(Window *window)
 
 	if (window && !window->isPrivate())
 	{
-		const WindowHistoryInformation history = window->getContentsWidget()->getHistory();
+// contents widget would be created again for hibernated or not yet loaded window, its session is used instead
+		const SessionWindow session = window->getSession();
 
-		if (!Utils::isUrlEmpty(window->getUrl()) || history.entries.count() > 1)
+		if (!Utils::isUrlEmpty(window->getUrl()) || session.history.count() > 1)
 		{
 			Window *nextWindow = getWindowByIndex(index + 1);
 			Window *previousWindow = ((index > 0) ? getWindowByIndex(index - 1) : NULL);
 
-			ClosedWindow closedWindow;
-			closedWindow.window = window->getSession();
-			closedWindow.nextWindow = (nextWindow ? nextWindow->getIdentifier() : 0);
-			closedWindow.previousWindow = (previousWindow ? previousWindow->getIdentifier() : 0);
+			SessionMainWindow closedWindow;
+			closedWindow.windows.append(session);
+			closedWindow.index = 0;
 
-			if (window->getType() != QLatin1String("web"))
+			if (window->getType() != QLatin1String("web") && window->getType() != QLatin1String("unknown"))
 			{
-				removeStoredUrl(closedWindow.window.getUrl());
+				removeStoredUrl(closedWindow.windows.at(0).getUrl());
 			}
 
-			m_closedWindows.prepend(closedWindow);
+			m_closedWindows.addItem(closedWindow, (nextWindow ? nextWindow->getIdentifier() : 0), (previousWindow ? previousWindow->getIdentifier() : 0));
 
 			emit closedWindowsAvailableChanged(true);
 		}
@@ -707,12 +835,23 @@ void WindowsManager::setActiveWindowByIndex(int index)
 
 	setStatusMessage(QString());
 
+	Window *previousWindow = window;
+
 	window = getWindowByIndex(index);
 
+	if (previousWindow && previousWindow != window)
+	{
+// idle time of background tab is counted from the moment it was left, not from when it was selected
+		previousWindow->markActive();
+		previousWindow->setThrottled(true);
+	}
+
 	m_mainWindow->setCurrentWindow(window);
 
 	if (window)
 	{
+		window->setThrottled(false);
+
 		m_mainWindow->getMdi()->setActiveWindow(window);
 
 		window->setFocus();
@@ -848,7 +987,25 @@ SessionMainWindow WindowsManager::getSession() const
 
 QList<ClosedWindow> WindowsManager::getClosedWindows() const
 {
-	return m_closedWindows;
+	QList<ClosedWindow> closedWindows;
+
+	for (int i = 0; i < m_closedWindows.count(); ++i)
+	{
+		const ClosedItem item = m_closedWindows.getItem(i);
+		WindowHistoryEntry entry;
+		entry.url = item.url;
+		entry.title = item.title;
+
+		ClosedWindow closedWindow;
+		closedWindow.window.history.append(entry);
+		closedWindow.window.index = 0;
+		closedWindow.nextWindow = item.nextWindow;
+		closedWindow.previousWindow = item.previousWindow;
+
+		closedWindows.append(closedWindow);
+	}
+
+	return closedWindows;
 }
 
 OpenHints WindowsManager::calculateOpenHints(Qt::KeyboardModifiers modifiers, Qt::MouseButton button, OpenHints hints)
@@ -21,8 +21,10 @@
 #define OTTER_WINDOWSMANAGER_H
 
 #include "ActionsManager.h"
+#include "ClosedItemsStore.h"
 #include "SessionsManager.h"
 
+#include <QtCore/QPointer>
 #include <QtCore/QUrl>
 #include <QtGui/QStandardItem>
 #include <QtPrintSupport/QPrinter>
@@ -106,7 +108,9 @@ public slots:
 	void setZoom(int zoom);
 
 protected:
+	void timerEvent(QTimerEvent *event);
 	void openTab(const QUrl &url, OpenHints hints = DefaultOpen);
+	void hibernateWindows();
 	bool event(QEvent *event);
 
 protected slots:
@@ -122,7 +126,12 @@ protected slots:
 
 private:
 	MainWindow *m_mainWindow;
-	QList<ClosedWindow> m_closedWindows;
+	ClosedItemsStore m_closedWindows;
+	QList<QPointer<Window> > m_delayedWindows;
+	qint64 m_memoryUsage;
+	int m_hibernatedWindows;
+	int m_hibernationTimer;
+	int m_restoreTimer;
 	bool m_isPrivate;
 	bool m_isRestored;
 
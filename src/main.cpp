@@ -20,6 +20,7 @@
 #include "core/Application.h"
 #include "core/SessionsManager.h"
 #include "core/SettingsManager.h"
+#include "core/StartupProfiler.h"
 #include "ui/MainWindow.h"
 #include "ui/StartupDialog.h"
 
@@ -82,6 +83,8 @@ int main(int argc, char *argv[])
 	const QString startupBehavior = SettingsManager::getValue(QLatin1String("Browser/StartupBehavior")).toString();
 	const bool isPrivate = parser->isSet(QLatin1String("privatesession"));
 
+	StartupProfiler::beginPhase(QLatin1String("Session restore"));
+
 	if (!parser->value(QLatin1String("session")).isEmpty() && SessionsManager::getSession(session).clean)
 	{
 		SessionsManager::restoreSession(SessionsManager::getSession(session), NULL, isPrivate);
@@ -92,6 +95,8 @@ int main(int argc, char *argv[])
 
 		if (dialog.exec() == QDialog::Rejected)
 		{
+			StartupProfiler::finish();
+
 			delete parser;
 
 			return 0;
@@ -144,6 +149,9 @@ int main(int argc, char *argv[])
 		application.createWindow(isPrivate);
 	}
 
+	StartupProfiler::endPhase();
+	StartupProfiler::markEvent(QLatin1String("First window"));
+
 	delete parser;
 
 	return application.exec();
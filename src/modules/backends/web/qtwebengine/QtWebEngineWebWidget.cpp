@@ -1744,11 +1744,6 @@ QIcon QtWebEngineWebWidget::getIcon() const
 	return (m_icon.isNull() ? Utils::getIcon(QLatin1String("tab")) : m_icon);
 }
 
-QPixmap QtWebEngineWebWidget::getThumbnail()
-{
-	return QPixmap();
-}
-
 QPoint QtWebEngineWebWidget::getScrollPosition() const
 {
 	return m_scrollPosition;
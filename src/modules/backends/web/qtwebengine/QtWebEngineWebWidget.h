@@ -92,7 +92,6 @@ public:
 	QString getSelectedText() const;
 	QUrl getUrl() const;
 	QIcon getIcon() const;
-	QPixmap getThumbnail();
 	QPoint getScrollPosition() const;
 	QRect getProgressBarGeometry() const;
 	WindowHistoryInformation getHistory() const;
@@ -28,6 +28,9 @@
 #include "../../../../core/LocalListingNetworkReply.h"
 #include "../../../../core/NetworkCache.h"
 #include "../../../../core/NetworkManagerFactory.h"
+#include "../../../../core/NetworkPredictor.h"
+#include "../../../../core/NetworkTimeline.h"
+#include "../../../../core/NetworkTransport.h"
 #include "../../../../core/SettingsManager.h"
 #include "../../../../core/Utils.h"
 #include "../../../../core/WebBackend.h"
@@ -36,7 +39,6 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QFileInfo>
-#include <QtNetwork/QNetworkProxy>
 #include <QtNetwork/QNetworkReply>
 
 namespace Otter
@@ -48,6 +50,8 @@ QtWebKitNetworkManager::QtWebKitNetworkManager(bool isPrivate, CookieJarProxy *c
 	m_widget(parent),
 	m_cookieJar(NULL),
 	m_cookieJarProxy(cookieJarProxy),
+	m_transport(NULL),
+	m_timeline(NULL),
 	m_baseReply(NULL),
 	m_speed(0),
 	m_bytesReceivedDifference(0),
@@ -77,6 +81,11 @@ QtWebKitNetworkManager::QtWebKitNetworkManager(bool isPrivate, CookieJarProxy *c
 		m_cookieJar = new CookieJar(true, this);
 	}
 
+	if (!isPrivate)
+	{
+		m_timeline = new NetworkTimeline(this);
+	}
+
 	if (m_cookieJarProxy)
 	{
 		m_cookieJarProxy->setParent(this);
@@ -88,10 +97,9 @@ QtWebKitNetworkManager::QtWebKitNetworkManager(bool isPrivate, CookieJarProxy *c
 
 	setCookieJar(m_cookieJarProxy);
 
+	m_transport = NetworkManagerFactory::getTransport(isPrivate);
+
 	connect(this, SIGNAL(finished(QNetworkReply*)), SLOT(requestFinished(QNetworkReply*)));
-	connect(this, SIGNAL(authenticationRequired(QNetworkReply*,QAuthenticator*)), this, SLOT(handleAuthenticationRequired(QNetworkReply*,QAuthenticator*)));
-	connect(this, SIGNAL(proxyAuthenticationRequired(QNetworkProxy,QAuthenticator*)), this, SLOT(handleProxyAuthenticationRequired(QNetworkProxy,QAuthenticator*)));
-	connect(this, SIGNAL(sslErrors(QNetworkReply*,QList<QSslError>)), this, SLOT(handleSslErrors(QNetworkReply*,QList<QSslError>)));
 }
 
 void QtWebKitNetworkManager::timerEvent(QTimerEvent *event)
@@ -103,31 +111,14 @@ void QtWebKitNetworkManager::timerEvent(QTimerEvent *event)
 
 void QtWebKitNetworkManager::handleAuthenticationRequired(QNetworkReply *reply, QAuthenticator *authenticator)
 {
-	emit messageChanged(tr("Waiting for authentication…"));
-
-	AuthenticationDialog *authenticationDialog = new AuthenticationDialog(reply->url(), authenticator, m_widget);
-	authenticationDialog->setButtonsVisible(false);
-
-	ContentsDialog dialog(Utils::getIcon(QLatin1String("dialog-password")), authenticationDialog->windowTitle(), QString(), QString(), (QDialogButtonBox::Ok | QDialogButtonBox::Cancel), authenticationDialog, m_widget);
-
-	connect(&dialog, SIGNAL(accepted()), authenticationDialog, SLOT(accept()));
-	connect(m_widget, SIGNAL(aboutToReload()), &dialog, SLOT(close()));
-
-	m_widget->showDialog(&dialog);
-}
-
-void QtWebKitNetworkManager::handleProxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *authenticator)
-{
-	if (NetworkManagerFactory::isUsingSystemProxyAuthentication())
+	if (reply->parent() != this)
 	{
-		authenticator->setUser(QString());
-
 		return;
 	}
 
 	emit messageChanged(tr("Waiting for authentication…"));
 
-	AuthenticationDialog *authenticationDialog = new AuthenticationDialog(proxy.hostName(), authenticator, m_widget);
+	AuthenticationDialog *authenticationDialog = new AuthenticationDialog(reply->url(), authenticator, m_widget);
 	authenticationDialog->setButtonsVisible(false);
 
 	ContentsDialog dialog(Utils::getIcon(QLatin1String("dialog-password")), authenticationDialog->windowTitle(), QString(), QString(), (QDialogButtonBox::Ok | QDialogButtonBox::Cancel), authenticationDialog, m_widget);
@@ -140,6 +131,11 @@ void QtWebKitNetworkManager::handleProxyAuthenticationRequired(const QNetworkPro
 
 void QtWebKitNetworkManager::handleSslErrors(QNetworkReply *reply, const QList<QSslError> &errors)
 {
+	if (reply->parent() != this)
+	{
+		return;
+	}
+
 	if (errors.isEmpty())
 	{
 		reply->ignoreSslErrors(errors);
@@ -276,6 +272,11 @@ void QtWebKitNetworkManager::downloadProgress(qint64 bytesReceived, qint64 bytes
 
 void QtWebKitNetworkManager::requestFinished(QNetworkReply *reply)
 {
+	if (reply && reply->parent() != this)
+	{
+		return;
+	}
+
 	if (reply)
 	{
 		m_replies.remove(reply);
@@ -300,6 +301,23 @@ void QtWebKitNetworkManager::requestFinished(QNetworkReply *reply)
 	}
 }
 
+void QtWebKitNetworkManager::storeCookies()
+{
+	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+
+	if (!reply)
+	{
+		return;
+	}
+
+	const QList<QNetworkCookie> cookies = reply->header(QNetworkRequest::SetCookieHeader).value<QList<QNetworkCookie> >();
+
+	if (!cookies.isEmpty())
+	{
+		m_cookieJarProxy->setCookiesFromUrl(cookies, reply->url());
+	}
+}
+
 void QtWebKitNetworkManager::updateStatus()
 {
 	m_speed = (m_bytesReceivedDifference * 2);
@@ -417,7 +435,12 @@ QNetworkReply* QtWebKitNetworkManager::createRequest(QNetworkAccessManager::Oper
 
 	if (ContentBlockingManager::isUrlBlocked(m_widget->getContentBlockingProfiles(), request, m_widget->getUrl()))
 	{
-		Console::addMessage(QCoreApplication::translate("main", "Blocked content: %1").arg(request.url().url()), Otter::NetworkMessageCategory, LogMessageLevel);
+		Console::addMessage(QT_TRANSLATE_NOOP("main", "Blocked content: %1"), request.url().url(), Otter::NetworkMessageCategory, LogMessageLevel, m_widget->getUrl().host());
+
+		if (m_timeline)
+		{
+			m_timeline->addBlockedRequest(request, operation);
+		}
 
 		QUrl url = QUrl();
 		url.setScheme(QLatin1String("http"));
@@ -454,13 +477,51 @@ QNetworkReply* QtWebKitNetworkManager::createRequest(QNetworkAccessManager::Oper
 	mutableRequest.setRawHeader(QStringLiteral("Accept-Language").toLatin1(), (m_acceptLanguage.isEmpty() ? NetworkManagerFactory::getAcceptLanguage().toLatin1() : m_acceptLanguage.toLatin1()));
 	mutableRequest.setHeader(QNetworkRequest::UserAgentHeader, m_userAgent);
 
+	const bool canLoadCookies = (mutableRequest.attribute(QNetworkRequest::CookieLoadControlAttribute, QNetworkRequest::Automatic).toInt() == QNetworkRequest::Automatic);
+	const bool canSaveCookies = (mutableRequest.attribute(QNetworkRequest::CookieSaveControlAttribute, QNetworkRequest::Automatic).toInt() == QNetworkRequest::Automatic);
+
+	if (canLoadCookies)
+	{
+		const QList<QNetworkCookie> cookies = m_cookieJarProxy->cookiesForUrl(mutableRequest.url());
+
+		if (!cookies.isEmpty() && !mutableRequest.hasRawHeader(QStringLiteral("Cookie").toLatin1()))
+		{
+			mutableRequest.setHeader(QNetworkRequest::CookieHeader, QVariant::fromValue(cookies));
+		}
+
+		mutableRequest.setAttribute(QNetworkRequest::CookieLoadControlAttribute, QNetworkRequest::Manual);
+	}
+
+	if (canSaveCookies)
+	{
+		mutableRequest.setAttribute(QNetworkRequest::CookieSaveControlAttribute, QNetworkRequest::Manual);
+	}
+
 	emit messageChanged(tr("Sending request to %1…").arg(request.url().host()));
 
-	QNetworkReply *reply = QNetworkAccessManager::createRequest(operation, mutableRequest, outgoingData);
+	QNetworkReply *reply = m_transport->sendRequest(operation, mutableRequest, outgoingData, this);
+	reply->setParent(this);
+
+	if (canSaveCookies)
+	{
+		connect(reply, SIGNAL(metaDataChanged()), this, SLOT(storeCookies()));
+	}
 
 	if (!m_baseReply)
 	{
 		m_baseReply = reply;
+
+		NetworkPredictor::registerNavigation(request.url());
+
+		if (m_timeline)
+		{
+			m_timeline->startPage(request.url());
+		}
+	}
+
+	if (m_timeline)
+	{
+		m_timeline->addRequest(reply, operation);
 	}
 
 	m_replies[reply] = qMakePair(0, false);
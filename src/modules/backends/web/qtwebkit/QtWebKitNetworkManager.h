@@ -29,6 +29,8 @@ namespace Otter
 {
 
 class CookieJarProxy;
+class NetworkTimeline;
+class NetworkTransport;
 class QtWebKitWebWidget;
 class WebBackend;
 
@@ -55,15 +57,17 @@ protected:
 
 protected slots:
 	void handleAuthenticationRequired(QNetworkReply *reply, QAuthenticator *authenticator);
-	void handleProxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *authenticator);
 	void handleSslErrors(QNetworkReply *reply, const QList<QSslError> &errors);
 	void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
 	void requestFinished(QNetworkReply *reply);
+	void storeCookies();
 
 private:
 	QtWebKitWebWidget *m_widget;
 	CookieJar *m_cookieJar;
 	CookieJarProxy *m_cookieJarProxy;
+	NetworkTransport *m_transport;
+	NetworkTimeline *m_timeline;
 	QNetworkReply *m_baseReply;
 	QString m_acceptLanguage;
 	QString m_userAgent;
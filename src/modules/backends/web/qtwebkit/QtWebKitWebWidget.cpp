@@ -34,6 +34,7 @@
 #include "../../../../core/NetworkCache.h"
 #include "../../../../core/NetworkManager.h"
 #include "../../../../core/NetworkManagerFactory.h"
+#include "../../../../core/NetworkPredictor.h"
 #include "../../../../core/NotesManager.h"
 #include "../../../../core/SearchesManager.h"
 #include "../../../../core/SessionsManager.h"
@@ -81,6 +82,8 @@ QtWebKitWebWidget::QtWebKitWebWidget(bool isPrivate, WebBackend *backend, QtWebK
 	m_inspectorCloseButton(NULL),
 	m_networkManager(networkManager),
 	m_splitter(new QSplitter(Qt::Vertical, this)),
+	m_repaints(0),
+	m_visibleRepaints(0),
 	m_canLoadPlugins(false),
 	m_ignoreContextMenu(false),
 	m_ignoreContextMenuNextTime(false),
@@ -88,6 +91,8 @@ QtWebKitWebWidget::QtWebKitWebWidget(bool isPrivate, WebBackend *backend, QtWebK
 	m_isLoading(false),
 	m_isTyped(false)
 {
+	m_repaintsTimer.start();
+
 	m_splitter->addWidget(m_webView);
 	m_splitter->setChildrenCollapsible(false);
 	m_splitter->setContentsMargins(0, 0, 0, 0);
@@ -144,6 +149,7 @@ QtWebKitWebWidget::QtWebKitWebWidget(bool isPrivate, WebBackend *backend, QtWebK
 	connect(m_page, SIGNAL(featurePermissionRequested(QWebFrame*,QWebPage::Feature)), this, SLOT(handlePermissionRequest(QWebFrame*,QWebPage::Feature)));
 	connect(m_page, SIGNAL(featurePermissionRequestCanceled(QWebFrame*,QWebPage::Feature)), this, SLOT(handlePermissionCancel(QWebFrame*,QWebPage::Feature)));
 	connect(m_page, SIGNAL(loadStarted()), this, SLOT(pageLoadStarted()));
+	connect(m_page, SIGNAL(repaintRequested(QRect)), this, SLOT(handleRepaintRequest()));
 	connect(m_page, SIGNAL(loadFinished(bool)), this, SLOT(pageLoadFinished()));
 	connect(m_page->mainFrame(), SIGNAL(loadFinished(bool)), this, SLOT(pageLoadFinished()));
 	connect(m_page->mainFrame(), SIGNAL(contentsSizeChanged(QSize)), this, SIGNAL(progressBarGeometryChanged()));
@@ -253,7 +259,6 @@ void QtWebKitWebWidget::pageLoadStarted()
 {
 	m_canLoadPlugins = (getOption(QLatin1String("Browser/EnablePlugins"), getUrl()).toString() == QLatin1String("enabled"));
 	m_isLoading = true;
-	m_thumbnail = QPixmap();
 
 	updateNavigationActions();
 	setStatusMessage(QString());
@@ -271,7 +276,6 @@ void QtWebKitWebWidget::pageLoadFinished()
 	}
 
 	m_isLoading = false;
-	m_thumbnail = QPixmap();
 
 	m_networkManager->resetStatistics();
 
@@ -294,7 +298,7 @@ void QtWebKitWebWidget::downloadFile(const QNetworkRequest &request)
 
 		if (cache && cache->metaData(request.url()).isValid())
 		{
-			QIODevice *device = cache->data(request.url());
+			QIODevice *device = cache->getData(request.url());
 
 			if (device && device->size() > 0)
 			{
@@ -414,9 +418,19 @@ void QtWebKitWebWidget::hideInspector()
 	triggerAction(ActionsManager::InspectPageAction, false);
 }
 
+void QtWebKitWebWidget::handleRepaintRequest()
+{
+	++m_repaints;
+}
+
 void QtWebKitWebWidget::linkHovered(const QString &link)
 {
 	setStatusMessage(link, true);
+
+	if (!link.isEmpty())
+	{
+		NetworkPredictor::predictUrl(QUrl(link), NetworkPredictor::HoverSource, isPrivate());
+	}
 }
 
 void QtWebKitWebWidget::clearPluginToken()
@@ -581,6 +595,7 @@ void QtWebKitWebWidget::notifyTitleChanged()
 void QtWebKitWebWidget::notifyUrlChanged(const QUrl &url)
 {
 	updateOptions(url);
+	updateThrottling();
 	updatePageActions(url);
 	updateNavigationActions();
 
@@ -1262,8 +1277,9 @@ void QtWebKitWebWidget::triggerAction(int identifier, bool checked)
 					properties[QLatin1String("depth")] = m_hitResult.pixmap().depth();
 				}
 
+				NetworkCache *cache = qobject_cast<NetworkCache*>(m_networkManager->cache());
 				ContentsWidget *parent = qobject_cast<ContentsWidget*>(parentWidget());
-				ImagePropertiesDialog *imagePropertiesDialog = new ImagePropertiesDialog(m_hitResult.imageUrl(), properties, (m_networkManager->cache() ? m_networkManager->cache()->data(m_hitResult.imageUrl()) : NULL), this);
+				ImagePropertiesDialog *imagePropertiesDialog = new ImagePropertiesDialog(m_hitResult.imageUrl(), properties, (cache ? cache->getData(m_hitResult.imageUrl()) : NULL), this);
 				imagePropertiesDialog->setButtonsVisible(false);
 
 				if (parent)
@@ -1820,6 +1836,43 @@ void QtWebKitWebWidget::setHistory(QDataStream &stream)
 	updateOptions(m_webView->page()->history()->currentItem().url());
 }
 
+void QtWebKitWebWidget::setThrottled(bool throttled)
+{
+	const bool wasThrottled = isThrottled();
+
+	WebWidget::setThrottled(throttled);
+
+	if (isThrottled() == wasThrottled)
+	{
+		return;
+	}
+
+// hidden pages get their DOM timers aligned to low frequency and their animations suspended by WebKit itself
+	m_page->setVisibilityState(isThrottled() ? QWebPage::VisibilityStateHidden : QWebPage::VisibilityStateVisible);
+
+	m_webView->setUpdatesEnabled(!isThrottled());
+
+// repaints requested by page are counted in both states, so effect of throttling can be compared for each tab
+	const qint64 elapsed = qMax(qint64(1), m_repaintsTimer.restart());
+	const int repaints = int((qint64(m_repaints) * 60000) / elapsed);
+
+	if (isThrottled())
+	{
+// audible media is left playing, muted one is only visual and would keep decoding frames nobody sees
+		m_page->mainFrame()->evaluateJavaScript(QLatin1String("(function() { var elements = document.querySelectorAll('audio, video'); for (var i = 0; i < elements.length; ++i) { if (!elements[i].paused && (elements[i].muted || elements[i].volume == 0)) { elements[i].pause(); elements[i].otterThrottled = true; } } })()"));
+
+		m_visibleRepaints = repaints;
+	}
+	else
+	{
+		m_page->mainFrame()->evaluateJavaScript(QLatin1String("(function() { var elements = document.querySelectorAll('audio, video'); for (var i = 0; i < elements.length; ++i) { if (elements[i].otterThrottled) { elements[i].otterThrottled = false; elements[i].play(); } } })()"));
+
+		Console::addMessage(tr("Tab was throttled for %1 and requested %n repaint(s) meanwhile (%2 per minute, %3 per minute before throttling)", "", m_repaints).arg(Utils::formatTime(int(elapsed / 1000))).arg(repaints).arg(m_visibleRepaints), OtherMessageCategory, LogMessageLevel, getUrl().toString());
+	}
+
+	m_repaints = 0;
+}
+
 void QtWebKitWebWidget::setZoom(int zoom)
 {
 	if (zoom != getZoom())
@@ -2183,54 +2236,6 @@ QIcon QtWebKitWebWidget::getIcon() const
 	return (icon.isNull() ? Utils::getIcon(QLatin1String("tab")) : icon);
 }
 
-QPixmap QtWebKitWebWidget::getThumbnail()
-{
-	if (!m_thumbnail.isNull() && !isLoading())
-	{
-		return m_thumbnail;
-	}
-
-	const QSize thumbnailSize = QSize(260, 170);
-	const QSize oldViewportSize = m_webView->page()->viewportSize();
-	const QPoint position = m_webView->page()->mainFrame()->scrollPosition();
-	const qreal zoom = m_webView->page()->mainFrame()->zoomFactor();
-	QSize contentsSize = m_webView->page()->mainFrame()->contentsSize();
-	QWidget *newView = new QWidget();
-	QWidget *oldView = m_webView->page()->view();
-
-	m_webView->page()->setView(newView);
-	m_webView->page()->setViewportSize(contentsSize);
-	m_webView->page()->mainFrame()->setZoomFactor(1);
-
-	if (contentsSize.width() > 2000)
-	{
-		contentsSize.setWidth(2000);
-	}
-
-	contentsSize.setHeight(thumbnailSize.height() * (qreal(contentsSize.width()) / thumbnailSize.width()));
-
-	QPixmap pixmap(contentsSize);
-	pixmap.fill(Qt::white);
-
-	QPainter painter(&pixmap);
-
-	m_webView->page()->mainFrame()->render(&painter, QWebFrame::ContentsLayer, QRegion(QRect(QPoint(0, 0), contentsSize)));
-	m_webView->page()->mainFrame()->setZoomFactor(zoom);
-	m_webView->page()->setView(oldView);
-	m_webView->page()->setViewportSize(oldViewportSize);
-	m_webView->page()->mainFrame()->setScrollPosition(position);
-
-	painter.end();
-
-	pixmap = pixmap.scaled(thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-	newView->deleteLater();
-
-	m_thumbnail = pixmap;
-
-	return pixmap;
-}
-
 QPoint QtWebKitWebWidget::getScrollPosition() const
 {
 	return m_webView->page()->mainFrame()->scrollPosition();
@@ -2383,6 +2388,26 @@ bool QtWebKitWebWidget::isLoading() const
 	return m_isLoading;
 }
 
+bool QtWebKitWebWidget::isPlayingMedia() const
+{
+	QList<QWebFrame*> frames;
+	frames.append(m_page->mainFrame());
+
+	while (!frames.isEmpty())
+	{
+		QWebFrame *frame = frames.takeFirst();
+
+		if (frame->evaluateJavaScript(QLatin1String("(function() { var elements = document.querySelectorAll('audio, video'); for (var i = 0; i < elements.length; ++i) { if (!elements[i].paused && !elements[i].muted) { return true; } } return false; })()")).toBool())
+		{
+			return true;
+		}
+
+		frames.append(frame->childFrames());
+	}
+
+	return false;
+}
+
 bool QtWebKitWebWidget::isPrivate() const
 {
 	return m_webView->settings()->testAttribute(QWebSettings::PrivateBrowsingEnabled);
@@ -2434,6 +2459,18 @@ bool QtWebKitWebWidget::eventFilter(QObject *object, QEvent *event)
 		{
 			emit progressBarGeometryChanged();
 		}
+		else if (event->type() == QEvent::Paint)
+		{
+// QWebFrame does not notify about scrolling, but each scroll repaints the view
+			const QPoint position = m_webView->page()->mainFrame()->scrollPosition();
+
+			if (position != m_scrollPosition)
+			{
+				m_scrollPosition = position;
+
+				emit scrollPositionChanged(position);
+			}
+		}
 		else if (event->type() == QEvent::ToolTip)
 		{
 			const QString toolTipsMode = SettingsManager::getValue(QLatin1String("Browser/ToolTipsMode")).toString();
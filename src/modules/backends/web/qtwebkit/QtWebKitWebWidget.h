@@ -22,6 +22,7 @@
 
 #include "../../../../ui/WebWidget.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QtWebKitWidgets/QWebHitTestResult>
 #include <QtWebKitWidgets/QWebInspector>
 #include <QtWebKitWidgets/QWebPage>
@@ -54,7 +55,6 @@ public:
 	QString getSelectedText() const;
 	QUrl getUrl() const;
 	QIcon getIcon() const;
-	QPixmap getThumbnail();
 	QPoint getScrollPosition() const;
 	QRect getProgressBarGeometry() const;
 	WindowHistoryInformation getHistory() const;
@@ -64,6 +64,7 @@ public:
 	QVariantHash getStatistics() const;
 	int getZoom() const;
 	bool isLoading() const;
+	bool isPlayingMedia() const;
 	bool isPrivate() const;
 	bool findInPage(const QString &text, FindFlags flags = NoFlagsFind);
 	bool eventFilter(QObject *object, QEvent *event);
@@ -77,6 +78,7 @@ public slots:
 	void setOption(const QString &key, const QVariant &value);
 	void setScrollPosition(const QPoint &position);
 	void setHistory(const WindowHistoryInformation &history);
+	void setThrottled(bool throttled);
 	void setZoom(int zoom);
 	void setUrl(const QUrl &url, bool typed = true);
 
@@ -121,6 +123,7 @@ protected slots:
 	void handleWindowCloseRequest();
 	void handlePermissionRequest(QWebFrame *frame, QWebPage::Feature feature);
 	void handlePermissionCancel(QWebFrame *frame, QWebPage::Feature feature);
+	void handleRepaintRequest();
 	void notifyTitleChanged();
 	void notifyUrlChanged(const QUrl &url);
 	void notifyIconChanged();
@@ -147,14 +150,17 @@ private:
 	QtWebKitNetworkManager *m_networkManager;
 	QSplitter *m_splitter;
 	QString m_pluginToken;
-	QPixmap m_thumbnail;
 	QPoint m_clickPosition;
+	QPoint m_scrollPosition;
 	QWebHitTestResult m_hitResult;
 	QUrl m_formRequestUrl;
 	QByteArray m_formRequestBody;
 	QVector<int> m_contentBlockingProfiles;
 	QHash<int, Action*> m_actions;
 	QNetworkAccessManager::Operation m_formRequestOperation;
+	QElapsedTimer m_repaintsTimer;
+	int m_repaints;
+	int m_visibleRepaints;
 	bool m_canLoadPlugins;
 	bool m_ignoreContextMenu;
 	bool m_ignoreContextMenuNextTime;
@@ -23,11 +23,14 @@
 #include "../../../core/NotificationsManager.h"
 #include "../../../core/SettingsManager.h"
 
+#include <QtCore/QFile>
 #include <QtDBus/QtDBus>
 #include <QtDBus/QDBusReply>
 #include <QtGui/QIcon>
 #include <QtGui/QRgb>
 
+#include <unistd.h>
+
 QDBusArgument& operator<<(QDBusArgument &argument, const QImage &image)
 {
 	if (image.isNull())
@@ -181,6 +184,25 @@ void FreeDesktopOrgPlatformIntegration::showNotification(Notification *notificat
 	connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(notificationCallFinished(QDBusPendingCallWatcher*)));
 }
 
+qint64 FreeDesktopOrgPlatformIntegration::getMemoryUsage() const
+{
+	QFile file(QLatin1String("/proc/self/statm"));
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return -1;
+	}
+
+	const QList<QByteArray> values = file.readAll().split(' ');
+
+	if (values.count() < 2)
+	{
+		return -1;
+	}
+
+	return (values.at(1).toLongLong() * sysconf(_SC_PAGESIZE));
+}
+
 bool FreeDesktopOrgPlatformIntegration::canShowNotifications() const
 {
 	return m_notificationsInterface->isValid();
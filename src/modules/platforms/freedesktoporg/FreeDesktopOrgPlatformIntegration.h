@@ -40,6 +40,7 @@ class FreeDesktopOrgPlatformIntegration : public PlatformIntegration
 public:
 	explicit FreeDesktopOrgPlatformIntegration(Application *parent);
 
+	qint64 getMemoryUsage() const;
 	bool canShowNotifications() const;
 
 public slots:
@@ -28,6 +28,7 @@
 #include "../../../ui/TrayIcon.h"
 
 #include <Windows.h>
+#include <psapi.h>
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
@@ -376,6 +377,18 @@ QList<ApplicationInformation> WindowsPlatformIntegration::getApplicationsForMime
 	return applications;
 }
 
+qint64 WindowsPlatformIntegration::getMemoryUsage() const
+{
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return -1;
+	}
+
+	return counters.WorkingSetSize;
+}
+
 bool WindowsPlatformIntegration::canShowNotifications() const
 {
 	return true;
@@ -69,6 +69,7 @@ public:
 
 	void runApplication(const QString &command, const QString &fileName = QString()) const;
 	QList<ApplicationInformation> getApplicationsForMimeType(const QMimeType &mimeType);
+	qint64 getMemoryUsage() const;
 	bool canShowNotifications() const;
 	bool canSetAsDefaultBrowser() const;
 	bool isDefaultBrowser() const;
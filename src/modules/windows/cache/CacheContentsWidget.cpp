@@ -19,11 +19,10 @@
 
 #include "CacheContentsWidget.h"
 #include "../../../core/ActionsManager.h"
-#include "../../../core/AddonsManager.h"
+#include "../../../core/CacheModel.h"
 #include "../../../core/NetworkCache.h"
 #include "../../../core/NetworkManagerFactory.h"
 #include "../../../core/Utils.h"
-#include "../../../core/WebBackend.h"
 #include "../../../ui/ItemDelegate.h"
 
 #include "ui_CacheContentsWidget.h"
@@ -31,6 +30,7 @@
 #include <QtCore/QDateTime>
 #include <QtCore/QMimeDatabase>
 #include <QtCore/QTimer>
+#include <QtCore/QTimerEvent>
 #include <QtGui/QClipboard>
 #include <QtGui/QMouseEvent>
 #include <QtWidgets/QMenu>
@@ -39,8 +39,8 @@ namespace Otter
 {
 
 CacheContentsWidget::CacheContentsWidget(Window *window) : ContentsWidget(window),
-	m_model(new QStandardItemModel(this)),
-	m_isLoading(true),
+	m_model(NULL),
+	m_statisticsTimer(0),
 	m_ui(new Ui::CacheContentsWidget)
 {
 	m_ui->setupUi(this);
@@ -65,6 +65,14 @@ CacheContentsWidget::~CacheContentsWidget()
 	delete m_ui;
 }
 
+void CacheContentsWidget::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_statisticsTimer)
+	{
+		updateStatistics();
+	}
+}
+
 void CacheContentsWidget::changeEvent(QEvent *event)
 {
 	QWidget::changeEvent(event);
@@ -74,6 +82,8 @@ void CacheContentsWidget::changeEvent(QEvent *event)
 		case QEvent::LanguageChange:
 			m_ui->retranslateUi(this);
 
+			updateStatistics();
+
 			break;
 		default:
 			break;
@@ -108,196 +118,85 @@ void CacheContentsWidget::triggerAction(int identifier, bool checked)
 
 void CacheContentsWidget::populateCache()
 {
-	NetworkCache *cache = NetworkManagerFactory::getCache();
-	QStringList labels;
-	labels << tr("Address") << tr("Type") << tr("Size") << tr("Last Modified") << tr("Expires");
-
-	m_model->setHorizontalHeaderLabels(labels);
-	m_model->setSortRole(Qt::DisplayRole);
-
-	const QList<QUrl> entries = cache->getEntries();
-
-	for (int i = 0; i < entries.count(); ++i)
-	{
-		addEntry(entries.at(i));
-	}
-
-	m_model->sort(0);
+	m_model = new CacheModel(NetworkManagerFactory::getCache(), this);
 
 	m_ui->cacheView->setModel(m_model);
 	m_ui->cacheView->setItemDelegate(new ItemDelegate(this));
 	m_ui->cacheView->header()->setTextElideMode(Qt::ElideRight);
 	m_ui->cacheView->header()->setSectionResizeMode(0, QHeaderView::Stretch);
 
-	m_isLoading = false;
-
-	emit loadingChanged(false);
+	emit loadingChanged(m_model->isLoading());
 
-	connect(cache, SIGNAL(cleared()), this, SLOT(clearEntries()));
-	connect(cache, SIGNAL(entryAdded(QUrl)), this, SLOT(addEntry(QUrl)));
-	connect(cache, SIGNAL(entryRemoved(QUrl)), this, SLOT(removeEntry(QUrl)));
+	connect(m_model, SIGNAL(loadingChanged(bool)), this, SIGNAL(loadingChanged(bool)));
 	connect(m_model, SIGNAL(modelReset()), this, SLOT(updateActions()));
+	connect(m_model, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(filterEntries(QModelIndex,int,int)));
 	connect(m_ui->cacheView->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)), this, SLOT(updateActions()));
+
+	updateStatistics();
+
+// hits and misses are counted by network requests, which do not notify about them
+	m_statisticsTimer = startTimer(1000);
 }
 
 void CacheContentsWidget::filterCache(const QString &filter)
 {
-	for (int i = 0; i < m_model->rowCount(); ++i)
+	if (!m_model)
 	{
-		QStandardItem *domainItem = m_model->item(i, 0);
-
-		if (!domainItem)
-		{
-			continue;
-		}
+		return;
+	}
 
-		bool found = (filter.isEmpty() && domainItem->rowCount() > 0);
+	for (int i = 0; i < m_model->rowCount(); ++i)
+	{
+		const QModelIndex domainIndex = m_model->index(i, 0);
+		bool found = (filter.isEmpty() && m_model->rowCount(domainIndex) > 0);
 
-		for (int j = 0; j < domainItem->rowCount(); ++j)
+		for (int j = 0; j < m_model->rowCount(domainIndex); ++j)
 		{
-			QStandardItem *entryItem = domainItem->child(j, 0);
-
-			if (!entryItem)
-			{
-				continue;
-			}
-
-			const bool match = (filter.isEmpty() || entryItem->data(Qt::UserRole).toString().contains(filter, Qt::CaseInsensitive) || domainItem->child(j, 1)->text().contains(filter, Qt::CaseInsensitive));
-
-			if (match)
+			if (filterEntry(m_model->index(j, 0, domainIndex), filter))
 			{
 				found = true;
 			}
-
-			m_ui->cacheView->setRowHidden(j, domainItem->index(), !match);
 		}
 
-		m_ui->cacheView->setRowHidden(i, m_model->invisibleRootItem()->index(), !found);
-		m_ui->cacheView->setExpanded(domainItem->index(), !filter.isEmpty());
+		m_ui->cacheView->setRowHidden(i, QModelIndex(), !found);
+		m_ui->cacheView->setExpanded(domainIndex, !filter.isEmpty());
 	}
 }
 
-void CacheContentsWidget::clearEntries()
-{
-	m_model->clear();
-}
-
-void CacheContentsWidget::addEntry(const QUrl &entry)
+void CacheContentsWidget::filterEntries(const QModelIndex &parent, int first, int last)
 {
-	const QString domain = entry.host();
-	QStandardItem *domainItem = findDomain(domain);
+	const QString filter = m_ui->filterLineEdit->text();
 
-	if (domainItem)
-	{
-		for (int i = 0; i < domainItem->rowCount(); ++i)
-		{
-			QStandardItem *entryItem = domainItem->child(i, 0);
-
-			if (entry == entryItem->data(Qt::UserRole).toUrl())
-			{
-				return;
-			}
-		}
-	}
-	else
+	if (filter.isEmpty())
 	{
-		WebBackend *backend = AddonsManager::getWebBackend();
-
-		domainItem = new QStandardItem(backend->getIconForUrl(QUrl(QStringLiteral("http://%1/").arg(domain))), domain);
-		domainItem->setToolTip(domain);
-
-		m_model->appendRow(domainItem);
-		m_model->setItem(domainItem->row(), 2, new QStandardItem(QString()));
-
-		if (sender())
-		{
-			m_model->sort(0);
-		}
+		return;
 	}
 
-	NetworkCache *cache = NetworkManagerFactory::getCache();
-	QIODevice *device = cache->data(entry);
-	const QNetworkCacheMetaData metaData = cache->metaData(entry);
-	const QList<QPair<QByteArray, QByteArray> > headers = metaData.rawHeaders();
-	QString type;
-
-	for (int i = 0; i < headers.count(); ++i)
+	for (int i = first; i <= last; ++i)
 	{
-		if (headers.at(i).first == QStringLiteral("Content-Type").toLatin1())
-		{
-			type = QString(headers.at(i).second);
+		const QModelIndex domainIndex = (parent.isValid() ? parent : m_model->index(i, 0));
+		bool found = false;
 
-			break;
+		if (parent.isValid())
+		{
+			found = filterEntry(m_model->index(i, 0, parent), filter);
 		}
-	}
-
-	const QMimeType mimeType = ((type.isEmpty() && device) ? QMimeDatabase().mimeTypeForData(device) : QMimeDatabase().mimeTypeForName(type));
-	QList<QStandardItem*> entryItems;
-	entryItems.append(new QStandardItem(entry.path()));
-	entryItems.append(new QStandardItem(mimeType.name()));
-	entryItems.append(new QStandardItem(device ? Utils::formatUnit(device->size()) : QString()));
-	entryItems.append(new QStandardItem(metaData.lastModified().toString()));
-	entryItems.append(new QStandardItem(metaData.expirationDate().toString()));
-	entryItems[0]->setData(entry, Qt::UserRole);
-	entryItems[2]->setData((device ? device->size() : 0), Qt::UserRole);
-
-	QStandardItem *sizeItem = m_model->item(domainItem->row(), 2);
-
-	if (sizeItem && device)
-	{
-		sizeItem->setData((sizeItem->data(Qt::UserRole).toLongLong() + device->size()), Qt::UserRole);
-		sizeItem->setText(Utils::formatUnit(sizeItem->data(Qt::UserRole).toLongLong()));
-	}
-
-	if (device)
-	{
-		device->deleteLater();
-	}
-
-	domainItem->appendRow(entryItems);
-	domainItem->setText(QStringLiteral("%1 (%2)").arg(domain).arg(domainItem->rowCount()));
-
-	if (sender())
-	{
-		domainItem->sortChildren(0, Qt::DescendingOrder);
-	}
-
-	if (!m_ui->filterLineEdit->text().isEmpty())
-	{
-		filterCache(m_ui->filterLineEdit->text());
-	}
-}
-
-void CacheContentsWidget::removeEntry(const QUrl &entry)
-{
-	QStandardItem *entryItem = findEntry(entry);
-
-	if (entryItem)
-	{
-		QStandardItem *domainItem = entryItem->parent();
-
-		if (domainItem)
+		else
 		{
-			QStandardItem *sizeItem = domainItem->child(entryItem->row(), 2);
-			const qint64 size = (sizeItem ? sizeItem->data(Qt::UserRole).toLongLong() : 0);
-
-			m_model->removeRow(entryItem->row(), domainItem->index());
-
-			if (domainItem->rowCount() == 0)
-			{
-				m_model->invisibleRootItem()->removeRow(domainItem->row());
-			}
-			else
+			for (int j = 0; j < m_model->rowCount(domainIndex); ++j)
 			{
-				QStandardItem *domainSizeItem = m_model->item(domainItem->row(), 2);
-
-				if (domainSizeItem && size > 0)
+				if (filterEntry(m_model->index(j, 0, domainIndex), filter))
 				{
-					domainSizeItem->setData((domainSizeItem->data(Qt::UserRole).toLongLong() - size), Qt::UserRole);
-					domainSizeItem->setText(Utils::formatUnit(domainSizeItem->data(Qt::UserRole).toLongLong()));
+					found = true;
 				}
 			}
 		}
+
+		if (found || !parent.isValid())
+		{
+			m_ui->cacheView->setRowHidden(domainIndex.row(), QModelIndex(), !found);
+			m_ui->cacheView->setExpanded(domainIndex, found);
+		}
 	}
 }
 
@@ -314,23 +213,18 @@ void CacheContentsWidget::removeEntry()
 void CacheContentsWidget::removeDomainEntries()
 {
 	const QModelIndex index = m_ui->cacheView->currentIndex();
-	QStandardItem *domainItem = ((index.isValid() && index.parent() == m_model->invisibleRootItem()->index()) ? findDomain(index.sibling(index.row(), 0).data(Qt::ToolTipRole).toString()) : findEntry(getEntry(index)));
 
-	if (!domainItem)
+	if (!index.isValid())
 	{
 		return;
 	}
 
+	const QList<QUrl> entries = m_model->getEntries(index.parent().isValid() ? index.parent() : index);
 	NetworkCache *cache = NetworkManagerFactory::getCache();
 
-	for (int i = (domainItem->rowCount() - 1); i >= 0; --i)
+	for (int i = 0; i < entries.count(); ++i)
 	{
-		QStandardItem *entryItem = domainItem->child(i, 0);
-
-		if (entryItem)
-		{
-			cache->remove(entryItem->data(Qt::UserRole).toUrl());
-		}
+		cache->remove(entries.at(i));
 	}
 }
 
@@ -352,12 +246,7 @@ void CacheContentsWidget::openEntry(const QModelIndex &index)
 {
 	const QModelIndex entryIndex = (index.isValid() ? index : m_ui->cacheView->currentIndex());
 
-	if (!entryIndex.isValid() || entryIndex.parent() == m_model->invisibleRootItem()->index())
-	{
-		return;
-	}
-
-	const QUrl url = entryIndex.sibling(entryIndex.row(), 0).data(Qt::UserRole).toUrl();
+	const QUrl url = getEntry(entryIndex);
 
 	if (url.isValid())
 	{
@@ -369,11 +258,11 @@ void CacheContentsWidget::openEntry(const QModelIndex &index)
 
 void CacheContentsWidget::copyEntryLink()
 {
-	QStandardItem *entryItem = findEntry(getEntry(m_ui->cacheView->currentIndex()));
+	const QUrl entry = getEntry(m_ui->cacheView->currentIndex());
 
-	if (entryItem)
+	if (entry.isValid())
 	{
-		QApplication::clipboard()->setText(entryItem->data(Qt::UserRole).toString());
+		QApplication::clipboard()->setText(entry.toString());
 	}
 }
 
@@ -397,7 +286,7 @@ void CacheContentsWidget::showContextMenu(const QPoint &point)
 		menu.addAction(tr("Remove Entry"), this, SLOT(removeEntry()));
 	}
 
-	if (entry.isValid() || (index.isValid() && index.parent() == m_model->invisibleRootItem()->index()))
+	if (entry.isValid() || (index.isValid() && !index.parent().isValid()))
 	{
 		menu.addAction(tr("Remove All Entries from This Domain"), this, SLOT(removeDomainEntries()));
 		menu.addSeparator();
@@ -407,11 +296,20 @@ void CacheContentsWidget::showContextMenu(const QPoint &point)
 	menu.exec(m_ui->cacheView->mapToGlobal(point));
 }
 
+void CacheContentsWidget::updateStatistics()
+{
+	NetworkCache *cache = NetworkManagerFactory::getCache();
+	const qint64 hits = cache->getMemoryCacheHits();
+	const qint64 requests = (hits + cache->getMemoryCacheMisses());
+
+	m_ui->memoryCacheLabel->setText(tr("Memory cache: %1 used, %2 of %3 requests served from memory (%4%)").arg(Utils::formatUnit(cache->getMemoryCacheSize(), false, 1)).arg(hits).arg(requests).arg((requests > 0) ? ((hits * 100) / requests) : 0));
+}
+
 void CacheContentsWidget::updateActions()
 {
 	const QModelIndex index = (m_ui->cacheView->selectionModel()->hasSelection() ? m_ui->cacheView->selectionModel()->currentIndex() : QModelIndex());
 	const QUrl entry = getEntry(index);
-	const QString domain = ((index.isValid() && index.parent() == m_model->invisibleRootItem()->index()) ? index.sibling(index.row(), 0).data(Qt::ToolTipRole).toString() : entry.host());
+	const QString domain = ((index.isValid() && !index.parent().isValid()) ? index.sibling(index.row(), 0).data(Qt::ToolTipRole).toString() : entry.host());
 
 	m_ui->locationLabelWidget->setText(QString());
 	m_ui->previewLabel->hide();
@@ -421,7 +319,7 @@ void CacheContentsWidget::updateActions()
 	if (entry.isValid())
 	{
 		NetworkCache *cache = NetworkManagerFactory::getCache();
-		QIODevice *device = cache->data(entry);
+		QIODevice *device = cache->getData(entry);
 		const QNetworkCacheMetaData metaData = cache->metaData(entry);
 		const QList<QPair<QByteArray, QByteArray> > headers = metaData.rawHeaders();
 		QString type;
@@ -471,45 +369,8 @@ void CacheContentsWidget::updateActions()
 			m_ui->previewLabel->setPixmap(preview);
 		}
 
-		QStandardItem *typeItem = m_model->itemFromIndex(index.sibling(index.row(), 1));
-
-		if (typeItem && typeItem->text().isEmpty())
-		{
-			typeItem->setText(mimeType.name());
-		}
-
-		QStandardItem *lastModifiedItem = m_model->itemFromIndex(index.sibling(index.row(), 3));
-
-		if (lastModifiedItem && lastModifiedItem->text().isEmpty())
-		{
-			lastModifiedItem->setText(metaData.lastModified().toString());
-		}
-
-		QStandardItem *expiresItem = m_model->itemFromIndex(index.sibling(index.row(), 4));
-
-		if (expiresItem && expiresItem->text().isEmpty())
-		{
-			expiresItem->setText(metaData.expirationDate().toString());
-		}
-
 		if (device)
 		{
-			QStandardItem *sizeItem = m_model->itemFromIndex(index.sibling(index.row(), 2));
-
-			if (sizeItem && sizeItem->text().isEmpty())
-			{
-				sizeItem->setText(Utils::formatUnit(device->size()));
-				sizeItem->setData(device->size(), Qt::UserRole);
-
-				QStandardItem *domainSizeItem = (sizeItem->parent() ? m_model->item(sizeItem->parent()->row(), 2) : NULL);
-
-				if (domainSizeItem)
-				{
-					domainSizeItem->setData((domainSizeItem->data(Qt::UserRole).toLongLong() + device->size()), Qt::UserRole);
-					domainSizeItem->setText(Utils::formatUnit(domainSizeItem->data(Qt::UserRole).toLongLong()));
-				}
-			}
-
 			device->deleteLater();
 		}
 	}
@@ -533,42 +394,6 @@ void CacheContentsWidget::updateActions()
 	}
 }
 
-QStandardItem* CacheContentsWidget::findDomain(const QString &domain)
-{
-	for (int i = 0; i < m_model->rowCount(); ++i)
-	{
-		if (domain == m_model->item(i, 0)->toolTip())
-		{
-			return m_model->item(i, 0);
-		}
-	}
-
-	return NULL;
-}
-
-QStandardItem* CacheContentsWidget::findEntry(const QUrl &entry)
-{
-	for (int i = 0; i < m_model->rowCount(); ++i)
-	{
-		QStandardItem *domainItem = m_model->item(i, 0);
-
-		if (domainItem)
-		{
-			for (int j = 0; j < domainItem->rowCount(); ++j)
-			{
-				QStandardItem *entryItem = domainItem->child(j, 0);
-
-				if (entryItem && entry == entryItem->data(Qt::UserRole).toUrl())
-				{
-					return entryItem;
-				}
-			}
-		}
-	}
-
-	return NULL;
-}
-
 Action* CacheContentsWidget::getAction(int identifier)
 {
 	if (m_actions.contains(identifier))
@@ -612,12 +437,21 @@ QIcon CacheContentsWidget::getIcon() const
 
 QUrl CacheContentsWidget::getEntry(const QModelIndex &index) const
 {
-	return ((index.isValid() && index.parent().isValid() && index.parent().parent() == m_model->invisibleRootItem()->index()) ? index.sibling(index.row(), 0).data(Qt::UserRole).toUrl() : QUrl());
+	return (m_model ? m_model->getEntry(index) : QUrl());
+}
+
+bool CacheContentsWidget::filterEntry(const QModelIndex &index, const QString &filter)
+{
+	const bool match = (filter.isEmpty() || index.data(CacheModel::UrlRole).toString().contains(filter, Qt::CaseInsensitive) || index.sibling(index.row(), 1).data().toString().contains(filter, Qt::CaseInsensitive));
+
+	m_ui->cacheView->setRowHidden(index.row(), index.parent(), !match);
+
+	return match;
 }
 
 bool CacheContentsWidget::isLoading() const
 {
-	return m_isLoading;
+	return (!m_model || m_model->isLoading());
 }
 
 bool CacheContentsWidget::eventFilter(QObject *object, QEvent *event)
@@ -628,14 +462,7 @@ bool CacheContentsWidget::eventFilter(QObject *object, QEvent *event)
 
 		if (mouseEvent && ((mouseEvent->button() == Qt::LeftButton && mouseEvent->modifiers() != Qt::NoModifier) || mouseEvent->button() == Qt::MiddleButton))
 		{
-			const QModelIndex entryIndex = m_ui->cacheView->currentIndex();
-
-			if (!entryIndex.isValid() || entryIndex.parent() == m_model->invisibleRootItem()->index())
-			{
-				return ContentsWidget::eventFilter(object, event);
-			}
-
-			const QUrl url = entryIndex.sibling(entryIndex.row(), 0).data(Qt::UserRole).toUrl();
+			const QUrl url = getEntry(m_ui->cacheView->currentIndex());
 
 			if (url.isValid())
 			{
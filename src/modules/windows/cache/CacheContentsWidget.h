@@ -22,8 +22,6 @@
 
 #include "../../../ui/ContentsWidget.h"
 
-#include <QtGui/QStandardItemModel>
-
 namespace Otter
 {
 
@@ -32,6 +30,7 @@ namespace Ui
 	class CacheContentsWidget;
 }
 
+class CacheModel;
 class Window;
 
 class CacheContentsWidget : public ContentsWidget
@@ -55,17 +54,15 @@ public slots:
 	void triggerAction(int identifier, bool checked = false);
 
 protected:
+	void timerEvent(QTimerEvent *event);
 	void changeEvent(QEvent *event);
-	QStandardItem* findDomain(const QString &domain);
-	QStandardItem* findEntry(const QUrl &entry);
 	QUrl getEntry(const QModelIndex &index) const;
+	bool filterEntry(const QModelIndex &index, const QString &filter);
 
 protected slots:
 	void populateCache();
 	void filterCache(const QString &filter);
-	void clearEntries();
-	void addEntry(const QUrl &entry);
-	void removeEntry(const QUrl &entry);
+	void filterEntries(const QModelIndex &parent, int first, int last);
 	void removeEntry();
 	void removeDomainEntries();
 	void removeDomainEntriesOrEntry();
@@ -73,11 +70,12 @@ protected slots:
 	void copyEntryLink();
 	void showContextMenu(const QPoint &point);
 	void updateActions();
+	void updateStatistics();
 
 private:
-	QStandardItemModel *m_model;
+	CacheModel *m_model;
+	int m_statisticsTimer;
 	QHash<int, Action*> m_actions;
-	bool m_isLoading;
 	Ui::CacheContentsWidget *m_ui;
 };
 
@@ -25,7 +25,6 @@
 
 #include "ui_ConfigurationContentsWidget.h"
 
-#include <QtCore/QSettings>
 #include <QtGui/QClipboard>
 #include <QtWidgets/QMenu>
 
@@ -38,45 +37,42 @@ ConfigurationContentsWidget::ConfigurationContentsWidget(Window *window) : Conte
 {
 	m_ui->setupUi(this);
 
-	QSettings defaults(QLatin1String(":/schemas/options.ini"), QSettings::IniFormat, this);
-	const QStringList groups = defaults.childGroups();
+	const QStringList options = SettingsManager::getOptions();
+	QStandardItem *groupItem = NULL;
 
-	for (int i = 0; i < groups.count(); ++i)
+	for (int i = 0; i < options.count(); ++i)
 	{
-		QStandardItem *groupItem = new QStandardItem(Utils::getIcon(QLatin1String("inode-directory")), groups.at(i));
+		const QString key = options.at(i);
+		const int position = key.indexOf(QLatin1Char('/'));
+		const QString group = key.left(position);
 
-		defaults.beginGroup(groups.at(i));
+		if (!groupItem || groupItem->text() != group)
+		{
+			groupItem = new QStandardItem(Utils::getIcon(QLatin1String("inode-directory")), group);
 
-		const QStringList keys = defaults.childGroups();
+			m_model->appendRow(groupItem);
+		}
 
-		for (int j = 0; j < keys.count(); ++j)
+		const QString type = SettingsManager::getOptionType(key);
+		const QVariant value = SettingsManager::getValue(key);
+		QList<QStandardItem*> optionItems;
+		optionItems.append(new QStandardItem(key.mid(position + 1)));
+		optionItems.append(new QStandardItem(type));
+		optionItems.append(new QStandardItem(value.toString()));
+		optionItems[2]->setData(QSize(-1, 30), Qt::SizeHintRole);
+		optionItems[2]->setData(key, Qt::UserRole);
+		optionItems[2]->setData(type, (Qt::UserRole + 1));
+		optionItems[2]->setData(((type == QLatin1String("enumeration")) ? SettingsManager::getOptionChoices(key) : QVariant()), (Qt::UserRole + 2));
+
+		if (!SettingsManager::isDefaultValue(key, value))
 		{
-			const QString key = QStringLiteral("%1/%2").arg(groups.at(i)).arg(keys.at(j));
-			const QString type = defaults.value(QStringLiteral("%1/type").arg(keys.at(j))).toString();
-			const QVariant value = SettingsManager::getValue(key);
-			QList<QStandardItem*> optionItems;
-			optionItems.append(new QStandardItem(keys.at(j)));
-			optionItems.append(new QStandardItem(type));
-			optionItems.append(new QStandardItem(value.toString()));
-			optionItems[2]->setData(QSize(-1, 30), Qt::SizeHintRole);
-			optionItems[2]->setData(key, Qt::UserRole);
-			optionItems[2]->setData(type, (Qt::UserRole + 1));
-			optionItems[2]->setData(((type == QLatin1String("enumeration")) ? defaults.value(QStringLiteral("%1/choices").arg(keys.at(j))).toStringList() : QVariant()), (Qt::UserRole + 2));
-
-			if (value != SettingsManager::getDefaultValue(key))
-			{
-				QFont font = optionItems[0]->font();
-				font.setBold(true);
+			QFont font = optionItems[0]->font();
+			font.setBold(true);
 
-				optionItems[0]->setFont(font);
-			}
-
-			groupItem->appendRow(optionItems);
+			optionItems[0]->setFont(font);
 		}
 
-		defaults.endGroup();
-
-		m_model->appendRow(groupItem);
+		groupItem->appendRow(optionItems);
 	}
 
 	QStringList labels;
@@ -134,7 +130,7 @@ void ConfigurationContentsWidget::optionChanged(const QString &option, const QVa
 			if (optionItem && option == QStringLiteral("%1/%2").arg(groupItem->text()).arg(optionItem->text()))
 			{
 				QFont font = optionItem->font();
-				font.setBold(value != SettingsManager::getDefaultValue(option));
+				font.setBold(!SettingsManager::isDefaultValue(option, value));
 
 				optionItem->setFont(font);
 
@@ -258,7 +254,7 @@ void ConfigurationContentsWidget::showContextMenu(const QPoint &point)
 		menu.addAction(tr("Copy Option Name"), this, SLOT(copyOptionName()));
 		menu.addAction(tr("Copy Option Value"), this, SLOT(copyOptionValue()));
 		menu.addSeparator();
-		menu.addAction(tr("Restore Default Value"), this, SLOT(restoreDefaults()))->setEnabled(index.sibling(index.row(), 2).data(Qt::EditRole) != SettingsManager::getDefaultValue(index.sibling(index.row(), 2).data(Qt::UserRole).toString()));
+		menu.addAction(tr("Restore Default Value"), this, SLOT(restoreDefaults()))->setEnabled(!SettingsManager::isDefaultValue(index.sibling(index.row(), 2).data(Qt::UserRole).toString(), index.sibling(index.row(), 2).data(Qt::EditRole)));
 		menu.exec(m_ui->configurationView->mapToGlobal(point));
 	}
 }
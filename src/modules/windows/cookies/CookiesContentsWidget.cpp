@@ -19,11 +19,10 @@
 
 #include "CookiesContentsWidget.h"
 #include "../../../core/ActionsManager.h"
-#include "../../../core/AddonsManager.h"
 #include "../../../core/CookieJar.h"
+#include "../../../core/CookiesModel.h"
 #include "../../../core/NetworkManagerFactory.h"
 #include "../../../core/Utils.h"
-#include "../../../core/WebBackend.h"
 
 #include "ui_CookiesContentsWidget.h"
 
@@ -35,7 +34,7 @@ namespace Otter
 {
 
 CookiesContentsWidget::CookiesContentsWidget(Window *window) : ContentsWidget(window),
-	m_model(new QStandardItemModel(this)),
+	m_model(NULL),
 	m_isLoading(true),
 	m_ui(new Ui::CookiesContentsWidget)
 {
@@ -75,16 +74,7 @@ void CookiesContentsWidget::changeEvent(QEvent *event)
 
 void CookiesContentsWidget::populateCookies()
 {
-	CookieJar *cookieJar = qobject_cast<CookieJar*>(NetworkManagerFactory::getCookieJar());
-
-	const QList<QNetworkCookie> cookies = cookieJar->getCookies();
-
-	for (int i = 0; i < cookies.count(); ++i)
-	{
-		addCookie(cookies.at(i));
-	}
-
-	m_model->sort(0);
+	m_model = new CookiesModel(NetworkManagerFactory::getCookieJar(), this);
 
 	m_ui->cookiesView->setModel(m_model);
 
@@ -92,91 +82,10 @@ void CookiesContentsWidget::populateCookies()
 
 	emit loadingChanged(false);
 
-	connect(cookieJar, SIGNAL(cookieAdded(QNetworkCookie)), this, SLOT(addCookie(QNetworkCookie)));
-	connect(cookieJar, SIGNAL(cookieRemoved(QNetworkCookie)), this, SLOT(removeCookie(QNetworkCookie)));
 	connect(m_model, SIGNAL(modelReset()), this, SLOT(updateActions()));
 	connect(m_ui->cookiesView->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)), this, SLOT(updateActions()));
 }
 
-void CookiesContentsWidget::addCookie(const QNetworkCookie &cookie)
-{
-	const QString domain = (cookie.domain().startsWith('.') ? cookie.domain().mid(1) : cookie.domain());
-	QStandardItem *domainItem = findDomain(domain);
-
-	if (domainItem)
-	{
-		for (int i = 0; i < domainItem->rowCount(); ++i)
-		{
-			if (domainItem->child(i, 0)->text() == cookie.name() && domainItem->child(i, 0)->data(Qt::UserRole).toString() == cookie.path())
-			{
-				return;
-			}
-		}
-	}
-	else
-	{
-		WebBackend *backend = AddonsManager::getWebBackend();
-
-		domainItem = new QStandardItem(backend->getIconForUrl(QUrl(QStringLiteral("http://%1/").arg(domain))), domain);
-		domainItem->setToolTip(domain);
-
-		m_model->appendRow(domainItem);
-
-		if (sender())
-		{
-			m_model->sort(0);
-		}
-	}
-
-	QStandardItem *cookieItem = new QStandardItem(QString(cookie.name()));
-	cookieItem->setData(cookie.path(), Qt::UserRole);
-	cookieItem->setData(cookie.domain(), (Qt::UserRole + 1));
-	cookieItem->setToolTip(cookie.name());
-
-	domainItem->appendRow(cookieItem);
-	domainItem->setText(QStringLiteral("%1 (%2)").arg(domain).arg(domainItem->rowCount()));
-}
-
-void CookiesContentsWidget::removeCookie(const QNetworkCookie &cookie)
-{
-	const QString domain = (cookie.domain().startsWith('.') ? cookie.domain().mid(1) : cookie.domain());
-	QStandardItem *domainItem = findDomain(domain);
-
-	if (domainItem)
-	{
-		QPoint point;
-
-		for (int j = 0; j < domainItem->rowCount(); ++j)
-		{
-			if (domainItem->child(j, 0)->text() == cookie.name() && domainItem->child(j, 0)->data(Qt::UserRole).toString() == cookie.path())
-			{
-				point = m_ui->cookiesView->visualRect(domainItem->child(j, 0)->index()).center();
-
-				domainItem->removeRow(j);
-
-				break;
-			}
-		}
-
-		if (domainItem->rowCount() == 0)
-		{
-			m_model->invisibleRootItem()->removeRow(domainItem->row());
-		}
-		else
-		{
-			domainItem->setText(QStringLiteral("%1 (%2)").arg(domain).arg(domainItem->rowCount()));
-		}
-
-		if (!point.isNull())
-		{
-			const QModelIndex index = m_ui->cookiesView->indexAt(point);
-
-			m_ui->cookiesView->setCurrentIndex(index);
-			m_ui->cookiesView->selectionModel()->select(index, QItemSelectionModel::Select);
-		}
-	}
-}
-
 void CookiesContentsWidget::removeCookies()
 {
 	const QModelIndexList indexes = m_ui->cookiesView->selectionModel()->selectedIndexes();
@@ -186,43 +95,15 @@ void CookiesContentsWidget::removeCookies()
 		return;
 	}
 
+	const QPoint point = m_ui->cookiesView->visualRect(indexes.first()).center();
 	QNetworkCookieJar *cookieJar = NetworkManagerFactory::getCookieJar();
 	QList<QNetworkCookie> cookies;
 
 	for (int i = 0; i < indexes.count(); ++i)
 	{
-		if (!indexes.at(i).isValid())
-		{
-			continue;
-		}
-
-		if (indexes.at(i).data(Qt::UserRole).toString().isEmpty())
+		if (indexes.at(i).isValid())
 		{
-			QStandardItem *domainItem = m_model->itemFromIndex(indexes.at(i));
-
-			if (!domainItem)
-			{
-				continue;
-			}
-
-			for (int j = 0; j < domainItem->rowCount(); ++j)
-			{
-				QStandardItem *cookieItem = domainItem->child(j, 0);
-
-				if (cookieItem)
-				{
-					cookies.append(getCookie((cookieItem->index())));
-				}
-			}
-		}
-		else
-		{
-			QStandardItem *cookieItem = m_model->itemFromIndex(indexes.at(i));
-
-			if (cookieItem)
-			{
-				cookies.append(getCookie(cookieItem->index()));
-			}
+			cookies.append(m_model->getCookies(indexes.at(i)));
 		}
 	}
 
@@ -230,30 +111,26 @@ void CookiesContentsWidget::removeCookies()
 	{
 		cookieJar->deleteCookie(cookies.at(i));
 	}
+
+	const QModelIndex index = m_ui->cookiesView->indexAt(point);
+
+	if (index.isValid())
+	{
+		m_ui->cookiesView->setCurrentIndex(index);
+		m_ui->cookiesView->selectionModel()->select(index, QItemSelectionModel::Select);
+	}
 }
 
 void CookiesContentsWidget::removeDomainCookies()
 {
 	const QModelIndex index = m_ui->cookiesView->currentIndex();
-	QStandardItem *domainItem = ((index.isValid() && index.parent() == m_model->invisibleRootItem()->index()) ? findDomain(index.sibling(index.row(), 0).data(Qt::ToolTipRole).toString()) : m_model->itemFromIndex(index.parent()));
 
-	if (!domainItem)
+	if (!index.isValid())
 	{
 		return;
 	}
 
-	QNetworkCookieJar *cookieJar = NetworkManagerFactory::getCookieJar();
-	QList<QNetworkCookie> cookies;
-
-	for (int i = 0; i < domainItem->rowCount(); ++i)
-	{
-		QStandardItem *cookieItem = domainItem->child(i, 0);
-
-		if (cookieItem)
-		{
-			cookies.append(getCookie(cookieItem->index()));
-		}
-	}
+	const QList<QNetworkCookie> cookies = m_model->getCookies(index.parent().isValid() ? index.parent() : index);
 
 	if (cookies.isEmpty())
 	{
@@ -270,6 +147,8 @@ void CookiesContentsWidget::removeDomainCookies()
 
 	if (messageBox.exec() == QMessageBox::Yes)
 	{
+		QNetworkCookieJar *cookieJar = NetworkManagerFactory::getCookieJar();
+
 		for (int i = 0; i < cookies.count(); ++i)
 		{
 			cookieJar->deleteCookie(cookies.at(i));
@@ -300,7 +179,7 @@ void CookiesContentsWidget::showContextMenu(const QPoint &point)
 
 	if (index.isValid())
 	{
-		if (index.parent() != m_model->invisibleRootItem()->index())
+		if (index.parent().isValid())
 		{
 			menu.addAction(tr("Remove Cookie"), this, SLOT(removeCookies()));
 		}
@@ -362,52 +241,30 @@ void CookiesContentsWidget::updateActions()
 	m_ui->secureCheckBox->setChecked(false);
 	m_ui->httpOnlyCheckBox->setChecked(false);
 
-	if (indexes.count() == 1 && !indexes.first().data(Qt::UserRole).toString().isEmpty())
+	if (indexes.count() == 1 && indexes.first().parent().isValid())
 	{
-		const QModelIndex index = indexes.first();
-		QUrl url;
-		url.setScheme(QLatin1String("http"));
-		url.setHost(index.parent().data(Qt::ToolTipRole).toString());
-		url.setPath(index.data(Qt::UserRole).toString());
-
-		const QList<QNetworkCookie> cookies = NetworkManagerFactory::getCookieJar()->cookiesForUrl(url);
-
-		for (int i = 0; i < cookies.count(); ++i)
-		{
-			if (cookies.at(i).name() == index.data(Qt::DisplayRole).toString())
-			{
-				m_ui->domainLineEdit->setText(cookies.at(i).domain());
-				m_ui->nameLineEdit->setText(QString(cookies.at(i).name()));
-				m_ui->valueLineEdit->setText(QString(cookies.at(i).value()));
-				m_ui->expiresDateTimeEdit->setDateTime(cookies.at(i).expirationDate());
-				m_ui->secureCheckBox->setChecked(cookies.at(i).isSecure());
-				m_ui->httpOnlyCheckBox->setChecked(cookies.at(i).isHttpOnly());
-
-				break;
-			}
-		}
+		const QNetworkCookie cookie = m_model->getCookie(indexes.first());
+
+		m_ui->domainLineEdit->setText(cookie.domain());
+		m_ui->nameLineEdit->setText(QString(cookie.name()));
+		m_ui->valueLineEdit->setText(QString(cookie.value()));
+		m_ui->expiresDateTimeEdit->setDateTime(cookie.expirationDate());
+		m_ui->secureCheckBox->setChecked(cookie.isSecure());
+		m_ui->httpOnlyCheckBox->setChecked(cookie.isHttpOnly());
 	}
 }
 
 void CookiesContentsWidget::filterCookies(const QString &filter)
 {
-	for (int i = 0; i < m_model->rowCount(); ++i)
+	if (!m_model)
 	{
-		m_ui->cookiesView->setRowHidden(i, m_model->invisibleRootItem()->index(), (!filter.isEmpty() && !m_model->item(i, 0)->data(Qt::DisplayRole).toString().contains(filter, Qt::CaseInsensitive)));
+		return;
 	}
-}
 
-QStandardItem* CookiesContentsWidget::findDomain(const QString &domain)
-{
 	for (int i = 0; i < m_model->rowCount(); ++i)
 	{
-		if (domain == m_model->item(i, 0)->toolTip())
-		{
-			return m_model->item(i, 0);
-		}
+		m_ui->cookiesView->setRowHidden(i, QModelIndex(), (!filter.isEmpty() && !m_model->index(i, 0).data(Qt::ToolTipRole).toString().contains(filter, Qt::CaseInsensitive)));
 	}
-
-	return NULL;
 }
 
 Action* CookiesContentsWidget::getAction(int identifier)
@@ -451,15 +308,6 @@ QIcon CookiesContentsWidget::getIcon() const
 	return Utils::getIcon(QLatin1String("cookies"), false);
 }
 
-QNetworkCookie CookiesContentsWidget::getCookie(const QModelIndex &index) const
-{
-	QNetworkCookie cookie(index.data(Qt::DisplayRole).toString().toUtf8());
-	cookie.setDomain(index.data(Qt::UserRole + 1).toString());
-	cookie.setPath(index.data(Qt::UserRole).toString());
-
-	return cookie;
-}
-
 bool CookiesContentsWidget::isLoading() const
 {
 	return m_isLoading;
@@ -22,7 +22,6 @@
 
 #include "../../../ui/ContentsWidget.h"
 
-#include <QtGui/QStandardItemModel>
 #include <QtNetwork/QNetworkCookie>
 
 namespace Otter
@@ -33,6 +32,7 @@ namespace Ui
 	class CookiesContentsWidget;
 }
 
+class CookiesModel;
 class Window;
 
 class CookiesContentsWidget : public ContentsWidget
@@ -56,14 +56,10 @@ public slots:
 
 protected:
 	void changeEvent(QEvent *event);
-	QStandardItem* findDomain(const QString &domain);
-	QNetworkCookie getCookie(const QModelIndex &index) const;
 
 protected slots:
 	void populateCookies();
 	void filterCookies(const QString &filter);
-	void addCookie(const QNetworkCookie &cookie);
-	void removeCookie(const QNetworkCookie &cookie);
 	void removeCookies();
 	void removeDomainCookies();
 	void removeAllCookies();
@@ -71,7 +67,7 @@ protected slots:
 	void updateActions();
 
 private:
-	QStandardItemModel *m_model;
+	CookiesModel *m_model;
 	QHash<int, Action*> m_actions;
 	bool m_isLoading;
 	Ui::CookiesContentsWidget *m_ui;
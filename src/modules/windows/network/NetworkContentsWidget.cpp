@@ -0,0 +1,350 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "NetworkContentsWidget.h"
+#include "NetworkWaterfallDelegate.h"
+#include "../../../core/ActionsManager.h"
+#include "../../../core/NetworkPredictor.h"
+#include "../../../core/NetworkTimeline.h"
+#include "../../../core/SettingsManager.h"
+#include "../../../core/Utils.h"
+
+#include "ui_NetworkContentsWidget.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QMenu>
+#include <QtWidgets/QMessageBox>
+
+namespace Otter
+{
+
+NetworkContentsWidget::NetworkContentsWidget(Window *window) : ContentsWidget(window),
+	m_model(new QStandardItemModel(this)),
+	m_ui(new Ui::NetworkContentsWidget)
+{
+	m_ui->setupUi(this);
+	m_ui->networkView->setModel(m_model);
+	m_ui->networkView->setItemDelegateForColumn(5, new NetworkWaterfallDelegate(this));
+
+	populateTimelines();
+
+	connect(m_ui->filterLineEdit, SIGNAL(textChanged(QString)), this, SLOT(filterRequests(QString)));
+	connect(m_ui->networkView, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(showContextMenu(QPoint)));
+	connect(m_ui->networkView->selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)), this, SLOT(updateActions()));
+	connect(m_ui->refreshButton, SIGNAL(clicked()), this, SLOT(populateTimelines()));
+	connect(m_ui->exportButton, SIGNAL(clicked()), this, SLOT(exportTimeline()));
+}
+
+NetworkContentsWidget::~NetworkContentsWidget()
+{
+	delete m_ui;
+}
+
+void NetworkContentsWidget::changeEvent(QEvent *event)
+{
+	QWidget::changeEvent(event);
+
+	switch (event->type())
+	{
+		case QEvent::LanguageChange:
+			m_ui->retranslateUi(this);
+
+			break;
+		default:
+			break;
+	}
+}
+
+void NetworkContentsWidget::populateTimelines()
+{
+	m_model->clear();
+
+	QStringList labels;
+	labels << tr("Address") << tr("Status") << tr("Type") << tr("Size") << tr("Time") << tr("Timeline");
+
+	m_model->setHorizontalHeaderLabels(labels);
+
+	const QList<NetworkTimeline*> timelines = NetworkTimeline::getTimelines();
+
+	for (int i = 0; i < timelines.count(); ++i)
+	{
+		const QList<NetworkTimelinePage> pages = timelines.at(i)->getPages();
+		const QList<NetworkTimelineEntry> entries = timelines.at(i)->getEntries();
+		QHash<int, QStandardItem*> pageItems;
+		QHash<int, qint64> pageStartTimes;
+		QHash<int, qint64> pageDurations;
+		QHash<int, qint64> pageSizes;
+
+		for (int j = 0; j < pages.count(); ++j)
+		{
+			pageStartTimes[pages.at(j).identifier] = pages.at(j).startTime;
+			pageDurations[pages.at(j).identifier] = 0;
+			pageSizes[pages.at(j).identifier] = 0;
+		}
+
+		for (int j = 0; j < entries.count(); ++j)
+		{
+			const NetworkTimelineEntry &entry = entries.at(j);
+
+			if (pageStartTimes.contains(entry.page))
+			{
+				const qint64 endTime = qMax(entry.startTime, qMax(entry.responseTime, entry.finishTime));
+
+				pageDurations[entry.page] = qMax(pageDurations[entry.page], (endTime - pageStartTimes[entry.page]));
+				pageSizes[entry.page] += entry.size;
+			}
+		}
+
+		for (int j = 0; j < pages.count(); ++j)
+		{
+			QList<QStandardItem*> items;
+			items.append(new QStandardItem(Utils::getIcon(QLatin1String("text-html"), false), pages.at(j).url.toDisplayString()));
+			items[0]->setData(qVariantFromValue((void*) timelines.at(i)), Qt::UserRole);
+			items[0]->setToolTip(timelines.at(i)->getStartTime().addMSecs(pages.at(j).startTime).toString(Qt::SystemLocaleShortDate));
+			items.append(new QStandardItem());
+			items.append(new QStandardItem());
+			items.append(new QStandardItem(Utils::formatUnit(pageSizes[pages.at(j).identifier], false, 1)));
+			items.append(new QStandardItem(tr("%1 ms").arg(pageDurations[pages.at(j).identifier])));
+			items.append(new QStandardItem());
+
+			m_model->appendRow(items);
+
+			pageItems[pages.at(j).identifier] = items[0];
+		}
+
+		for (int j = 0; j < entries.count(); ++j)
+		{
+			const NetworkTimelineEntry &entry = entries.at(j);
+
+			if (!pageItems.contains(entry.page))
+			{
+				continue;
+			}
+
+			QString status;
+
+			if (entry.isBlocked)
+			{
+				status = tr("Blocked");
+			}
+			else if (entry.finishTime < 0)
+			{
+				status = tr("Pending");
+			}
+			else if (entry.isCached)
+			{
+				status = tr("%1 (cache)").arg(entry.statusCode);
+			}
+			else
+			{
+				status = QString::number(entry.statusCode);
+			}
+
+			const qint64 responseTime = ((entry.responseTime < 0) ? entry.startTime : entry.responseTime);
+			const qint64 finishTime = ((entry.finishTime < 0) ? responseTime : entry.finishTime);
+			QStandardItem *waterfallItem = new QStandardItem();
+			waterfallItem->setData((entry.startTime - pageStartTimes[entry.page]), NetworkWaterfallDelegate::StartRole);
+			waterfallItem->setData((responseTime - entry.startTime), NetworkWaterfallDelegate::WaitRole);
+			waterfallItem->setData((finishTime - responseTime), NetworkWaterfallDelegate::ReceiveRole);
+			waterfallItem->setData(pageDurations[entry.page], NetworkWaterfallDelegate::DurationRole);
+			waterfallItem->setToolTip(tr("Waiting: %1 ms\nReceiving: %2 ms").arg(responseTime - entry.startTime).arg(finishTime - responseTime));
+
+			QList<QStandardItem*> items;
+			items.append(new QStandardItem(entry.url.toDisplayString()));
+			items[0]->setToolTip(QStringLiteral("%1 %2").arg(entry.method).arg(entry.url.toDisplayString()));
+			items.append(new QStandardItem(status));
+			items.append(new QStandardItem(entry.mimeType));
+			items.append(new QStandardItem(Utils::formatUnit(entry.size, false, 1)));
+			items.append(new QStandardItem(tr("%1 ms").arg(finishTime - entry.startTime)));
+			items.append(waterfallItem);
+
+			pageItems[entry.page]->appendRow(items);
+		}
+
+		QHash<int, QStandardItem*>::const_iterator iterator;
+
+		for (iterator = pageItems.constBegin(); iterator != pageItems.constEnd(); ++iterator)
+		{
+			m_model->item(iterator.value()->row(), 1)->setText(tr("%n request(s)", "", iterator.value()->rowCount()));
+		}
+	}
+
+	m_ui->networkView->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+	m_ui->networkView->header()->setStretchLastSection(false);
+	m_ui->networkView->header()->resizeSection(5, 200);
+
+	const QVariantHash statistics = NetworkPredictor::getStatistics();
+
+	m_ui->predictorLabel->setText(tr("Predicted hosts: %1 resolved, %2 preconnected, %3% of navigations predicted").arg(statistics.value(QLatin1String("lookups")).toInt()).arg(statistics.value(QLatin1String("preconnects")).toInt()).arg(statistics.value(QLatin1String("hitRate")).toInt()));
+
+	filterRequests(m_ui->filterLineEdit->text());
+	updateActions();
+}
+
+void NetworkContentsWidget::filterRequests(const QString &filter)
+{
+	for (int i = 0; i < m_model->rowCount(); ++i)
+	{
+		QStandardItem *pageItem = m_model->item(i, 0);
+		bool hasMatch = (filter.isEmpty() || pageItem->text().contains(filter, Qt::CaseInsensitive));
+
+		for (int j = 0; j < pageItem->rowCount(); ++j)
+		{
+			const bool isMatch = (filter.isEmpty() || pageItem->child(j, 0)->text().contains(filter, Qt::CaseInsensitive));
+
+			m_ui->networkView->setRowHidden(j, pageItem->index(), !isMatch);
+
+			if (isMatch)
+			{
+				hasMatch = true;
+			}
+		}
+
+		m_ui->networkView->setRowHidden(i, QModelIndex(), !hasMatch);
+	}
+}
+
+void NetworkContentsWidget::exportTimeline()
+{
+	NetworkTimeline *timeline = getTimeline(m_ui->networkView->currentIndex());
+
+	if (!timeline)
+	{
+		return;
+	}
+
+	const QString path = QFileDialog::getSaveFileName(this, tr("Export as HAR"), SettingsManager::getValue(QLatin1String("Paths/SaveFile")).toString() + QDir::separator() + QLatin1String("network.har"), tr("HTTP Archive files (*.har)"));
+
+	if (path.isEmpty())
+	{
+		return;
+	}
+
+	QFile file(path);
+
+	if (!file.open(QIODevice::WriteOnly) || file.write(timeline->exportHar().toJson()) < 0)
+	{
+		QMessageBox::critical(this, tr("Error"), tr("Failed to save network timeline:\n%1").arg(file.errorString()), QMessageBox::Close);
+	}
+}
+
+void NetworkContentsWidget::showContextMenu(const QPoint &point)
+{
+	QMenu menu(this);
+	menu.addAction(tr("Export as HAR…"), this, SLOT(exportTimeline()))->setEnabled(getTimeline(m_ui->networkView->indexAt(point)) != NULL);
+	menu.addSeparator();
+	menu.addAction(tr("Refresh"), this, SLOT(populateTimelines()));
+	menu.exec(m_ui->networkView->mapToGlobal(point));
+}
+
+void NetworkContentsWidget::updateActions()
+{
+	m_ui->exportButton->setEnabled(getTimeline(m_ui->networkView->currentIndex()) != NULL);
+}
+
+void NetworkContentsWidget::print(QPrinter *printer)
+{
+	m_ui->networkView->render(printer);
+}
+
+void NetworkContentsWidget::triggerAction(int identifier, bool checked)
+{
+	Q_UNUSED(checked)
+
+	switch (identifier)
+	{
+		case ActionsManager::ReloadAction:
+		case ActionsManager::ReloadOrStopAction:
+			populateTimelines();
+
+			break;
+		case ActionsManager::FindAction:
+		case ActionsManager::QuickFindAction:
+		case ActionsManager::ActivateAddressFieldAction:
+			m_ui->filterLineEdit->setFocus();
+
+			break;
+		default:
+			break;
+	}
+}
+
+Action* NetworkContentsWidget::getAction(int identifier)
+{
+	if (m_actions.contains(identifier))
+	{
+		return m_actions[identifier];
+	}
+
+	if (identifier != ActionsManager::ReloadAction)
+	{
+		return NULL;
+	}
+
+	Action *action = new Action(identifier, this);
+
+	m_actions[identifier] = action;
+
+	connect(action, SIGNAL(triggered()), this, SLOT(triggerAction()));
+
+	return action;
+}
+
+NetworkTimeline* NetworkContentsWidget::getTimeline(const QModelIndex &index) const
+{
+	if (!index.isValid())
+	{
+		return NULL;
+	}
+
+	const QModelIndex pageIndex = (index.parent().isValid() ? index.parent() : index).sibling((index.parent().isValid() ? index.parent() : index).row(), 0);
+	NetworkTimeline *timeline = static_cast<NetworkTimeline*>(pageIndex.data(Qt::UserRole).value<void*>());
+
+	return (NetworkTimeline::getTimelines().contains(timeline) ? timeline : NULL);
+}
+
+QString NetworkContentsWidget::getTitle() const
+{
+	return tr("Network Timeline");
+}
+
+QLatin1String NetworkContentsWidget::getType() const
+{
+	return QLatin1String("network");
+}
+
+QUrl NetworkContentsWidget::getUrl() const
+{
+	return QUrl(QLatin1String("about:network"));
+}
+
+QIcon NetworkContentsWidget::getIcon() const
+{
+	return Utils::getIcon(QLatin1String("text-html"), false);
+}
+
+bool NetworkContentsWidget::isLoading() const
+{
+	return false;
+}
+
+}
@@ -0,0 +1,76 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_NETWORKCONTENTSWIDGET_H
+#define OTTER_NETWORKCONTENTSWIDGET_H
+
+#include "../../../ui/ContentsWidget.h"
+
+#include <QtGui/QStandardItemModel>
+
+namespace Otter
+{
+
+namespace Ui
+{
+	class NetworkContentsWidget;
+}
+
+class NetworkTimeline;
+class Window;
+
+class NetworkContentsWidget : public ContentsWidget
+{
+	Q_OBJECT
+
+public:
+	explicit NetworkContentsWidget(Window *window);
+	~NetworkContentsWidget();
+
+	void print(QPrinter *printer);
+	Action* getAction(int identifier);
+	QString getTitle() const;
+	QLatin1String getType() const;
+	QUrl getUrl() const;
+	QIcon getIcon() const;
+	bool isLoading() const;
+
+public slots:
+	void triggerAction(int identifier, bool checked = false);
+
+protected:
+	void changeEvent(QEvent *event);
+	NetworkTimeline* getTimeline(const QModelIndex &index) const;
+
+protected slots:
+	void populateTimelines();
+	void filterRequests(const QString &filter);
+	void exportTimeline();
+	void showContextMenu(const QPoint &point);
+	void updateActions();
+
+private:
+	QStandardItemModel *m_model;
+	QHash<int, Action*> m_actions;
+	Ui::NetworkContentsWidget *m_ui;
+};
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2015 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "NetworkWaterfallDelegate.h"
+
+#include <QtGui/QPainter>
+#include <QtWidgets/QApplication>
+
+namespace Otter
+{
+
+NetworkWaterfallDelegate::NetworkWaterfallDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+}
+
+void NetworkWaterfallDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+	QApplication::style()->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, 0);
+
+	const qreal duration = index.data(DurationRole).toLongLong();
+
+	if (duration <= 0)
+	{
+		return;
+	}
+
+	const qreal scale = ((option.rect.width() - 4) / duration);
+	const qreal start = (option.rect.left() + 2 + (index.data(StartRole).toLongLong() * scale));
+	const qreal wait = qMax(qreal(1), (index.data(WaitRole).toLongLong() * scale));
+	const qreal receive = qMax(qreal(1), (index.data(ReceiveRole).toLongLong() * scale));
+	const qreal height = (option.rect.height() / 2.0);
+	const qreal top = (option.rect.top() + (height / 2));
+
+	painter->save();
+	painter->fillRect(QRectF(start, top, wait, height), option.palette.color(QPalette::Mid));
+	painter->fillRect(QRectF((start + wait), top, receive, height), option.palette.color(QPalette::Highlight));
+	painter->restore();
+}
+
+}
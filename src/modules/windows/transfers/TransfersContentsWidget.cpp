@@ -32,7 +32,9 @@
 #include <QtCore/QQueue>
 #include <QtGui/QClipboard>
 #include <QtGui/QKeyEvent>
+#include <QtWidgets/QActionGroup>
 #include <QtWidgets/QApplication>
+#include <QtWidgets/QInputDialog>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QMessageBox>
 
@@ -210,6 +212,23 @@ void TransfersContentsWidget::updateTransfer(Transfer *transfer)
 	else
 	{
 		m_speeds.remove(transfer);
+
+		if (transfer->getState() == Transfer::QueuedState)
+		{
+			remainingTime = tr("Queued");
+		}
+		else if (transfer->getVerificationState() == Transfer::VerifyingState)
+		{
+			remainingTime = tr("Verifying…");
+		}
+		else if (transfer->getVerificationState() == Transfer::VerifiedState)
+		{
+			remainingTime = tr("Verified");
+		}
+		else if (transfer->getVerificationState() == Transfer::CorruptedState)
+		{
+			remainingTime = tr("Checksum mismatch");
+		}
 	}
 
 	QIcon icon;
@@ -221,12 +240,16 @@ void TransfersContentsWidget::updateTransfer(Transfer *transfer)
 
 			break;
 		case Transfer::FinishedState:
-			icon = Utils::getIcon(QLatin1String("task-complete"));
+			icon = Utils::getIcon((transfer->getVerificationState() == Transfer::CorruptedState) ? QLatin1String("dialog-warning") : QLatin1String("task-complete"));
 
 			break;
 		case Transfer::ErrorState:
 			icon = Utils::getIcon(QLatin1String("task-reject"));
 
+			break;
+		case Transfer::QueuedState:
+			icon = Utils::getIcon(QLatin1String("media-playback-pause"));
+
 			break;
 		default:
 			break;
@@ -241,7 +264,7 @@ void TransfersContentsWidget::updateTransfer(Transfer *transfer)
 	m_model->item(row, 6)->setText(transfer->getTimeStarted().toString(QLatin1String("yyyy-MM-dd HH:mm:ss")));
 	m_model->item(row, 7)->setText(transfer->getTimeFinished().toString(QLatin1String("yyyy-MM-dd HH:mm:ss")));
 
-	const QString tooltip = tr("<div style=\"white-space:pre;\">Source: %1\nTarget: %2\nSize: %3\nDownloaded: %4\nProgress: %5</div>").arg(transfer->getSource().toString().toHtmlEscaped()).arg(transfer->getTarget().toHtmlEscaped()).arg((transfer->getBytesTotal() > 0) ? tr("%1 (%n B)", "", transfer->getBytesTotal()).arg(Utils::formatUnit(transfer->getBytesTotal())) : QString('?')).arg(tr("%1 (%n B)", "", transfer->getBytesReceived()).arg(Utils::formatUnit(transfer->getBytesReceived()))).arg(QStringLiteral("%1%").arg(((transfer->getBytesTotal() > 0) ? (((qreal) transfer->getBytesReceived() / transfer->getBytesTotal()) * 100) : 0.0), 0, 'f', 1));
+	const QString tooltip = tr("<div style=\"white-space:pre;\">Source: %1\nTarget: %2\nSize: %3\nDownloaded: %4\nProgress: %5%6</div>").arg(transfer->getSource().toString().toHtmlEscaped()).arg(transfer->getTarget().toHtmlEscaped()).arg((transfer->getBytesTotal() > 0) ? tr("%1 (%n B)", "", transfer->getBytesTotal()).arg(Utils::formatUnit(transfer->getBytesTotal())) : QString('?')).arg(tr("%1 (%n B)", "", transfer->getBytesReceived()).arg(Utils::formatUnit(transfer->getBytesReceived()))).arg(QStringLiteral("%1%").arg(((transfer->getBytesTotal() > 0) ? (((qreal) transfer->getBytesReceived() / transfer->getBytesTotal()) * 100) : 0.0), 0, 'f', 1).arg(transfer->getChecksum().isEmpty() ? QString() : QLatin1Char('\n') + tr("Checksum: %1").arg(transfer->getChecksum().toHtmlEscaped())));
 
 	for (int i = 0; i < m_model->columnCount(); ++i)
 	{
@@ -334,7 +357,7 @@ void TransfersContentsWidget::stopResumeTransfer()
 
 	if (transfer)
 	{
-		if (transfer->getState() == Transfer::RunningState)
+		if (transfer->getState() == Transfer::RunningState || transfer->getState() == Transfer::QueuedState)
 		{
 			transfer->stop();
 		}
@@ -347,6 +370,26 @@ void TransfersContentsWidget::stopResumeTransfer()
 	}
 }
 
+void TransfersContentsWidget::setTransferPriority(QAction *action)
+{
+	Transfer *transfer = getTransfer(m_ui->transfersView->currentIndex());
+
+	if (transfer && action)
+	{
+		transfer->setPriority(static_cast<Transfer::TransferPriority>(action->data().toInt()));
+	}
+}
+
+void TransfersContentsWidget::setTransferBandwidthLimit(QAction *action)
+{
+	Transfer *transfer = getTransfer(m_ui->transfersView->currentIndex());
+
+	if (transfer && action)
+	{
+		transfer->setBandwidthLimit(action->data().toLongLong());
+	}
+}
+
 void TransfersContentsWidget::redownloadTransfer()
 {
 	Transfer *transfer = getTransfer(m_ui->transfersView->selectionModel()->hasSelection() ? m_ui->transfersView->selectionModel()->currentIndex() : QModelIndex());
@@ -357,6 +400,25 @@ void TransfersContentsWidget::redownloadTransfer()
 	}
 }
 
+void TransfersContentsWidget::verifyTransfer()
+{
+	Transfer *transfer = getTransfer(m_ui->transfersView->selectionModel()->hasSelection() ? m_ui->transfersView->selectionModel()->currentIndex() : QModelIndex());
+
+	if (!transfer)
+	{
+		return;
+	}
+
+	bool isAccepted = false;
+	const QString checksum = QInputDialog::getText(this, tr("Verify Checksum"), tr("Expected checksum (MD5, SHA-1, SHA-256 or SHA-512):"), QLineEdit::Normal, transfer->getExpectedChecksum(), &isAccepted);
+
+	if (isAccepted)
+	{
+		transfer->setExpectedChecksum(checksum);
+		transfer->verify();
+	}
+}
+
 void TransfersContentsWidget::startQuickTransfer()
 {
 	TransfersManager::startTransfer(m_ui->downloadLineEdit->text(), QString(), true, SessionsManager::isPrivate());
@@ -399,8 +461,63 @@ void TransfersContentsWidget::showContextMenu(const QPoint &point)
 
 		menu.addAction(tr("Open Folder"), this, SLOT(openTransferFolder()));
 		menu.addSeparator();
-		menu.addAction(((transfer->getState() == Transfer::ErrorState) ? tr("Resume") : tr("Stop")), this, SLOT(stopResumeTransfer()))->setEnabled(transfer->getState() == Transfer::RunningState || transfer->getState() == Transfer::ErrorState);
+		menu.addAction(((transfer->getState() == Transfer::ErrorState) ? tr("Resume") : tr("Stop")), this, SLOT(stopResumeTransfer()))->setEnabled(transfer->getState() == Transfer::RunningState || transfer->getState() == Transfer::ErrorState || transfer->getState() == Transfer::QueuedState);
 		menu.addAction(tr("Redownload"), this, SLOT(redownloadTransfer()));
+		menu.addAction(tr("Verify Checksum…"), this, SLOT(verifyTransfer()))->setEnabled(transfer->getState() == Transfer::FinishedState && transfer->getVerificationState() != Transfer::VerifyingState);
+		menu.addSeparator();
+
+		QMenu *priorityMenu = menu.addMenu(tr("Priority"));
+		QActionGroup *priorityGroup = new QActionGroup(priorityMenu);
+		priorityGroup->setExclusive(true);
+
+		QAction *highPriorityAction = priorityMenu->addAction(tr("High"));
+		highPriorityAction->setData(Transfer::HighPriority);
+
+		QAction *normalPriorityAction = priorityMenu->addAction(tr("Normal"));
+		normalPriorityAction->setData(Transfer::NormalPriority);
+
+		QAction *lowPriorityAction = priorityMenu->addAction(tr("Low"));
+		lowPriorityAction->setData(Transfer::LowPriority);
+
+		for (int i = 0; i < priorityMenu->actions().count(); ++i)
+		{
+			QAction *action = priorityMenu->actions().at(i);
+			action->setCheckable(true);
+			action->setChecked(action->data().toInt() == transfer->getPriority());
+
+			priorityGroup->addAction(action);
+		}
+
+		connect(priorityMenu, SIGNAL(triggered(QAction*)), this, SLOT(setTransferPriority(QAction*)));
+
+		QMenu *bandwidthMenu = menu.addMenu(tr("Speed Limit"));
+		QActionGroup *bandwidthGroup = new QActionGroup(bandwidthMenu);
+		bandwidthGroup->setExclusive(true);
+		bandwidthMenu->addAction(tr("Unlimited"))->setData(0);
+		bandwidthMenu->addSeparator();
+
+		const QList<int> limits = (QList<int>() << 64 << 256 << 1024 << 4096);
+
+		for (int i = 0; i < limits.count(); ++i)
+		{
+			bandwidthMenu->addAction(Utils::formatUnit((limits.at(i) * 1024), true, 0))->setData(limits.at(i) * 1024);
+		}
+
+		for (int i = 0; i < bandwidthMenu->actions().count(); ++i)
+		{
+			QAction *action = bandwidthMenu->actions().at(i);
+
+			if (!action->isSeparator())
+			{
+				action->setCheckable(true);
+				action->setChecked(action->data().toLongLong() == transfer->getBandwidthLimit());
+
+				bandwidthGroup->addAction(action);
+			}
+		}
+
+		connect(bandwidthMenu, SIGNAL(triggered(QAction*)), this, SLOT(setTransferBandwidthLimit(QAction*)));
+
 		menu.addSeparator();
 		menu.addAction(tr("Copy Transfer Information"), this, SLOT(copyTransferInformation()));
 		menu.addSeparator();
@@ -437,7 +554,7 @@ void TransfersContentsWidget::updateActions()
 		m_ui->stopResumeButton->setIcon(Utils::getIcon(QLatin1String("task-reject")));
 	}
 
-	m_ui->stopResumeButton->setEnabled(transfer && (transfer->getState() == Transfer::RunningState || transfer->getState() == Transfer::ErrorState));
+	m_ui->stopResumeButton->setEnabled(transfer && (transfer->getState() == Transfer::RunningState || transfer->getState() == Transfer::ErrorState || transfer->getState() == Transfer::QueuedState));
 	m_ui->redownloadButton->setEnabled(transfer);
 
 	getAction(ActionsManager::CopyAction)->setEnabled(transfer);
@@ -450,6 +567,26 @@ void TransfersContentsWidget::updateActions()
 		m_ui->sizeLabelWidget->setText((transfer->getBytesTotal() > 0) ? tr("%1 (%n B)", "", transfer->getBytesTotal()).arg(Utils::formatUnit(transfer->getBytesTotal())) : QString('?'));
 		m_ui->downloadedLabelWidget->setText(tr("%1 (%n B)", "", transfer->getBytesReceived()).arg(Utils::formatUnit(transfer->getBytesReceived())));
 		m_ui->progressLabelWidget->setText(QStringLiteral("%1%").arg(((transfer->getBytesTotal() > 0) ? (((qreal) transfer->getBytesReceived() / transfer->getBytesTotal()) * 100) : 0.0), 0, 'f', 1));
+
+		switch (transfer->getVerificationState())
+		{
+			case Transfer::VerifyingState:
+				m_ui->checksumLabelWidget->setText(tr("Verifying…"));
+
+				break;
+			case Transfer::VerifiedState:
+				m_ui->checksumLabelWidget->setText(tr("%1 (verified)").arg(transfer->getChecksum()));
+
+				break;
+			case Transfer::CorruptedState:
+				m_ui->checksumLabelWidget->setText(tr("%1 (expected %2)").arg(transfer->getChecksum().isEmpty() ? tr("unreadable") : transfer->getChecksum()).arg(transfer->getExpectedChecksum()));
+
+				break;
+			default:
+				m_ui->checksumLabelWidget->setText(transfer->getChecksum());
+
+				break;
+		}
 	}
 	else
 	{
@@ -458,6 +595,7 @@ void TransfersContentsWidget::updateActions()
 		m_ui->sizeLabelWidget->clear();
 		m_ui->downloadedLabelWidget->clear();
 		m_ui->progressLabelWidget->clear();
+		m_ui->checksumLabelWidget->clear();
 	}
 }
 
@@ -70,7 +70,10 @@ protected slots:
 	void openTransferFolder(const QModelIndex &index = QModelIndex());
 	void copyTransferInformation();
 	void stopResumeTransfer();
+	void setTransferPriority(QAction *action);
+	void setTransferBandwidthLimit(QAction *action);
 	void redownloadTransfer();
+	void verifyTransfer();
 	void startQuickTransfer();
 	void clearFinishedTransfers();
 	void showContextMenu(const QPoint &point);
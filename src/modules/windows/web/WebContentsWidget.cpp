@@ -26,10 +26,12 @@
 #endif
 #include "../../../core/AddonsManager.h"
 #include "../../../core/SettingsManager.h"
+#include "../../../core/ThumbnailsManager.h"
 #include "../../../core/Utils.h"
 #include "../../../core/WebBackend.h"
 #include "../../../ui/MainWindow.h"
 
+#include <QtGui/QBackingStore>
 #include <QtGui/QMouseEvent>
 
 namespace Otter
@@ -45,6 +47,7 @@ WebContentsWidget::WebContentsWidget(bool isPrivate, WebWidget *widget, Window *
 	m_progressBarWidget(NULL),
 	m_quickFindTimer(0),
 	m_startPageTimer(0),
+	m_thumbnailTimer(0),
 	m_isTabPreferencesMenuVisible(false),
 	m_showStartPage(SettingsManager::getValue(QLatin1String("StartPage/EnableStartPage")).toBool())
 {
@@ -93,6 +96,8 @@ WebContentsWidget::WebContentsWidget(bool isPrivate, WebWidget *widget, Window *
 	connect(m_webWidget, SIGNAL(loadingChanged(bool)), this, SIGNAL(loadingChanged(bool)));
 	connect(m_webWidget, SIGNAL(loadingChanged(bool)), this, SLOT(setLoading(bool)));
 	connect(m_webWidget, SIGNAL(zoomChanged(int)), this, SIGNAL(zoomChanged(int)));
+	connect(m_webWidget, SIGNAL(scrollPositionChanged(QPoint)), this, SIGNAL(scrollPositionChanged(QPoint)));
+	connect(m_webWidget, SIGNAL(optionsChanged()), this, SIGNAL(optionsChanged()));
 }
 
 void WebContentsWidget::timerEvent(QTimerEvent *event)
@@ -113,10 +118,48 @@ void WebContentsWidget::timerEvent(QTimerEvent *event)
 
 		handleUrlChange(m_webWidget->getRequestedUrl());
 	}
+	else if (event->timerId() == m_thumbnailTimer)
+	{
+		killTimer(m_thumbnailTimer);
+
+		m_thumbnailTimer = 0;
+
+// capture only what is already displayed, scaling is done by thumbnails manager in separate thread
+		if (isVisible() && !isLoading() && getParent())
+		{
+			QBackingStore *backingStore = window()->backingStore();
+			QImage thumbnail;
+
+// raster backing store already holds painted contents, so they are copied instead of rendering widget again
+			if (backingStore && backingStore->paintDevice() && backingStore->paintDevice()->devType() == QInternal::Image)
+			{
+				const QImage *image = static_cast<QImage*>(backingStore->paintDevice());
+				const qreal ratio = image->devicePixelRatio();
+
+				thumbnail = image->copy(QRect((mapTo(window(), QPoint(0, 0)) * ratio), (size() * ratio)));
+			}
+			else
+			{
+				thumbnail = grab().toImage();
+			}
+
+			ThumbnailsManager::updateThumbnail(getParent()->getIdentifier(), thumbnail);
+		}
+	}
 
 	ContentsWidget::timerEvent(event);
 }
 
+void WebContentsWidget::showEvent(QShowEvent *event)
+{
+	ContentsWidget::showEvent(event);
+
+	if (!isLoading() && m_thumbnailTimer == 0)
+	{
+		m_thumbnailTimer = startTimer(1000);
+	}
+}
+
 void WebContentsWidget::focusInEvent(QFocusEvent *event)
 {
 	QWidget::focusInEvent(event);
@@ -518,6 +561,18 @@ void WebContentsWidget::updateFindHighlight(WebWidget::FindFlags flags)
 
 void WebContentsWidget::setLoading(bool loading)
 {
+	if (m_thumbnailTimer != 0)
+	{
+		killTimer(m_thumbnailTimer);
+
+		m_thumbnailTimer = 0;
+	}
+
+	if (!loading && isVisible())
+	{
+		m_thumbnailTimer = startTimer(1000);
+	}
+
 	if (!m_progressBarWidget && !SettingsManager::getValue(QLatin1String("Browser/ShowDetailedProgressBar")).toBool())
 	{
 		return;
@@ -544,6 +599,11 @@ void WebContentsWidget::setZoom(int zoom)
 	m_webWidget->setZoom(zoom);
 }
 
+void WebContentsWidget::setThrottled(bool throttled)
+{
+	m_webWidget->setThrottled(throttled);
+}
+
 void WebContentsWidget::setUrl(const QUrl &url, bool typed)
 {
 	m_webWidget->setRequestedUrl(url, typed);
@@ -622,11 +682,6 @@ QIcon WebContentsWidget::getIcon() const
 	return m_webWidget->getIcon();
 }
 
-QPixmap WebContentsWidget::getThumbnail() const
-{
-	return m_webWidget->getThumbnail();
-}
-
 WindowHistoryInformation WebContentsWidget::getHistory() const
 {
 	return m_webWidget->getHistory();
@@ -657,6 +712,11 @@ bool WebContentsWidget::isLoading() const
 	return m_webWidget->isLoading();
 }
 
+bool WebContentsWidget::isPlayingMedia() const
+{
+	return m_webWidget->isPlayingMedia();
+}
+
 bool WebContentsWidget::isPrivate() const
 {
 	return m_webWidget->isPrivate();
@@ -53,13 +53,13 @@ public:
 	QVariant getOption(const QString &key) const;
 	QUrl getUrl() const;
 	QIcon getIcon() const;
-	QPixmap getThumbnail() const;
 	WindowHistoryInformation getHistory() const;
 	QList<FeedUrl> getFeeds() const;
 	int getZoom() const;
 	bool canClone() const;
 	bool canZoom() const;
 	bool isLoading() const;
+	bool isPlayingMedia() const;
 	bool isPrivate() const;
 
 public slots:
@@ -68,10 +68,12 @@ public slots:
 	void setOption(const QString &key, const QVariant &value);
 	void setHistory(const WindowHistoryInformation &history);
 	void setZoom(int zoom);
+	void setThrottled(bool throttled);
 	void setUrl(const QUrl &url, bool typed = true);
 
 protected:
 	void timerEvent(QTimerEvent *event);
+	void showEvent(QShowEvent *event);
 	void focusInEvent(QFocusEvent *event);
 	void resizeEvent(QResizeEvent *event);
 	void keyPressEvent(QKeyEvent *event);
@@ -97,6 +99,7 @@ private:
 	QList<PermissionBarWidget*> m_permissionBarWidgets;
 	int m_quickFindTimer;
 	int m_startPageTimer;
+	int m_thumbnailTimer;
 	bool m_isTabPreferencesMenuVisible;
 	bool m_showStartPage;
 
@@ -54,7 +54,6 @@ void ConsoleWidget::showEvent(QShowEvent *event)
 	if (!m_model)
 	{
 		m_model = new QStandardItemModel(this);
-		m_model->setSortRole(Qt::UserRole);
 
 		const QList<ConsoleMessage*> messages = Console::getMessages();
 
@@ -65,13 +64,19 @@ void ConsoleWidget::showEvent(QShowEvent *event)
 
 		m_ui->consoleView->setModel(m_model);
 
-		connect(Console::getInstance(), SIGNAL(messageAdded(ConsoleMessage*)), this, SLOT(addMessage(ConsoleMessage*)));
+		connect(Console::getInstance(), SIGNAL(messageAdded(quint64)), this, SLOT(addMessage(quint64)));
+		connect(Console::getInstance(), SIGNAL(messageChanged(quint64)), this, SLOT(updateMessage(quint64)));
 	}
 
 	QWidget::showEvent(event);
 }
 
-void ConsoleWidget::addMessage(ConsoleMessage *message)
+void ConsoleWidget::addMessage(quint64 identifier)
+{
+	addMessage(Console::getMessage(identifier));
+}
+
+void ConsoleWidget::addMessage(const ConsoleMessage *message)
 {
 	if (!m_model || !message)
 	{
@@ -118,7 +123,9 @@ void ConsoleWidget::addMessage(ConsoleMessage *message)
 	}
 
 	const QString source = message->source + ((message->line > 0) ? QStringLiteral(":%1").arg(message->line) : QString());
-	QString entry = QStringLiteral("[%1] %2").arg(message->time.toString()).arg(category);
+	const QDateTime time = QDateTime::fromMSecsSinceEpoch(message->time);
+	const QString note = Console::getNote(message);
+	QString entry = QStringLiteral("[%1] %2").arg(time.toString()).arg(category);
 
 	if (!message->source.isEmpty())
 	{
@@ -126,18 +133,52 @@ void ConsoleWidget::addMessage(ConsoleMessage *message)
 	}
 
 	QStandardItem *parentItem = new QStandardItem(icon, entry);
-	parentItem->setData(message->time.toTime_t(), Qt::UserRole);
+	parentItem->setData(time.toTime_t(), Qt::UserRole);
 	parentItem->setData(message->category, (Qt::UserRole + 1));
 	parentItem->setData(source, (Qt::UserRole + 2));
 	parentItem->setData(message->window, (Qt::UserRole + 3));
+	parentItem->setData(message->identifier, (Qt::UserRole + 4));
+
+	if (!note.isEmpty())
+	{
+		parentItem->appendRow(new QStandardItem(note));
+	}
 
-	if (!message->note.isEmpty())
+	m_model->insertRow(0, parentItem);
+
+	if (m_model->rowCount() > Console::getMessagesLimit())
 	{
-		parentItem->appendRow(new QStandardItem(message->note));
+		m_model->removeRow(m_model->rowCount() - 1);
+	}
+}
+
+void ConsoleWidget::updateMessage(quint64 identifier)
+{
+	const ConsoleMessage *message = Console::getMessage(identifier);
+
+	if (!m_model || !message)
+	{
+		return;
 	}
 
-	m_model->appendRow(parentItem);
-	m_model->sort(0, Qt::DescendingOrder);
+	for (int i = 0; i < m_model->rowCount(); ++i)
+	{
+		QStandardItem *item = m_model->item(i, 0);
+
+		if (item && item->data(Qt::UserRole + 4).toULongLong() == message->identifier)
+		{
+			if (item->child(0, 0))
+			{
+				item->child(0, 0)->setText(Console::getNote(message));
+			}
+			else
+			{
+				item->appendRow(new QStandardItem(Console::getNote(message)));
+			}
+
+			break;
+		}
+	}
 }
 
 void ConsoleWidget::clear()
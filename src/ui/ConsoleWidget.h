@@ -43,9 +43,11 @@ public:
 
 protected:
 	void showEvent(QShowEvent *event);
+	void addMessage(const ConsoleMessage *message);
 
 protected slots:
-	void addMessage(ConsoleMessage *message);
+	void addMessage(quint64 identifier);
+	void updateMessage(quint64 identifier);
 	void clear();
 	void copyText();
 	void filterCategories();
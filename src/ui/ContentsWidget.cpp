@@ -194,6 +194,11 @@ void ContentsWidget::setZoom(int zoom)
 	Q_UNUSED(zoom)
 }
 
+void ContentsWidget::setThrottled(bool throttled)
+{
+	Q_UNUSED(throttled)
+}
+
 void ContentsWidget::setUrl(const QUrl &url, bool typed)
 {
 	Q_UNUSED(url)
@@ -239,11 +244,6 @@ QString ContentsWidget::getStatusMessage() const
 	return QString();
 }
 
-QPixmap ContentsWidget::getThumbnail() const
-{
-	return QPixmap();
-}
-
 WindowHistoryInformation ContentsWidget::getHistory() const
 {
 	WindowHistoryEntry entry;
@@ -284,6 +284,11 @@ bool ContentsWidget::isLoading() const
 	return false;
 }
 
+bool ContentsWidget::isPlayingMedia() const
+{
+	return false;
+}
+
 bool ContentsWidget::isPrivate() const
 {
 	return false;
@@ -55,13 +55,13 @@ public:
 	virtual QLatin1String getType() const = 0;
 	virtual QUrl getUrl() const = 0;
 	virtual QIcon getIcon() const = 0;
-	virtual QPixmap getThumbnail() const;
 	virtual WindowHistoryInformation getHistory() const;
 	virtual QList<FeedUrl> getFeeds() const;
 	virtual int getZoom() const;
 	virtual bool canClone() const;
 	virtual bool canZoom() const;
 	virtual bool isLoading() const;
+	virtual bool isPlayingMedia() const;
 	virtual bool isPrivate() const;
 
 public slots:
@@ -71,6 +71,7 @@ public slots:
 	void showDialog(ContentsDialog *dialog);
 	virtual void setHistory(const WindowHistoryInformation &history);
 	virtual void setZoom(int zoom);
+	virtual void setThrottled(bool throttled);
 	virtual void setUrl(const QUrl &url, bool typed = true);
 
 protected:
@@ -100,6 +101,8 @@ signals:
 	void iconChanged(const QIcon &icon);
 	void loadingChanged(bool loading);
 	void zoomChanged(int zoom);
+	void scrollPositionChanged(const QPoint &position);
+	void optionsChanged();
 };
 
 }
@@ -145,12 +145,20 @@ MainWindow::MainWindow(bool isPrivate, const SessionMainWindow &session, QWidget
 	connect(ActionsManager::getInstance(), SIGNAL(shortcutsChanged()), this, SLOT(updateShortcuts()));
 	connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), this, SLOT(optionChanged(QString,QVariant)));
 	connect(ToolBarsManager::getInstance(), SIGNAL(toolBarModified(int)), this, SLOT(toolBarModified(int)));
-	connect(TransfersManager::getInstance(), SIGNAL(transferStarted(Transfer*)), this, SLOT(transferStarted()));
 	connect(m_windowsManager, SIGNAL(requestedAddBookmark(QUrl,QString,QString)), this, SLOT(addBookmark(QUrl,QString,QString)));
 	connect(m_windowsManager, SIGNAL(requestedNewWindow(bool,bool,QUrl)), this, SIGNAL(requestedNewWindow(bool,bool,QUrl)));
 	connect(m_windowsManager, SIGNAL(windowTitleChanged(QString)), this, SLOT(updateWindowTitle(QString)));
 	connect(m_ui->consoleDockWidget, SIGNAL(visibilityChanged(bool)), getAction(ActionsManager::ShowErrorConsoleAction), SLOT(setChecked(bool)));
 
+	if (Application::getInstance()->isInitialized())
+	{
+		initializeDeferred();
+	}
+	else
+	{
+		connect(Application::getInstance(), SIGNAL(initialized()), this, SLOT(initializeDeferred()));
+	}
+
 	m_windowsManager->restore(session);
 
 	m_ui->consoleDockWidget->hide();
@@ -856,6 +864,11 @@ void MainWindow::toolBarModified(int identifier)
 	}
 }
 
+void MainWindow::initializeDeferred()
+{
+	connect(TransfersManager::getInstance(), SIGNAL(transferStarted(Transfer*)), this, SLOT(transferStarted()));
+}
+
 void MainWindow::transferStarted()
 {
 	const QString action = SettingsManager::getValue(QLatin1String("Browser/TransferStartingAction")).toString();
@@ -92,6 +92,7 @@ protected slots:
 	void addBookmark(const QUrl &url = QUrl(), const QString &title = QString(), const QString &description = QString(), bool warn = false);
 	void toolBarModified(int identifier);
 	void splitterMoved();
+	void initializeDeferred();
 	void transferStarted();
 	void updateWindowTitle(const QString &title);
 	void updateShortcuts();
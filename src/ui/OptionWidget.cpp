@@ -120,7 +120,7 @@ OptionWidget::OptionWidget(bool simple, const QString &option, const QString &ty
 	if (!simple)
 	{
 		m_resetButton = new QPushButton(tr("Defaults"), this);
-		m_resetButton->setEnabled(currentValue != SettingsManager::getDefaultValue(option));
+		m_resetButton->setEnabled(!SettingsManager::isDefaultValue(option, currentValue));
 
 		m_saveButton = new QPushButton(tr("Save"), this);
 
@@ -168,7 +168,7 @@ void OptionWidget::modified()
 {
 	if (m_resetButton)
 	{
-		m_resetButton->setEnabled(getValue() != SettingsManager::getDefaultValue(m_option));
+		m_resetButton->setEnabled(!SettingsManager::isDefaultValue(m_option, getValue()));
 	}
 	else
 	{
@@ -56,6 +56,7 @@ TabBarWidget::TabBarWidget(QWidget *parent) : QTabBar(parent),
 	m_showCloseButton(true),
 	m_showUrlIcon(true),
 	m_enablePreviews(true),
+	m_isBatchUpdate(false),
 	m_isMoved(false)
 {
 	qRegisterMetaType<WindowLoadingState>("WindowLoadingState");
@@ -307,6 +308,11 @@ void TabBarWidget::tabLayoutChange()
 {
 	QTabBar::tabLayoutChange();
 
+	if (m_isBatchUpdate)
+	{
+		return;
+	}
+
 	updateButtons();
 
 	emit layoutChanged();
@@ -339,6 +345,11 @@ void TabBarWidget::tabInserted(int index)
 		setTabButton(index, m_closeButtonPosition, label);
 	}
 
+	if (m_isBatchUpdate)
+	{
+		return;
+	}
+
 	updateTabs();
 
 	emit tabsAmountChanged(count());
@@ -393,6 +404,11 @@ void TabBarWidget::addTab(int index, Window *window)
 	connect(window, SIGNAL(loadingStateChanged(WindowLoadingState)), this, SLOT(updateTabs()));
 	connect(window, SIGNAL(isPinnedChanged(bool)), this, SLOT(updatePinnedTabsAmount()));
 
+	if (m_isBatchUpdate)
+	{
+		return;
+	}
+
 	if (window->isPinned())
 	{
 		updatePinnedTabsAmount();
@@ -401,6 +417,27 @@ void TabBarWidget::addTab(int index, Window *window)
 	updateTabs(index);
 }
 
+void TabBarWidget::beginBatchUpdate()
+{
+	m_isBatchUpdate = true;
+}
+
+void TabBarWidget::endBatchUpdate()
+{
+	if (!m_isBatchUpdate)
+	{
+		return;
+	}
+
+	m_isBatchUpdate = false;
+
+	updatePinnedTabsAmount();
+	updateButtons();
+
+	emit layoutChanged();
+	emit tabsAmountChanged(count());
+}
+
 void TabBarWidget::removeTab(int index)
 {
 	if (underMouse())
@@ -38,6 +38,8 @@ public:
 
 	void addTab(int index, Window *window);
 	void removeTab(int index);
+	void beginBatchUpdate();
+	void endBatchUpdate();
 	void activateTabOnLeft();
 	void activateTabOnRight();
 	QVariant getTabProperty(int index, const QString &key, const QVariant &defaultValue) const;
@@ -94,6 +96,7 @@ private:
 	bool m_showCloseButton;
 	bool m_showUrlIcon;
 	bool m_enablePreviews;
+	bool m_isBatchUpdate;
 	bool m_isMoved;
 
 signals:
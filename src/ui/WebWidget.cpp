@@ -45,7 +45,9 @@ WebWidget::WebWidget(bool isPrivate, WebBackend *backend, ContentsWidget *parent
 	m_quickSearchMenu(NULL),
 	m_scrollMode(NoScroll),
 	m_reloadTimer(0),
-	m_scrollTimer(0)
+	m_scrollTimer(0),
+	m_isThrottled(false),
+	m_isThrottlingRequested(false)
 {
 	Q_UNUSED(isPrivate)
 
@@ -187,7 +189,14 @@ void WebWidget::startReloadTimer()
 	{
 		triggerAction(ActionsManager::StopScheduledReloadAction);
 
-		if (reloadTime > 0)
+		if (m_reloadTimer != 0)
+		{
+			killTimer(m_reloadTimer);
+
+			m_reloadTimer = 0;
+		}
+
+		if (reloadTime > 0 && !m_isThrottled)
 		{
 			m_reloadTimer = startTimer(reloadTime * 1000);
 		}
@@ -568,7 +577,7 @@ void WebWidget::setOption(const QString &key, const QVariant &value)
 		{
 			triggerAction(ActionsManager::StopScheduledReloadAction);
 
-			if (reloadTime > 0)
+			if (reloadTime > 0 && !m_isThrottled)
 			{
 				m_reloadTimer = startTimer(reloadTime * 1000);
 			}
@@ -583,6 +592,46 @@ void WebWidget::setOption(const QString &key, const QVariant &value)
 	{
 		m_options[key] = value;
 	}
+
+	emit optionsChanged();
+}
+
+void WebWidget::setThrottled(bool throttled)
+{
+	const bool wasThrottled = m_isThrottled;
+
+	m_isThrottlingRequested = throttled;
+	m_throttlingHost = getUrl().host();
+	m_isThrottled = (throttled && getOption(QLatin1String("Browser/ThrottleBackgroundTabs")).toBool());
+
+	if (m_isThrottled == wasThrottled)
+	{
+		return;
+	}
+
+// scheduled reload is suspended while tab is in background and starts counting from scratch once it is shown again
+	if (m_isThrottled)
+	{
+		if (m_reloadTimer != 0)
+		{
+			killTimer(m_reloadTimer);
+
+			m_reloadTimer = 0;
+		}
+	}
+	else if (!isLoading())
+	{
+		startReloadTimer();
+	}
+}
+
+void WebWidget::updateThrottling()
+{
+// throttling can be overridden per site, so it has to be checked again when background tab navigates to another host
+	if (m_isThrottlingRequested && getUrl().host() != m_throttlingHost)
+	{
+		setThrottled(true);
+	}
 }
 
 void WebWidget::setOptions(const QVariantHash &options)
@@ -786,4 +835,14 @@ bool WebWidget::hasOption(const QString &key) const
 	return m_options.contains(key);
 }
 
+bool WebWidget::isPlayingMedia() const
+{
+	return false;
+}
+
+bool WebWidget::isThrottled() const
+{
+	return m_isThrottled;
+}
+
 }
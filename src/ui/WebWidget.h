@@ -106,7 +106,6 @@ public:
 	virtual QUrl getUrl() const = 0;
 	QUrl getRequestedUrl() const;
 	virtual QIcon getIcon() const = 0;
-	virtual QPixmap getThumbnail() = 0;
 	virtual QPoint getScrollPosition() const = 0;
 	virtual QRect getProgressBarGeometry() const = 0;
 	virtual WindowHistoryInformation getHistory() const = 0;
@@ -119,7 +118,9 @@ public:
 	virtual int getZoom() const = 0;
 	bool hasOption(const QString &key) const;
 	virtual bool isLoading() const = 0;
+	virtual bool isPlayingMedia() const;
 	virtual bool isPrivate() const = 0;
+	bool isThrottled() const;
 	virtual bool findInPage(const QString &text, FindFlags flags = NoFlagsFind) = 0;
 
 public slots:
@@ -133,6 +134,7 @@ public slots:
 	virtual void setScrollPosition(const QPoint &position) = 0;
 	virtual void setHistory(const WindowHistoryInformation &history) = 0;
 	void setScrollMode(ScrollMode mode);
+	virtual void setThrottled(bool throttled);
 	virtual void setZoom(int zoom) = 0;
 	virtual void setUrl(const QUrl &url, bool typed = true) = 0;
 	void setRequestedUrl(const QUrl &url, bool typed = true, bool onlyUpdate = false);
@@ -146,6 +148,7 @@ protected:
 	void mouseMoveEvent(QMouseEvent *event);
 	virtual void pasteText(const QString &text) = 0;
 	void startReloadTimer();
+	void updateThrottling();
 	void setAlternateStyleSheets(const QStringList &styleSheets);
 	virtual void setOptions(const QVariantHash &options);
 	QMenu* getPasteNoteMenu();
@@ -172,11 +175,14 @@ private:
 	QString m_overridingStatusMessage;
 	QPoint m_beginCursorPosition;
 	QPoint m_beginScrollPosition;
+	QString m_throttlingHost;
 	QStringList m_alternateStyleSheets;
 	QVariantHash m_options;
 	ScrollMode m_scrollMode;
 	int m_reloadTimer;
 	int m_scrollTimer;
+	bool m_isThrottled;
+	bool m_isThrottlingRequested;
 
 	static QMap<int, QPixmap> m_scrollCursors;
 
@@ -195,6 +201,8 @@ signals:
 	void iconChanged(const QIcon &icon);
 	void loadingChanged(bool loading);
 	void zoomChanged(int zoom);
+	void scrollPositionChanged(const QPoint &position);
+	void optionsChanged();
 	void loadProgress(int progress);
 	void loadMessageChanged(QString message);
 	void loadStatusChanged(int finishedRequests, int startedReuests, qint64 bytesReceived, qint64 bytesTotal, qint64 speed);
@@ -27,6 +27,7 @@
 #include "../core/AddonsManager.h"
 #include "../core/NetworkManagerFactory.h"
 #include "../core/SettingsManager.h"
+#include "../core/ThumbnailsManager.h"
 #include "../core/Utils.h"
 #include "../core/WebBackend.h"
 #include "../modules/windows/bookmarks/BookmarksContentsWidget.h"
@@ -34,6 +35,7 @@
 #include "../modules/windows/cookies/CookiesContentsWidget.h"
 #include "../modules/windows/configuration/ConfigurationContentsWidget.h"
 #include "../modules/windows/history/HistoryContentsWidget.h"
+#include "../modules/windows/network/NetworkContentsWidget.h"
 #include "../modules/windows/notes/NotesContentsWidget.h"
 #include "../modules/windows/transfers/TransfersContentsWidget.h"
 #include "../modules/windows/web/WebContentsWidget.h"
@@ -56,10 +58,12 @@ quint64 Window::m_identifierCounter = 0;
 Window::Window(bool isPrivate, ContentsWidget *widget, QWidget *parent) : QWidget(parent),
 	m_navigationBar(NULL),
 	m_contentsWidget(NULL),
+	m_creationTime(QDateTime::currentDateTime()),
 	m_identifier(++m_identifierCounter),
 	m_areControlsHidden(false),
 	m_isPinned(false),
-	m_isPrivate(isPrivate)
+	m_isPrivate(isPrivate),
+	m_isThrottled(false)
 {
 	QBoxLayout *layout = new QBoxLayout(QBoxLayout::TopToBottom, this);
 	layout->setContentsMargins(0, 0, 0, 0);
@@ -73,6 +77,15 @@ Window::Window(bool isPrivate, ContentsWidget *widget, QWidget *parent) : QWidge
 
 		setContentsWidget(widget);
 	}
+
+	if (!m_isPrivate)
+	{
+		connect(this, SIGNAL(titleChanged(QString)), this, SLOT(notifySessionChanged()));
+		connect(this, SIGNAL(urlChanged(QUrl)), this, SLOT(notifySessionChanged()));
+		connect(this, SIGNAL(zoomChanged(int)), this, SLOT(notifySessionChanged()));
+		connect(this, SIGNAL(searchEngineChanged(QString)), this, SLOT(notifySessionChanged()));
+		connect(this, SIGNAL(isPinnedChanged(bool)), this, SLOT(notifySessionChanged()));
+	}
 }
 
 void Window::showEvent(QShowEvent *event)
@@ -233,6 +246,8 @@ void Window::detachSearchWidget(SearchWidget *widget)
 
 void Window::close()
 {
+	ThumbnailsManager::removeThumbnail(m_identifier);
+
 	emit aboutToClose();
 
 	QTimer::singleShot(50, this, SLOT(notifyRequestedCloseWindow()));
@@ -313,19 +328,24 @@ void Window::notifyLoadingStateChanged(bool loading)
 	emit loadingStateChanged(loading ? LoadingState : LoadedState);
 }
 
+void Window::notifySessionChanged()
+{
+	SessionsManager::markWindowModified(m_identifier);
+}
+
 void Window::notifyRequestedCloseWindow()
 {
 	emit requestedCloseWindow(this);
 }
 
-void Window::setSession(const SessionWindow &session)
+void Window::setSession(const SessionWindow &session, bool deferLoading)
 {
 	m_session = session;
 
 	setSearchEngine(session.searchEngine);
 	setPinned(session.isPinned);
 
-	if (!SettingsManager::getValue(QLatin1String("Browser/DelayRestoringOfBackgroundTabs")).toBool())
+	if (!deferLoading && !SettingsManager::getValue(QLatin1String("Browser/DelayRestoringOfBackgroundTabs")).toBool())
 	{
 		setUrl(session.getUrl(), false);
 	}
@@ -408,6 +428,10 @@ void Window::setUrl(const QUrl &url, bool typed)
 		{
 			newWidget = new HistoryContentsWidget(this);
 		}
+		else if (url.path() == QLatin1String("network"))
+		{
+			newWidget = new NetworkContentsWidget(this);
+		}
 		else if (url.path() == QLatin1String("notes"))
 		{
 			newWidget = new NotesContentsWidget(this);
@@ -487,6 +511,19 @@ void Window::setPinned(bool pinned)
 	}
 }
 
+void Window::setThrottled(bool throttled)
+{
+	if (throttled != m_isThrottled)
+	{
+		m_isThrottled = throttled;
+
+		if (m_contentsWidget)
+		{
+			m_contentsWidget->setThrottled(throttled);
+		}
+	}
+}
+
 void Window::setContentsWidget(ContentsWidget *widget)
 {
 	if (m_contentsWidget)
@@ -566,6 +603,11 @@ void Window::setContentsWidget(ContentsWidget *widget)
 		}
 	}
 
+	if (m_isThrottled)
+	{
+		m_contentsWidget->setThrottled(true);
+	}
+
 	emit canZoomChanged(m_contentsWidget->canZoom());
 	emit iconChanged(m_contentsWidget->getIcon());
 
@@ -581,6 +623,12 @@ void Window::setContentsWidget(ContentsWidget *widget)
 	connect(m_contentsWidget, SIGNAL(iconChanged(QIcon)), this, SIGNAL(iconChanged(QIcon)));
 	connect(m_contentsWidget, SIGNAL(loadingChanged(bool)), this, SLOT(notifyLoadingStateChanged(bool)));
 	connect(m_contentsWidget, SIGNAL(zoomChanged(int)), this, SIGNAL(zoomChanged(int)));
+
+	if (!m_isPrivate)
+	{
+		connect(m_contentsWidget, SIGNAL(scrollPositionChanged(QPoint)), this, SLOT(notifySessionChanged()));
+		connect(m_contentsWidget, SIGNAL(optionsChanged()), this, SLOT(notifySessionChanged()));
+	}
 }
 
 Window* Window::clone(bool cloneHistory, QWidget *parent)
@@ -648,7 +696,12 @@ QIcon Window::getIcon() const
 
 QPixmap Window::getThumbnail() const
 {
-	return (m_contentsWidget ? m_contentsWidget->getThumbnail() : QPixmap());
+	return ThumbnailsManager::getThumbnail(m_identifier);
+}
+
+QDateTime Window::getCreationTime() const
+{
+	return m_creationTime;
 }
 
 QDateTime Window::getLastActivity() const
@@ -660,11 +713,15 @@ SessionWindow Window::getSession() const
 {
 	if (!m_contentsWidget)
 	{
-		return m_session;
+		SessionWindow session = m_session;
+		session.identifier = m_identifier;
+
+		return session;
 	}
 
 	const WindowHistoryInformation history = m_contentsWidget->getHistory();
 	SessionWindow session;
+	session.identifier = m_identifier;
 	session.searchEngine = getSearchEngine();
 	session.history = history.entries;
 	session.group = 0;
@@ -709,6 +766,27 @@ bool Window::canClone() const
 	return (m_contentsWidget ? m_contentsWidget->canClone() : false);
 }
 
+bool Window::hibernate()
+{
+	if (!m_contentsWidget || m_contentsWidget->getType() != QLatin1String("web") || m_contentsWidget->isLoading() || m_contentsWidget->isPlayingMedia())
+	{
+		return false;
+	}
+
+	m_session = getSession();
+
+	setContentsWidget(NULL);
+
+	if (!m_isPrivate)
+	{
+		ThumbnailsManager::storeThumbnail(m_identifier);
+	}
+
+	emit loadingStateChanged(DelayedState);
+
+	return true;
+}
+
 bool Window::isPinned() const
 {
 	return m_isPinned;
@@ -719,4 +797,9 @@ bool Window::isPrivate() const
 	return (m_contentsWidget ? m_contentsWidget->isPrivate() : m_isPrivate);
 }
 
+bool Window::isThrottled() const
+{
+	return m_isThrottled;
+}
+
 }
@@ -73,7 +73,7 @@ public:
 	void detachAddressWidget(AddressWidget *widget);
 	void attachSearchWidget(SearchWidget *widget);
 	void detachSearchWidget(SearchWidget *widget);
-	void setSession(const SessionWindow &session);
+	void setSession(const SessionWindow &session, bool deferLoading = false);
 	Window* clone(bool cloneHistory = true, QWidget *parent = NULL);
 	ContentsWidget* getContentsWidget();
 	QVariant getOption(const QString &key) const;
@@ -83,14 +83,17 @@ public:
 	QUrl getUrl() const;
 	QIcon getIcon() const;
 	QPixmap getThumbnail() const;
+	QDateTime getCreationTime() const;
 	QDateTime getLastActivity() const;
 	WindowHistoryInformation getHistory() const;
 	SessionWindow getSession() const;
 	WindowLoadingState getLoadingState() const;
 	quint64 getIdentifier() const;
 	bool canClone() const;
+	bool hibernate();
 	bool isPinned() const;
 	bool isPrivate() const;
+	bool isThrottled() const;
 
 public slots:
 	void triggerAction(int identifier, bool checked = false);
@@ -102,6 +105,7 @@ public slots:
 	void setUrl(const QUrl &url, bool typed = true);
 	void setControlsHidden(bool hidden);
 	void setPinned(bool pinned);
+	void setThrottled(bool throttled);
 
 protected:
 	void showEvent(QShowEvent *event);
@@ -112,12 +116,14 @@ protected slots:
 	void handleOpenUrlRequest(const QUrl &url, OpenHints hints);
 	void handleSearchRequest(const QString &query, const QString &engine, OpenHints hints = DefaultOpen);
 	void notifyLoadingStateChanged(bool loading);
+	void notifySessionChanged();
 	void notifyRequestedCloseWindow();
 
 private:
 	ToolBarWidget *m_navigationBar;
 	ContentsWidget *m_contentsWidget;
 	QString m_searchEngine;
+	QDateTime m_creationTime;
 	QDateTime m_lastActivity;
 	SessionWindow m_session;
 	QList<QPointer<AddressWidget> > m_addressWidgets;
@@ -126,6 +132,7 @@ private:
 	bool m_areControlsHidden;
 	bool m_isPinned;
 	bool m_isPrivate;
+	bool m_isThrottled;
 
 	static quint64 m_identifierCounter;
 
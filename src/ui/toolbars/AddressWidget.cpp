@@ -27,11 +27,13 @@
 #include "../../core/AddressCompletionModel.h"
 #include "../../core/BookmarksManager.h"
 #include "../../core/InputInterpreter.h"
+#include "../../core/NetworkPredictor.h"
 #include "../../core/NotesManager.h"
 #include "../../core/SearchesManager.h"
 #include "../../core/Utils.h"
 
 #include <QtCore/QTimer>
+#include <QtCore/QTimerEvent>
 #include <QtGui/QClipboard>
 #include <QtGui/QContextMenuEvent>
 #include <QtGui/QPainter>
@@ -49,6 +51,7 @@ AddressWidget::AddressWidget(Window *window, QWidget *parent) : QLineEdit(parent
 	m_feedsLabel(NULL),
 	m_loadPluginsLabel(NULL),
 	m_urlIconLabel(NULL),
+	m_predictionTimer(0),
 	m_simpleMode(false)
 {
 	m_completer->setCaseSensitivity(Qt::CaseInsensitive);
@@ -71,6 +74,7 @@ AddressWidget::AddressWidget(Window *window, QWidget *parent) : QLineEdit(parent
 
 		connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), this, SLOT(optionChanged(QString,QVariant)));
 		connect(toolBar, SIGNAL(windowChanged(Window*)), this, SLOT(setWindow(Window*)));
+		connect(this, SIGNAL(textEdited(QString)), this, SLOT(schedulePrediction()));
 	}
 	else
 	{
@@ -144,6 +148,38 @@ void AddressWidget::focusInEvent(QFocusEvent *event)
 	}
 }
 
+void AddressWidget::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != m_predictionTimer)
+	{
+		QLineEdit::timerEvent(event);
+
+		return;
+	}
+
+	killTimer(m_predictionTimer);
+
+	m_predictionTimer = 0;
+
+	const bool isPrivate = (m_window && m_window->isPrivate());
+	const QString completion = ((m_completer->completionCount() > 0) ? m_completer->currentCompletion() : QString());
+
+// partially typed host is only resolved, connection is opened only for suggested address
+	if (!completion.isEmpty())
+	{
+		NetworkPredictor::predictUrl(QUrl(completion), NetworkPredictor::CompletionSource, isPrivate);
+
+		return;
+	}
+
+	const QString input = text().trimmed();
+
+	if (!input.contains(QLatin1Char(' ')) && input.contains(QLatin1Char('.')))
+	{
+		NetworkPredictor::predictUrl(QUrl::fromUserInput(input), NetworkPredictor::TypedSource, isPrivate);
+	}
+}
+
 void AddressWidget::keyPressEvent(QKeyEvent *event)
 {
 	QLineEdit::keyPressEvent(event);
@@ -494,6 +530,16 @@ void AddressWidget::updateIcons()
 	setTextMargins(margins);
 }
 
+void AddressWidget::schedulePrediction()
+{
+	if (m_predictionTimer != 0)
+	{
+		killTimer(m_predictionTimer);
+	}
+
+	m_predictionTimer = startTimer(250);
+}
+
 void AddressWidget::setCompletion(const QString &text)
 {
 	m_completer->setCompletionPrefix(text);
@@ -51,6 +51,7 @@ protected:
 	void paintEvent(QPaintEvent *event);
 	void resizeEvent(QResizeEvent *event);
 	void focusInEvent(QFocusEvent *event);
+	void timerEvent(QTimerEvent *event);
 	void keyPressEvent(QKeyEvent *event);
 	void contextMenuEvent(QContextMenuEvent *event);
 	void mouseMoveEvent(QMouseEvent *event);
@@ -67,6 +68,7 @@ protected slots:
 	void updateFeeds();
 	void updateLoadPlugins();
 	void updateIcons();
+	void schedulePrediction();
 	void setCompletion(const QString &text);
 	void setIcon(const QIcon &icon);
 
@@ -79,6 +81,7 @@ private:
 	QLabel *m_urlIconLabel;
 	QRect m_securityBadgeRectangle;
 	OpenHints m_hints;
+	int m_predictionTimer;
 	bool m_simpleMode;
 
 signals:
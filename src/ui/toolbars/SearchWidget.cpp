@@ -23,6 +23,7 @@
 #include "../SearchDelegate.h"
 #include "../ToolBarWidget.h"
 #include "../Window.h"
+#include "../../core/Application.h"
 #include "../../core/NotesManager.h"
 #include "../../core/SearchesManager.h"
 #include "../../core/SearchSuggester.h"
@@ -47,6 +48,7 @@ SearchWidget::SearchWidget(Window *window, QWidget *parent) : QComboBox(parent),
 	m_suggester(NULL),
 	m_lastValidIndex(0),
 	m_isIgnoringActivation(false),
+	m_isInitialized(false),
 	m_isPopupUpdated(false),
 	m_wasPopupVisible(false)
 {
@@ -56,7 +58,6 @@ SearchWidget::SearchWidget(Window *window, QWidget *parent) : QComboBox(parent),
 
 	setEditable(true);
 	setItemDelegate(new SearchDelegate(height(), this));
-	setModel(SearchesManager::getSearchEnginesModel());
 	setInsertPolicy(QComboBox::NoInsert);
 	optionChanged(QLatin1String("Search/SearchEnginesSuggestions"), SettingsManager::getValue(QLatin1String("Search/SearchEnginesSuggestions")));
 
@@ -70,14 +71,22 @@ SearchWidget::SearchWidget(Window *window, QWidget *parent) : QComboBox(parent),
 		connect(toolBar, SIGNAL(windowChanged(Window*)), this, SLOT(setWindow(Window*)));
 	}
 
-	connect(SearchesManager::getInstance(), SIGNAL(searchEnginesModified()), this, SLOT(storeCurrentSearchEngine()));
-	connect(SearchesManager::getInstance(), SIGNAL(searchEnginesModelModified()), this, SLOT(restoreCurrentSearchEngine()));
 	connect(SettingsManager::getInstance(), SIGNAL(valueChanged(QString,QVariant)), this, SLOT(optionChanged(QString,QVariant)));
 	connect(this, SIGNAL(currentIndexChanged(int)), this, SLOT(currentIndexChanged(int)));
 	connect(lineEdit(), SIGNAL(textChanged(QString)), this, SLOT(queryChanged(QString)));
 	connect(m_completer, SIGNAL(activated(QString)), this, SLOT(sendRequest(QString)));
 
 	setWindow(window);
+
+// search engines are loaded after first window is shown, until then widget stays empty
+	if (Application::getInstance()->isInitialized())
+	{
+		initializeDeferred();
+	}
+	else
+	{
+		connect(Application::getInstance(), SIGNAL(initialized()), this, SLOT(initializeDeferred()));
+	}
 }
 
 void SearchWidget::paintEvent(QPaintEvent *event)
@@ -278,6 +287,26 @@ void SearchWidget::hidePopup()
 	QComboBox::hidePopup();
 }
 
+void SearchWidget::initializeDeferred()
+{
+	if (m_isInitialized)
+	{
+		return;
+	}
+
+	m_isInitialized = true;
+
+	disconnect(this, SIGNAL(currentIndexChanged(int)), this, SLOT(currentIndexChanged(int)));
+
+	setModel(SearchesManager::getSearchEnginesModel());
+
+	connect(this, SIGNAL(currentIndexChanged(int)), this, SLOT(currentIndexChanged(int)));
+	connect(SearchesManager::getInstance(), SIGNAL(searchEnginesModified()), this, SLOT(storeCurrentSearchEngine()));
+	connect(SearchesManager::getInstance(), SIGNAL(searchEnginesModelModified()), this, SLOT(restoreCurrentSearchEngine()));
+
+	setSearchEngine(m_window ? m_window->getSearchEngine() : QString());
+}
+
 void SearchWidget::optionChanged(const QString &option, const QVariant &value)
 {
 	if (option == QLatin1String("Search/SearchEnginesSuggestions"))
@@ -425,6 +454,11 @@ void SearchWidget::restoreCurrentSearchEngine()
 
 void SearchWidget::setSearchEngine(const QString &engine)
 {
+	if (!m_isInitialized)
+	{
+		return;
+	}
+
 	const QStringList engines = SearchesManager::getSearchEngines();
 
 	if (engines.isEmpty())
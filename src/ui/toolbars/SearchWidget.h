@@ -58,6 +58,7 @@ protected:
 	void wheelEvent(QWheelEvent *event);
 
 protected slots:
+	void initializeDeferred();
 	void optionChanged(const QString &option, const QVariant &value);
 	void currentIndexChanged(int index);
 	void queryChanged(const QString &query);
@@ -81,6 +82,7 @@ private:
 	QRect m_searchButtonRectangle;
 	int m_lastValidIndex;
 	bool m_isIgnoringActivation;
+	bool m_isInitialized;
 	bool m_isPopupUpdated;
 	bool m_wasPopupVisible;
 